@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "atomic_file.h"
+#include <log.h>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+bool WriteFileAtomic(const std::filesystem::path& path, const std::string& data)
+{
+    std::filesystem::path tempPath(path);
+    tempPath += ".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+        file.close();
+
+        if (file.fail())
+        {
+            ErrorLog("Failed to write file, %i\n", errno);
+            std::error_code error;
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        ErrorLog("Failed to replace file: %s\n", error.message().c_str());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+
+// Writes the data to a temporary file next to the path and renames it over the old file,
+// so an interrupted write never leaves a truncated file behind. Returns false on failure,
+// in which case the old file is left as it was.
+bool WriteFileAtomic(const std::filesystem::path& path, const std::string& data);
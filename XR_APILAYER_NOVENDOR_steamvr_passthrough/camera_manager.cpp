@@ -2,6 +2,9 @@
 #include "camera_manager.h"
 #include <log.h>
 #include "layer.h"
+#include "trace.h"
+#include "xr_math_simd.h"
+#include "perf_timeline.h"
 
 
 using namespace steamvr_passthrough;
@@ -75,11 +78,15 @@ CameraManager::CameraManager(std::shared_ptr<IPassthroughRenderer> renderer, ERe
     , m_frameLayout(EStereoFrameLayout::Mono)
     , m_projectionDistanceFar(5.0f)
     , m_useAlternateProjectionCalc(false)
+    , m_frameRetrievalTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_RETRIEVAL))
+    , m_servedFramesCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_CAMERA_FRAMES))
+    , m_frameSequenceGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_CAMERA_FRAME_SEQUENCE))
 {
     m_renderFrame = std::make_shared<CameraFrame>();
     m_servedFrame = std::make_shared<CameraFrame>();
     m_underConstructionFrame = std::make_shared<CameraFrame>();
-    m_renderModels = std::make_shared<std::vector<RenderModel>>();
+    m_poseHistory = std::make_unique<PoseHistory>(m_openVRManager);
+    m_renderModelCache = std::make_unique<RenderModelCache>(m_configManager, m_openVRManager);
 }
 
 CameraManager::~CameraManager()
@@ -132,6 +139,13 @@ bool CameraManager::InitCamera()
     m_bCameraInitialized = true;
     m_bRunThread = true;
 
+    bool bProjectToRenderModels = m_configManager->GetConfigSnapshot()->Main.ProjectToRenderModels;
+
+    m_poseHistory->SetSamplingEnabled(bProjectToRenderModels);
+    m_poseHistory->Start();
+    m_renderModelCache->SetEnabled(bProjectToRenderModels);
+    m_renderModelCache->Start();
+
     if (!m_serveThread.joinable())
     {
         m_serveThread = std::thread(&CameraManager::ServeFrames, this);
@@ -162,6 +176,9 @@ void CameraManager::DeinitCamera()
     {
         m_serveThread.join();
     }
+
+    m_poseHistory->Stop();
+    m_renderModelCache->Stop();
 }
 
 void CameraManager::GetFrameSize(uint32_t& width, uint32_t& height, uint32_t& bufferSize) const
@@ -315,7 +332,7 @@ bool CameraManager::GetCameraFrame(std::shared_ptr<CameraFrame>& frame)
 {
     if (!m_bCameraInitialized) { return false; }
 
-    std::unique_lock<std::mutex> lock(m_serveMutex, std::try_to_lock);
+    std::unique_lock<ProfiledMutex> lock(m_serveMutex, std::try_to_lock);
     if (lock.owns_lock() && m_servedFrame->bIsValid)
     {
         m_renderFrame->bIsValid = false;        
@@ -352,7 +369,12 @@ void CameraManager::ServeFrames()
 
     bool bHasFrame = false;
     uint32_t lastFrameSequence = 0;
-    LARGE_INTEGER startFrameRetrievalTime;
+    uint64_t lastExposureTime = 0;
+    uint64_t startFrameRetrievalTime = 0;
+
+    ConfigSnapshotReader configReader(m_configManager);
+
+    Tracer::Get().SetThreadName("Camera frame server");
 
     while (m_bRunThread)
     {
@@ -365,9 +387,9 @@ void CameraManager::ServeFrames()
 
         while (true)
         {
-            startFrameRetrievalTime = StartPerfTimer();
+            startFrameRetrievalTime = GetMonotonicTimeNs();
 
-            vr::EVRTrackedCameraFrameType frameType = m_configManager->GetConfig_Main().ProjectionMode == Projection_RoomView2D ? vr::VRTrackedCameraFrameType_MaximumUndistorted : vr::VRTrackedCameraFrameType_Distorted;
+            vr::EVRTrackedCameraFrameType frameType = configReader.Get().Main.ProjectionMode == Projection_RoomView2D ? vr::VRTrackedCameraFrameType_MaximumUndistorted : vr::VRTrackedCameraFrameType_Distorted;
 
             vr::EVRTrackedCameraError error = trackedCamera->GetVideoStreamFrameBuffer(m_cameraHandle, frameType, nullptr, 0, &m_underConstructionFrame->header, sizeof(vr::CameraVideoStreamFrameHeader_t));
 
@@ -396,7 +418,9 @@ void CameraManager::ServeFrames()
 
         if (!m_bRunThread) { return; }
 
-        Config_Main& mainConf = m_configManager->GetConfig_Main();
+        TraceSpan retrievalSpan("ServeFrames retrieval", m_underConstructionFrame->header.nFrameSequence);
+
+        const Config_Main& mainConf = configReader.Get().Main;
 
         vr::EVRTrackedCameraFrameType frameType = mainConf.ProjectionMode == Projection_RoomView2D ? vr::VRTrackedCameraFrameType_MaximumUndistorted : vr::VRTrackedCameraFrameType_Distorted;
 
@@ -461,103 +485,88 @@ void CameraManager::ServeFrames()
         m_underConstructionFrame->bIsValid = true;
         m_underConstructionFrame->frameLayout = m_frameLayout;
 
-        if (mainConf.ProjectToRenderModels)
-        {
-            UpdateRenderModels();
-        }
-        m_underConstructionFrame->renderModels = m_renderModels;
+        m_poseHistory->SetSamplingEnabled(mainConf.ProjectToRenderModels);
+        m_renderModelCache->SetEnabled(mainConf.ProjectToRenderModels);
+
+        // The meshes are shared, but each frame gets its own list since the poses are written per frame.
+        m_underConstructionFrame->renderModels = std::make_shared<std::vector<RenderModel>>(*m_renderModelCache->GetRenderModels());
 
         // Apply offset calibration to camera positions.
         XrMatrix4x4f origLeftCameraToTrackingPose = ToXRMatrix4x4(m_underConstructionFrame->header.trackedDevicePose.mDeviceToAbsoluteTracking);
         XrMatrix4x4f headToTrackingPose, correctedLeftCameraToHMDPose;
-        XrMatrix4x4f_Multiply(&headToTrackingPose, &origLeftCameraToTrackingPose, &m_HMDToCameraLeft);
+        XrMatrix4x4f_MultiplySIMD(&headToTrackingPose, &origLeftCameraToTrackingPose, &m_HMDToCameraLeft);
         correctedLeftCameraToHMDPose = m_cameraToHMDLeft;
         correctedLeftCameraToHMDPose.m[12] *= mainConf.DepthOffsetCalibration;
         correctedLeftCameraToHMDPose.m[13] *= mainConf.DepthOffsetCalibration;
         correctedLeftCameraToHMDPose.m[14] *= mainConf.DepthOffsetCalibration;
-        XrMatrix4x4f_Multiply(&m_underConstructionFrame->cameraViewToWorldLeft, &headToTrackingPose, &correctedLeftCameraToHMDPose);
+        XrMatrix4x4f_MultiplySIMD(&m_underConstructionFrame->cameraViewToWorldLeft, &headToTrackingPose, &correctedLeftCameraToHMDPose);
 
         XrMatrix4x4f rightToLeftPose = m_cameraRightToLeftPose;
         rightToLeftPose.m[12] *= mainConf.DepthOffsetCalibration;
         rightToLeftPose.m[13] *= mainConf.DepthOffsetCalibration;
         rightToLeftPose.m[14] *= mainConf.DepthOffsetCalibration;
 
-        XrMatrix4x4f_Multiply(&m_underConstructionFrame->cameraViewToWorldRight, &m_underConstructionFrame->cameraViewToWorldLeft, &rightToLeftPose);
+        XrMatrix4x4f_MultiplySIMD(&m_underConstructionFrame->cameraViewToWorldRight, &m_underConstructionFrame->cameraViewToWorldLeft, &rightToLeftPose);
+
+        uint64_t exposureTime = PerfCounterToNs(m_underConstructionFrame->header.ulFrameExposureTime);
 
         {
-            std::lock_guard<std::mutex> lock(m_serveMutex);
+            std::lock_guard<ProfiledMutex> lock(m_serveMutex);
 
             m_servedFrame.swap(m_underConstructionFrame);
         }
 
-        m_averageFrameRetrievalTime = UpdateAveragePerfTime(m_frameRetrievalTimes, EndPerfTimer(startFrameRetrievalTime), 20);
-    }
-}
+        retrievalSpan.End();
 
+        uint64_t servedTime = GetMonotonicTimeNs();
 
-void CameraManager::UpdateRenderModels()
-{
-    vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
-    vr::IVRRenderModels* vrRenderModels = m_openVRManager->GetVRRenderModels();
+        m_frameRetrievalTimer.Record(servedTime - startFrameRetrievalTime);
+        PerfTimeline::Get().Record(PerfTimeline_FrameRetrieval, servedTime, servedTime - startFrameRetrievalTime);
 
-    for (int i = 1; i < vr::k_unMaxTrackedDeviceCount; i++)
-    {
-        if (!vrSystem->IsTrackedDeviceConnected(i))
+        if (lastExposureTime != 0 && exposureTime > lastExposureTime)
         {
-            break;
+            PerfTimeline::Get().Record(PerfTimeline_CameraFramePeriod, servedTime, exposureTime - lastExposureTime);
         }
+        lastExposureTime = exposureTime;
 
-        std::string modelName;
-        modelName.resize(vr::k_unMaxPropertyStringSize);
+        m_servedFramesCounter.Add();
+        m_frameSequenceGauge.Set(lastFrameSequence);
+    }
+}
 
-        vr::TrackedPropertyError error;
-        uint32_t numBytes = m_openVRManager->GetVRSystem()->GetStringTrackedDeviceProperty(i, vr::Prop_RenderModelName_String, modelName.data(), vr::k_unMaxPropertyStringSize, &error);
 
-        bool bFoundModel = false;
+// Constructs a matrix from the roomscale origin to the application reference space. Shared by both eyes.
+XrMatrix4x4f CameraManager::GetRefSpaceTransform(const XrReferenceSpaceCreateInfo& refSpaceInfo)
+{
+    XrMatrix4x4f output, pose, refSpacePose;
 
-        for (RenderModel model : *m_renderModels)
-        {
-            if (model.deviceId == i)
-            {
-                if (strncmp(model.modelName.data(), modelName.data(), vr::k_unMaxPropertyStringSize) != 0)
-                {
-                    vr::RenderModel_t* newModel;
+    XrVector3f scale = { 1, 1, 1 };
 
-                    if (vrRenderModels->LoadRenderModel_Async(modelName.data(), &newModel) == vr::VRRenderModelError_None)
-                    {
-                        model.modelName = modelName.data();
-                        MeshCreateRenderModel(model.mesh, newModel);
-                    }
-                }
+    // Apply any pose the application might have configured in its reference spaces.
+    XrMatrix4x4f_CreateTranslationRotationScale(&pose, &refSpaceInfo.poseInReferenceSpace.position, &refSpaceInfo.poseInReferenceSpace.orientation, &scale);
+    XrMatrix4x4f_InvertRigidBodySIMD(&refSpacePose, &pose);
 
-                bFoundModel = true;
-                break;
-            }
-        }
+    if (refSpaceInfo.referenceSpaceType == XR_REFERENCE_SPACE_TYPE_LOCAL)
+    {
+        vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
 
-        if (!bFoundModel)
-        {
-            vr::RenderModel_t* newModel;
+        vr::HmdMatrix34_t mat = vrSystem->GetSeatedZeroPoseToStandingAbsoluteTrackingPose();
+        XrMatrix4x4f trackingToStage = ToXRMatrix4x4Inverted(mat);
 
-            if (vrRenderModels->LoadRenderModel_Async(modelName.data(), &newModel) == vr::VRRenderModelError_None)
-            {
-                RenderModel rm;
-                rm.deviceId = i;
-                rm.modelName = modelName;
-                MeshCreateRenderModel(rm.mesh, newModel);
-                m_renderModels->push_back(rm);
-            }
-        }
+        XrMatrix4x4f_MultiplySIMD(&output, &refSpacePose, &trackingToStage);
+    }
+    else
+    {
+        output = refSpacePose;
     }
-}
 
+    return output;
+}
 
 // Constructs a matrix from the roomscale origin to the HMD eye pose.
-XrMatrix4x4f CameraManager::GetHMDWorldToViewMatrix(const ERenderEye eye, const XrCompositionLayerProjection& layer, const XrReferenceSpaceCreateInfo& refSpaceInfo)
+XrMatrix4x4f CameraManager::GetHMDWorldToViewMatrix(const ERenderEye eye, const XrCompositionLayerProjection& layer, const XrMatrix4x4f& refSpaceTransform)
 {
-    vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
-
-    XrMatrix4x4f output, pose, viewToTracking, trackingToStage, refSpacePose;
+    XrMatrix4x4f output, pose, viewToTracking;
 
     int viewNum = eye == LEFT_EYE ? 0 : 1;
 
@@ -565,25 +574,9 @@ XrMatrix4x4f CameraManager::GetHMDWorldToViewMatrix(const ERenderEye eye, const
 
     // The application provided HMD pose used to make sure reprojection works correctly.
     XrMatrix4x4f_CreateTranslationRotationScale(&pose, &layer.views[viewNum].pose.position, &layer.views[viewNum].pose.orientation, &scale);
-    XrMatrix4x4f_Invert(&viewToTracking, &pose);    
-
-    // Apply any pose the application might have configured in its reference spaces.
-    XrMatrix4x4f_CreateTranslationRotationScale(&pose, &refSpaceInfo.poseInReferenceSpace.position, &refSpaceInfo.poseInReferenceSpace.orientation, &scale);
-    XrMatrix4x4f_Invert(&refSpacePose, &pose);
+    XrMatrix4x4f_InvertRigidBodySIMD(&viewToTracking, &pose);
 
-
-    if (refSpaceInfo.referenceSpaceType == XR_REFERENCE_SPACE_TYPE_LOCAL)
-    {
-        vr::HmdMatrix34_t mat = vrSystem->GetSeatedZeroPoseToStandingAbsoluteTrackingPose();
-        trackingToStage = ToXRMatrix4x4Inverted(mat);
-
-        XrMatrix4x4f_Multiply(&pose, &refSpacePose, &trackingToStage);
-        XrMatrix4x4f_Multiply(&output,  &viewToTracking, &pose);
-    }
-    else
-    {
-        XrMatrix4x4f_Multiply(&output, &viewToTracking, &refSpacePose);
-    }
+    XrMatrix4x4f_MultiplySIMD(&output, &viewToTracking, &refSpaceTransform);
 
     return output;
 }
@@ -593,7 +586,8 @@ void CameraManager::UpdateProjectionMatrix(std::shared_ptr<CameraFrame>& frame)
     bool bIsStereo = m_frameLayout != EStereoFrameLayout::Mono;
 
     vr::IVRTrackedCamera* trackedCamera = m_openVRManager->GetVRTrackedCamera();
-    Config_Main& mainConf = m_configManager->GetConfig_Main();
+    std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+    const Config_Main& mainConf = config->Main;
 
     if (mainConf.ProjectionDistanceFar * 1.5f != m_projectionDistanceFar)
     {
@@ -630,6 +624,7 @@ void CameraManager::UpdateProjectionMatrix(std::shared_ptr<CameraFrame>& frame)
 
         XrMatrix4x4f projectionMatrix = ToXRMatrix4x4Inverted(vrProjection);
         XrMatrix4x4f_Multiply(&m_cameraProjectionInvFarLeft, &projectionMatrix, &transMatrix);
+        XrMatrix4x4f_Invert(&m_cameraProjectionFarLeft, &m_cameraProjectionInvFarLeft);
 
         if (bIsStereo)
         {
@@ -644,6 +639,7 @@ void CameraManager::UpdateProjectionMatrix(std::shared_ptr<CameraFrame>& frame)
 
             XrMatrix4x4f projectionMatrix = ToXRMatrix4x4Inverted(vrProjection);
             XrMatrix4x4f_Multiply(&m_cameraProjectionInvFarRight, &projectionMatrix, &transMatrix);
+            XrMatrix4x4f_Invert(&m_cameraProjectionFarRight, &m_cameraProjectionInvFarRight);
 
         }
     }
@@ -654,8 +650,26 @@ void CameraManager::CalculateFrameProjection(std::shared_ptr<CameraFrame>& frame
 {
     UpdateProjectionMatrix(frame);
 
-    CalculateFrameProjectionForEye(LEFT_EYE, frame, layer, refSpaceInfo, distortionParams);
-    CalculateFrameProjectionForEye(RIGHT_EYE, frame, layer, refSpaceInfo, distortionParams);
+    // Evaluate the inputs shared by both eyes once per frame.
+    FrameProjectionInputs inputs;
+    inputs.refSpaceTransform = GetRefSpaceTransform(refSpaceInfo);
+
+    std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+
+    if (config->Main.ProjectionMode == Projection_RoomView2D)
+    {
+        inputs.leftCameraToTracking = ToXRMatrix4x4(frame->header.trackedDevicePose.mDeviceToAbsoluteTracking);
+        XrMatrix4x4f_InvertRigidBodySIMD(&inputs.leftCameraFromTracking, &inputs.leftCameraToTracking);
+    }
+    else
+    {
+        // The camera calibration may contain scaling, so these need the general inverse.
+        XrMatrix4x4f_InvertSIMD(&inputs.leftCameraFromTracking, &frame->cameraViewToWorldLeft);
+        XrMatrix4x4f_InvertSIMD(&inputs.rightCameraFromTracking, &frame->cameraViewToWorldRight);
+    }
+
+    CalculateFrameProjectionForEye(LEFT_EYE, frame, layer, inputs, distortionParams);
+    CalculateFrameProjectionForEye(RIGHT_EYE, frame, layer, inputs, distortionParams);
 
 
     if (frame->header.nFrameSequence != m_lastFrameSequence)
@@ -692,40 +706,80 @@ void CameraManager::CalculateFrameProjection(std::shared_ptr<CameraFrame>& frame
     m_lastWorldToHMDProjectionRight = frame->worldToHMDProjectionRight;
 
 
-    if (m_configManager->GetConfig_Main().ProjectToRenderModels)
+    if (config->Main.ProjectToRenderModels && frame->renderModels)
     {
-        LARGE_INTEGER time, freq;
-        QueryPerformanceCounter(&time);
-        QueryPerformanceFrequency(&freq);
-
-        float exposureRelativeTime = -(float)(time.QuadPart - frame->header.ulFrameExposureTime);
-        exposureRelativeTime /= ((float)freq.QuadPart);
+        // Resolve the device poses at camera exposure time from the sampled history instead of querying OpenVR on the render thread.
+        uint64_t exposureTime = PerfCounterToNs(frame->header.ulFrameExposureTime);
 
+        bool bQueriedDirectPoses = false;
         vr::TrackedDevicePose_t trackedDevicePoseArray[vr::k_unMaxTrackedDeviceCount];
 
-        m_openVRManager->GetVRSystem()->GetDeviceToAbsoluteTrackingPose(vr::TrackingUniverseStanding, exposureRelativeTime, trackedDevicePoseArray, vr::k_unMaxTrackedDeviceCount);
-
-        for (RenderModel& model : *m_renderModels.get())
+        for (RenderModel& model : *frame->renderModels)
         {
-            model.meshToWorldTransform = ToXRMatrix4x4(trackedDevicePoseArray[model.deviceId].mDeviceToAbsoluteTracking);
+            if (model.deviceId >= vr::k_unMaxTrackedDeviceCount)
+            {
+                continue;
+            }
+
+            if (m_poseHistory->GetDevicePoseMatrix(model.deviceId, exposureTime, model.meshToWorldTransform))
+            {
+                m_lastKnownDevicePoses[model.deviceId] = model.meshToWorldTransform;
+                m_bHasLastKnownDevicePose[model.deviceId] = true;
+                continue;
+            }
+
+            // The history has no valid sample yet, for example right after sampling was enabled. Query OpenVR directly once per frame.
+            if (!bQueriedDirectPoses)
+            {
+                LARGE_INTEGER time, freq;
+                QueryPerformanceCounter(&time);
+                QueryPerformanceFrequency(&freq);
+
+                float exposureRelativeTime = -(float)(time.QuadPart - frame->header.ulFrameExposureTime);
+                exposureRelativeTime /= ((float)freq.QuadPart);
+
+                vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
+
+                if (vrSystem)
+                {
+                    vrSystem->GetDeviceToAbsoluteTrackingPose(vr::TrackingUniverseStanding, exposureRelativeTime, trackedDevicePoseArray, vr::k_unMaxTrackedDeviceCount);
+                }
+                else
+                {
+                    memset(trackedDevicePoseArray, 0, sizeof(trackedDevicePoseArray));
+                }
+                bQueriedDirectPoses = true;
+            }
+
+            if (trackedDevicePoseArray[model.deviceId].bPoseIsValid)
+            {
+                model.meshToWorldTransform = ToXRMatrix4x4(trackedDevicePoseArray[model.deviceId].mDeviceToAbsoluteTracking);
+                m_lastKnownDevicePoses[model.deviceId] = model.meshToWorldTransform;
+                m_bHasLastKnownDevicePose[model.deviceId] = true;
+            }
+            else if (m_bHasLastKnownDevicePose[model.deviceId])
+            {
+                model.meshToWorldTransform = m_lastKnownDevicePoses[model.deviceId];
+            }
         }
     }
 }
 
-void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::shared_ptr<CameraFrame>& frame, const XrCompositionLayerProjection& layer, const XrReferenceSpaceCreateInfo& refSpaceInfo, UVDistortionParameters& distortionParams)
+void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::shared_ptr<CameraFrame>& frame, const XrCompositionLayerProjection& layer, const FrameProjectionInputs& inputs, UVDistortionParameters& distortionParams)
 {
-    Config_Main& mainConf = m_configManager->GetConfig_Main();
+    std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+    const Config_Main& mainConf = config->Main;
 
     bool bIsStereo = m_frameLayout != EStereoFrameLayout::Mono;
     uint32_t cameraId = (eye == RIGHT_EYE && bIsStereo) ? 1 : 0;
 
-    XrMatrix4x4f hmdWorldToView = GetHMDWorldToViewMatrix(eye, layer, refSpaceInfo);
+    XrMatrix4x4f hmdWorldToView = GetHMDWorldToViewMatrix(eye, layer, inputs.refSpaceTransform);
     
+    // The view position is the translation of the rigid inverse.
     XrVector3f* hmdWorldPos = (eye == LEFT_EYE) ? &frame->hmdViewPosWorldLeft : &frame->hmdViewPosWorldRight;
     XrMatrix4x4f hmdViewToWorld;
-    XrMatrix4x4f_Invert(&hmdViewToWorld, &hmdWorldToView);
-    XrVector3f inPos{ 0,0,0 };
-    XrMatrix4x4f_TransformVector3f(hmdWorldPos, &hmdViewToWorld, &inPos);
+    XrMatrix4x4f_InvertRigidBodySIMD(&hmdViewToWorld, &hmdWorldToView);
+    *hmdWorldPos = { hmdViewToWorld.m[12], hmdViewToWorld.m[13], hmdViewToWorld.m[14] };
 
 
     float nearZ = NEAR_PROJECTION_DISTANCE;
@@ -733,7 +787,7 @@ void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::sh
 
     const XrCompositionLayerDepthInfoKHR* depthInfo = nullptr;
 
-    if (m_configManager->GetConfig_Depth().DepthReadFromApplication)
+    if (config->Depth.DepthReadFromApplication)
     {
         depthInfo = (const XrCompositionLayerDepthInfoKHR*)layer.views[(eye == LEFT_EYE) ? 0 : 1].next;
 
@@ -782,35 +836,31 @@ void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::sh
 
     XrMatrix4x4f* worldToHMDMatrix = (eye == LEFT_EYE) ? &frame->worldToHMDProjectionLeft : &frame->worldToHMDProjectionRight;
 
-    XrMatrix4x4f_Multiply(worldToHMDMatrix, &hmdProjection, &hmdWorldToView);
+    XrMatrix4x4f_MultiplySIMD(worldToHMDMatrix, &hmdProjection, &hmdWorldToView);
 
 
 
     if (mainConf.ProjectionMode == Projection_RoomView2D)
     {
-        XrMatrix4x4f leftCameraToTrackingPose = ToXRMatrix4x4(frame->header.trackedDevicePose.mDeviceToAbsoluteTracking);
-
+        // The world to camera projections are built from the cached projection inverses and the rigid camera pose inverse
+        // instead of inverting the combined matrices.
         if (eye == LEFT_EYE)
         {
-
-            XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldLeft, &leftCameraToTrackingPose, &m_cameraProjectionInvFarLeft);
-
-            XrMatrix4x4f_Invert(&frame->worldToCameraProjectionLeft, &frame->cameraProjectionToWorldLeft);
+            XrMatrix4x4f_MultiplySIMD(&frame->cameraProjectionToWorldLeft, &inputs.leftCameraToTracking, &m_cameraProjectionInvFarLeft);
+            XrMatrix4x4f_MultiplySIMD(&frame->worldToCameraProjectionLeft, &m_cameraProjectionFarLeft, &inputs.leftCameraFromTracking);
         }
         else
         {
             if (bIsStereo)
             {
-                XrMatrix4x4f tempMatrix;
-                XrMatrix4x4f_Multiply(&tempMatrix, &leftCameraToTrackingPose, &m_cameraRightToLeftPose);
-                XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldRight, &tempMatrix, &m_cameraProjectionInvFarRight);
+                XrMatrix4x4f_Multiply3SIMD(&frame->cameraProjectionToWorldRight, &inputs.leftCameraToTracking, &m_cameraRightToLeftPose, &m_cameraProjectionInvFarRight);
+                XrMatrix4x4f_Multiply3SIMD(&frame->worldToCameraProjectionRight, &m_cameraProjectionFarRight, &m_cameraLeftToRightPose, &inputs.leftCameraFromTracking);
             }
             else
             {
-                XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldRight, &leftCameraToTrackingPose, &m_cameraProjectionInvFarLeft);
+                XrMatrix4x4f_MultiplySIMD(&frame->cameraProjectionToWorldRight, &inputs.leftCameraToTracking, &m_cameraProjectionInvFarLeft);
+                XrMatrix4x4f_MultiplySIMD(&frame->worldToCameraProjectionRight, &m_cameraProjectionFarLeft, &inputs.leftCameraFromTracking);
             }
-
-            XrMatrix4x4f_Invert(&frame->worldToCameraProjectionRight, &frame->cameraProjectionToWorldRight);
         }
     }
     else
@@ -834,10 +884,7 @@ void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::sh
         frameProjection.m[15] = 0.0f;
 
         XrMatrix4x4f frameProjectionInverse;
-        XrMatrix4x4f_Invert(&frameProjectionInverse, &frameProjection);
-
-        XrMatrix4x4f leftCameraFromTrackingPose;
-        XrMatrix4x4f_Invert(&leftCameraFromTrackingPose, &frame->cameraViewToWorldLeft);
+        XrMatrix4x4f_InvertSIMD(&frameProjectionInverse, &frameProjection);
 
         if (eye == LEFT_EYE)
         {
@@ -851,37 +898,25 @@ void CameraManager::CalculateFrameProjectionForEye(const ERenderEye eye, std::sh
             XrMatrix4x4f rectifiedRotationInverse;
             XrMatrix4x4f_Transpose(&rectifiedRotationInverse, &rectifiedRotation);
 
-            XrMatrix4x4f tempMatrix;
-            XrMatrix4x4f_Multiply(&tempMatrix, &rectifiedRotationInverse, &leftCameraFromTrackingPose);
-            XrMatrix4x4f_Multiply(&frame->worldToCameraProjectionLeft, &frameProjection, &tempMatrix);
-
-            XrMatrix4x4f_Multiply(&tempMatrix, &rectifiedRotation, &frameProjectionInverse);
-            XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldLeft, &frame->cameraViewToWorldLeft, &tempMatrix);
+            XrMatrix4x4f_Multiply3SIMD(&frame->worldToCameraProjectionLeft, &frameProjection, &rectifiedRotationInverse, &inputs.leftCameraFromTracking);
+            XrMatrix4x4f_Multiply3SIMD(&frame->cameraProjectionToWorldLeft, &frame->cameraViewToWorldLeft, &rectifiedRotation, &frameProjectionInverse);
         }
         else
         {
-            XrMatrix4x4f rightCameraFromTrackingPose;
-            XrMatrix4x4f_Invert(&rightCameraFromTrackingPose, &frame->cameraViewToWorldRight);
-
             XrMatrix4x4f rectifiedRotation = distortionParams.rectifiedRotationRight;
 
             XrMatrix4x4f rectifiedRotationInverse;
             XrMatrix4x4f_Transpose(&rectifiedRotationInverse, &rectifiedRotation);       
             
-            XrMatrix4x4f tempMatrix;
-            XrMatrix4x4f_Multiply(&tempMatrix, &rectifiedRotationInverse, &rightCameraFromTrackingPose);
-            XrMatrix4x4f_Multiply(&frame->worldToCameraProjectionRight, &frameProjection, &tempMatrix);
-            
+            XrMatrix4x4f_Multiply3SIMD(&frame->worldToCameraProjectionRight, &frameProjection, &rectifiedRotationInverse, &inputs.rightCameraFromTracking);
 
             if (bIsStereo)
             {           
-                XrMatrix4x4f_Multiply(&tempMatrix, &rectifiedRotation, &frameProjectionInverse);
-                XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldRight, &frame->cameraViewToWorldRight, &tempMatrix);
+                XrMatrix4x4f_Multiply3SIMD(&frame->cameraProjectionToWorldRight, &frame->cameraViewToWorldRight, &rectifiedRotation, &frameProjectionInverse);
             }
             else
             {
-                XrMatrix4x4f_Multiply(&tempMatrix, &distortionParams.rectifiedRotationLeft, &frameProjectionInverse);
-                XrMatrix4x4f_Multiply(&frame->cameraProjectionToWorldRight, &frame->cameraViewToWorldLeft, &tempMatrix);
+                XrMatrix4x4f_Multiply3SIMD(&frame->cameraProjectionToWorldRight, &frame->cameraViewToWorldLeft, &distortionParams.rectifiedRotationLeft, &frameProjectionInverse);
             }
         }
     }
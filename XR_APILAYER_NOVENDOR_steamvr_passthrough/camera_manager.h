@@ -7,6 +7,8 @@
 #include "passthrough_renderer.h"
 #include "openvr_manager.h"
 #include "mesh.h"
+#include "pose_history.h"
+#include "render_model_cache.h"
 
 
 enum ETrackedCameraFrameType
@@ -25,6 +27,16 @@ struct ECameraDistortionCoefficients
 #define FRAME_POLL_INTERVAL (std::chrono::microseconds(100))
 
 
+// Per frame values shared by the projection setup of both eyes.
+struct FrameProjectionInputs
+{
+	XrMatrix4x4f refSpaceTransform{};
+	XrMatrix4x4f leftCameraToTracking{};
+	XrMatrix4x4f leftCameraFromTracking{};
+	XrMatrix4x4f rightCameraFromTracking{};
+};
+
+
 class CameraManager
 {
 public:
@@ -41,17 +53,16 @@ public:
 	EStereoFrameLayout GetFrameLayout() const;
 	XrMatrix4x4f GetLeftToRightCameraTransform() const;
 	void UpdateStaticCameraParameters();
-	float GetFrameRetrievalPerfTime() { return m_averageFrameRetrievalTime; }
 	bool GetCameraFrame(std::shared_ptr<CameraFrame>& frame);
 	void CalculateFrameProjection(std::shared_ptr<CameraFrame>& frame, const XrCompositionLayerProjection& layer, float timeToPhotons, const XrReferenceSpaceCreateInfo& refSpaceInfo, UVDistortionParameters& distortionParams);
 
 private:
 	void ServeFrames();
-	void UpdateRenderModels();
 	void GetTrackedCameraEyePoses(XrMatrix4x4f& LeftPose, XrMatrix4x4f& RightPose);
-	XrMatrix4x4f GetHMDWorldToViewMatrix(const ERenderEye eye, const XrCompositionLayerProjection& layer, const XrReferenceSpaceCreateInfo& refSpaceInfo);
+	XrMatrix4x4f GetRefSpaceTransform(const XrReferenceSpaceCreateInfo& refSpaceInfo);
+	XrMatrix4x4f GetHMDWorldToViewMatrix(const ERenderEye eye, const XrCompositionLayerProjection& layer, const XrMatrix4x4f& refSpaceTransform);
 	void UpdateProjectionMatrix(std::shared_ptr<CameraFrame>& frame);
-	void CalculateFrameProjectionForEye(const ERenderEye eye, std::shared_ptr<CameraFrame>& frame, const XrCompositionLayerProjection& layer, const XrReferenceSpaceCreateInfo& refSpaceInfo, UVDistortionParameters& distortionParams);
+	void CalculateFrameProjectionForEye(const ERenderEye eye, std::shared_ptr<CameraFrame>& frame, const XrCompositionLayerProjection& layer, const FrameProjectionInputs& inputs, UVDistortionParameters& distortionParams);
 
 	std::shared_ptr<ConfigManager> m_configManager;
 	std::shared_ptr<OpenVRManager> m_openVRManager;
@@ -72,7 +83,7 @@ private:
 	ERenderAPI m_renderAPI;
 	std::thread m_serveThread;
 	std::atomic_bool m_bRunThread = true;
-	std::mutex m_serveMutex;
+	ProfiledMutex m_serveMutex{ "CameraServe" };
 
 	std::shared_ptr<CameraFrame> m_renderFrame;
 	std::shared_ptr<CameraFrame> m_servedFrame;
@@ -91,6 +102,8 @@ private:
 
 	XrMatrix4x4f m_cameraProjectionInvFarLeft{};
 	XrMatrix4x4f m_cameraProjectionInvFarRight{};
+	XrMatrix4x4f m_cameraProjectionFarLeft{};
+	XrMatrix4x4f m_cameraProjectionFarRight{};
 
 	XrMatrix4x4f m_cameraToHMDLeft{};
 	XrMatrix4x4f m_cameraToHMDRight{};
@@ -108,9 +121,15 @@ private:
 	XrMatrix4x4f m_lastWorldToHMDProjectionRight;
 	uint32_t m_lastFrameSequence;
 
-	std::deque<float> m_frameRetrievalTimes;
-	float m_averageFrameRetrievalTime;
+	// Fallback for render models whose pose is missing from the history.
+	std::array<XrMatrix4x4f, vr::k_unMaxTrackedDeviceCount> m_lastKnownDevicePoses{};
+	std::array<bool, vr::k_unMaxTrackedDeviceCount> m_bHasLastKnownDevicePose{};
+
+	MetricTimer& m_frameRetrievalTimer;
+	MetricCounter& m_servedFramesCounter;
+	MetricGauge& m_frameSequenceGauge;
 
-	std::shared_ptr<std::vector<RenderModel>> m_renderModels;
+	std::unique_ptr<PoseHistory> m_poseHistory;
+	std::unique_ptr<RenderModelCache> m_renderModelCache;
 };
 
@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "config_manager.h"
+#include <format>
 #include <log.h>
+#include "trace.h"
+#include "atomic_file.h"
 
 using namespace steamvr_passthrough;
 using namespace steamvr_passthrough::log;
@@ -10,52 +13,113 @@ ConfigManager::ConfigManager(std::wstring configFile)
 	, m_bConfigUpdated(false)
 	, m_iniData()
 	, m_debugTexture()
+	, m_persistWriter(CONFIG_PERSIST_DEBOUNCE, [this](const ConfigFileData& data) { WriteConfigFile(data); })
+	, m_writeTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_CONFIG_WRITE))
+	, m_writeCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_CONFIG_WRITES))
 {
 	m_iniData.SetUnicode(true);
 	SetupStereoPresets();
+	PublishSnapshot();
+
+	m_persistThread = std::thread(&ConfigManager::RunPersistThread, this);
 }
 
 ConfigManager::~ConfigManager()
 {
-	DispatchUpdate();
+	// The persistence thread flushes any pending write before exiting.
+	m_persistWriter.Stop();
+
+	if (m_persistThread.joinable())
+	{
+		m_persistThread.join();
+	}
 }
 
 void ConfigManager::ReadConfigFile()
 {
-	SI_Error result = m_iniData.LoadFile(m_configFile.c_str());
-	if (result < 0)
+	bool bWriteDefaults = false;
 	{
-		Log("Failed to read config file, writing default values...\n");
-		UpdateConfigFile();
+		std::lock_guard<std::mutex> lock(m_iniMutex);
+
+		SI_Error result = m_iniData.LoadFile(m_configFile.c_str());
+		if (result < 0)
+		{
+			Log("Failed to read config file, writing default values...\n");
+			bWriteDefaults = true;
+		}
+		else
+		{
+			ParseConfig_Main();
+			ParseConfig_Core();
+			ParseConfig_Extensions();
+			ParseConfig_Stereo();
+			ParseConfig_Depth();
+		}
 	}
-	else
+	m_bConfigUpdated = false;
+
+	if (bWriteDefaults)
 	{
-		ParseConfig_Main();
-		ParseConfig_Core();
-		ParseConfig_Extensions();
-		ParseConfig_Stereo();
-		ParseConfig_Depth();
+		RequestPersist(true);
 	}
-	m_bConfigUpdated = false;
 
 	m_stereoPresets[0] = m_configCustomStereo;
+	PublishSnapshot();
 }
 
-void ConfigManager::UpdateConfigFile()
+void ConfigManager::RequestPersist(bool bImmediate)
 {
-	UpdateConfig_Main();
-	UpdateConfig_Core();
-	UpdateConfig_Extensions();
-	UpdateConfig_Stereo();
-	UpdateConfig_Depth();
-
-	SI_Error result = m_iniData.SaveFile(m_configFile.c_str());
-	if (result < 0)
+	ConfigFileData data;
+	data.Main = m_configMain;
+	data.Core = m_configCore;
+	data.Extensions = m_configExtensions;
+	data.CustomStereo = m_configCustomStereo;
+	data.Depth = m_configDepth;
+	m_persistWriter.Request(data, bImmediate);
+
+	if (bImmediate)
 	{
-		ErrorLog("Failed to save config file, %i \n", errno);
+		m_bConfigUpdated = false;
 	}
+}
 
-	m_bConfigUpdated = false;
+void ConfigManager::RunPersistThread()
+{
+	Tracer::Get().SetThreadName("Config writer");
+	m_persistWriter.Run();
+}
+
+void ConfigManager::WriteConfigFile(const ConfigFileData& config)
+{
+	TraceSpan span("ConfigWrite");
+	uint64_t startTime = GetMonotonicTimeNs();
+
+	std::string data;
+	{
+		std::lock_guard<std::mutex> lock(m_iniMutex);
+
+		UpdateConfig_Main(config.Main);
+		UpdateConfig_Core(config.Core);
+		UpdateConfig_Extensions(config.Extensions);
+		UpdateConfig_Stereo(config.CustomStereo);
+		UpdateConfig_Depth(config.Depth);
+
+		SI_Error result = m_iniData.Save(data, true);
+		if (result < 0)
+		{
+			ErrorLog("Failed to serialize config file, %i \n", result);
+			return;
+		}
+	}
+
+	if (!WriteFileAtomic(m_configFile, data))
+	{
+		ErrorLog("Failed to save config file\n");
+		return;
+	}
+
+	m_writeTimer.RecordSince(startTime);
+	m_writeCounter.Add();
 }
 
 void ConfigManager::ConfigUpdated()
@@ -66,13 +130,29 @@ void ConfigManager::ConfigUpdated()
 	{
 		m_stereoPresets[0] = m_configCustomStereo;
 	}
+
+	PublishSnapshot();
+	RequestPersist(false);
+}
+
+void ConfigManager::PublishSnapshot()
+{
+	ConfigSnapshot snapshot;
+	snapshot.Main = m_configMain;
+	snapshot.Core = m_configCore;
+	snapshot.Extensions = m_configExtensions;
+	snapshot.Stereo = m_stereoPresets[m_configMain.StereoPreset];
+	snapshot.Depth = m_configDepth;
+
+	// The dashboard reports updates every frame while a control is active, so only actual changes are published.
+	m_snapshots.Publish(snapshot);
 }
 
 void ConfigManager::DispatchUpdate()
 {
 	if (m_bConfigUpdated)
 	{
-		UpdateConfigFile();
+		RequestPersist(true);
 	}
 }
 
@@ -83,9 +163,10 @@ void ConfigManager::ResetToDefaults()
 	m_configExtensions = Config_Extensions();
 	m_configCustomStereo = Config_Stereo();
 	m_configDepth = Config_Depth();
-	UpdateConfigFile();
+	RequestPersist(true);
 
 	m_stereoPresets[0] = m_configCustomStereo;
+	PublishSnapshot();
 }
 
 void ConfigManager::SetupStereoPresets()
@@ -290,6 +371,7 @@ void ConfigManager::ParseConfig_Main()
 	m_configMain.EnablePassthrough = m_iniData.GetBoolValue("Main", "EnablePassthrough", m_configMain.EnablePassthrough);
 	m_configMain.ProjectionMode = (EProjectionMode)m_iniData.GetLongValue("Main", "ProjectionMode", m_configMain.ProjectionMode);
 	m_configMain.ProjectToRenderModels = m_iniData.GetBoolValue("Main", "ProjectToRenderModels", m_configMain.ProjectToRenderModels);
+	m_configMain.RenderModelMaxTriangles = (int)m_iniData.GetLongValue("Main", "RenderModelMaxTriangles", m_configMain.RenderModelMaxTriangles);
 
 	m_configMain.PassthroughOpacity = (float)m_iniData.GetDoubleValue("Main", "PassthroughOpacity", m_configMain.PassthroughOpacity);
 	m_configMain.ProjectionDistanceFar = (float)m_iniData.GetDoubleValue("Main", "ProjectionDistanceFar", m_configMain.ProjectionDistanceFar);
@@ -342,12 +424,19 @@ void ConfigManager::ParseConfig_Extensions()
 void ConfigManager::ParseConfig_Stereo()
 {
 	m_configCustomStereo.StereoUseMulticore = m_iniData.GetBoolValue("StereoCustom", "StereoUseMulticore", m_configCustomStereo.StereoUseMulticore);
+	m_configCustomStereo.StereoThreadCount = (int)m_iniData.GetLongValue("StereoCustom", "StereoThreadCount", m_configCustomStereo.StereoThreadCount);
+	m_configCustomStereo.StereoThreadAffinityMask = strtoull(m_iniData.GetValue("StereoCustom", "StereoThreadAffinityMask", "0"), nullptr, 0);
+	m_configCustomStereo.StereoThreadPriority = (int)m_iniData.GetLongValue("StereoCustom", "StereoThreadPriority", m_configCustomStereo.StereoThreadPriority);
 	m_configCustomStereo.StereoRectificationFiltering = m_iniData.GetBoolValue("StereoCustom", "StereoRectificationFiltering", m_configCustomStereo.StereoRectificationFiltering);
 	m_configCustomStereo.StereoUseColor = m_iniData.GetBoolValue("StereoCustom", "StereoUseColor", m_configCustomStereo.StereoUseColor);
 	m_configCustomStereo.StereoUseBWInputAlpha = m_iniData.GetBoolValue("StereoCustom", "StereoUseBWInputAlpha", m_configCustomStereo.StereoUseBWInputAlpha);
 	m_configCustomStereo.StereoUseHexagonGridMesh = m_iniData.GetBoolValue("StereoCustom", "StereoUseHexagonGridMesh", m_configCustomStereo.StereoUseHexagonGridMesh);
 	m_configCustomStereo.StereoFillHoles = m_iniData.GetBoolValue("StereoCustom", "StereoFillHoles", m_configCustomStereo.StereoFillHoles);
+	m_configCustomStereo.StereoRoomCache = m_iniData.GetBoolValue("StereoCustom", "StereoRoomCache", m_configCustomStereo.StereoRoomCache);
+	m_configCustomStereo.StereoRoomCacheVoxelSize = (float)m_iniData.GetDoubleValue("StereoCustom", "StereoRoomCacheVoxelSize", m_configCustomStereo.StereoRoomCacheVoxelSize);
 	m_configCustomStereo.StereoFrameSkip = m_iniData.GetLongValue("StereoCustom", "StereoFrameSkip", m_configCustomStereo.StereoFrameSkip);
+	m_configCustomStereo.StereoSkipUnchanged = m_iniData.GetBoolValue("StereoCustom", "StereoSkipUnchanged", m_configCustomStereo.StereoSkipUnchanged);
+	m_configCustomStereo.StereoChangeThreshold = (float)m_iniData.GetDoubleValue("StereoCustom", "StereoChangeThreshold", m_configCustomStereo.StereoChangeThreshold);
 	m_configCustomStereo.StereoDownscaleFactor = m_iniData.GetLongValue("StereoCustom", "StereoDownscaleFactor", m_configCustomStereo.StereoDownscaleFactor);
 	m_configCustomStereo.StereoUseDisparityTemporalFiltering = m_iniData.GetBoolValue("StereoCustom", "StereoUseDisparityTemporalFiltering", m_configCustomStereo.StereoUseDisparityTemporalFiltering);
 	m_configCustomStereo.StereoDisparityTemporalFilteringStrength = (float)m_iniData.GetDoubleValue("StereoCustom", "StereoDisparityTemporalFilteringStrength", m_configCustomStereo.StereoDisparityTemporalFilteringStrength);
@@ -396,112 +485,120 @@ void ConfigManager::ParseConfig_Depth()
 }
 
 
-void ConfigManager::UpdateConfig_Main()
+void ConfigManager::UpdateConfig_Main(const Config_Main& config)
 {
-	m_iniData.SetBoolValue("Main", "EnablePassthrough", m_configMain.EnablePassthrough);
-	m_iniData.SetLongValue("Main", "ProjectionMode", (long)m_configMain.ProjectionMode);
-	m_iniData.SetBoolValue("Main", "ProjectToRenderModels", m_configMain.ProjectToRenderModels);
-
-	//m_iniData.SetBoolValue("Main", "ShowTestImage", m_configMain.ShowTestImage);
-	m_iniData.SetDoubleValue("Main", "PassthroughOpacity", m_configMain.PassthroughOpacity);
-	m_iniData.SetDoubleValue("Main", "ProjectionDistanceFar", m_configMain.ProjectionDistanceFar);
-	m_iniData.SetDoubleValue("Main", "FloorHeightOffset", m_configMain.FloorHeightOffset);
-	m_iniData.SetDoubleValue("Main", "FieldOfViewScale", m_configMain.FieldOfViewScale);
-	m_iniData.SetDoubleValue("Main", "DepthOffsetCalibration", m_configMain.DepthOffsetCalibration);
-
-	m_iniData.SetDoubleValue("Main", "Brightness", m_configMain.Brightness);
-	m_iniData.SetDoubleValue("Main", "Contrast", m_configMain.Contrast);
-	m_iniData.SetDoubleValue("Main", "Saturation", m_configMain.Saturation);
-	m_iniData.SetDoubleValue("Main", "Sharpness", m_configMain.Sharpness);
-
-	m_iniData.SetBoolValue("Main", "EnableTemporalFiltering", m_configMain.EnableTemporalFiltering);
-	m_iniData.SetLongValue("Main", "TemporalFilteringSampling", m_configMain.TemporalFilteringSampling);
-
-	m_iniData.SetBoolValue("Main", "RequireSteamVRRuntime", m_configMain.RequireSteamVRRuntime);
-	m_iniData.SetBoolValue("Main", "ShowSettingDescriptions", m_configMain.ShowSettingDescriptions);
-	m_iniData.SetBoolValue("Main", "UseLegacyD3D12Renderer", m_configMain.UseLegacyD3D12Renderer);
-
-	m_iniData.SetLongValue("Main", "StereoPreset", m_configMain.StereoPreset);
+	m_iniData.SetBoolValue("Main", "EnablePassthrough", config.EnablePassthrough);
+	m_iniData.SetLongValue("Main", "ProjectionMode", (long)config.ProjectionMode);
+	m_iniData.SetBoolValue("Main", "ProjectToRenderModels", config.ProjectToRenderModels);
+	m_iniData.SetLongValue("Main", "RenderModelMaxTriangles", config.RenderModelMaxTriangles);
+
+	//m_iniData.SetBoolValue("Main", "ShowTestImage", config.ShowTestImage);
+	m_iniData.SetDoubleValue("Main", "PassthroughOpacity", config.PassthroughOpacity);
+	m_iniData.SetDoubleValue("Main", "ProjectionDistanceFar", config.ProjectionDistanceFar);
+	m_iniData.SetDoubleValue("Main", "FloorHeightOffset", config.FloorHeightOffset);
+	m_iniData.SetDoubleValue("Main", "FieldOfViewScale", config.FieldOfViewScale);
+	m_iniData.SetDoubleValue("Main", "DepthOffsetCalibration", config.DepthOffsetCalibration);
+
+	m_iniData.SetDoubleValue("Main", "Brightness", config.Brightness);
+	m_iniData.SetDoubleValue("Main", "Contrast", config.Contrast);
+	m_iniData.SetDoubleValue("Main", "Saturation", config.Saturation);
+	m_iniData.SetDoubleValue("Main", "Sharpness", config.Sharpness);
+
+	m_iniData.SetBoolValue("Main", "EnableTemporalFiltering", config.EnableTemporalFiltering);
+	m_iniData.SetLongValue("Main", "TemporalFilteringSampling", config.TemporalFilteringSampling);
+
+	m_iniData.SetBoolValue("Main", "RequireSteamVRRuntime", config.RequireSteamVRRuntime);
+	m_iniData.SetBoolValue("Main", "ShowSettingDescriptions", config.ShowSettingDescriptions);
+	m_iniData.SetBoolValue("Main", "UseLegacyD3D12Renderer", config.UseLegacyD3D12Renderer);
+
+	m_iniData.SetLongValue("Main", "StereoPreset", config.StereoPreset);
 }
 
-void ConfigManager::UpdateConfig_Core()
+void ConfigManager::UpdateConfig_Core(const Config_Core& config)
 {
-	m_iniData.SetBoolValue("Core", "CorePassthroughEnable", m_configCore.CorePassthroughEnable);
-	m_iniData.SetBoolValue("Core", "CoreAlphaBlend", m_configCore.CoreAlphaBlend);
-	m_iniData.SetBoolValue("Core", "CoreAdditive", m_configCore.CoreAdditive);
-	m_iniData.SetLongValue("Core", "CorePreferredMode", m_configCore.CorePreferredMode);
-
-	m_iniData.SetBoolValue("Core", "CoreForcePassthrough", m_configCore.CoreForcePassthrough);
-	m_iniData.SetLongValue("Core", "CoreForceMode", m_configCore.CoreForceMode);
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedFractionChroma", m_configCore.CoreForceMaskedFractionChroma);
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedFractionLuma", m_configCore.CoreForceMaskedFractionLuma);
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedSmoothing", m_configCore.CoreForceMaskedSmoothing);
-
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorR", m_configCore.CoreForceMaskedKeyColor[0]);
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorG", m_configCore.CoreForceMaskedKeyColor[1]);
-	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorB", m_configCore.CoreForceMaskedKeyColor[2]);
-
-	m_iniData.SetBoolValue("Core", "CoreForceMaskedUseCameraImage", m_configCore.CoreForceMaskedUseCameraImage);
-	m_iniData.SetBoolValue("Core", "CoreForceMaskedInvertMask", m_configCore.CoreForceMaskedInvertMask);
+	m_iniData.SetBoolValue("Core", "CorePassthroughEnable", config.CorePassthroughEnable);
+	m_iniData.SetBoolValue("Core", "CoreAlphaBlend", config.CoreAlphaBlend);
+	m_iniData.SetBoolValue("Core", "CoreAdditive", config.CoreAdditive);
+	m_iniData.SetLongValue("Core", "CorePreferredMode", config.CorePreferredMode);
+
+	m_iniData.SetBoolValue("Core", "CoreForcePassthrough", config.CoreForcePassthrough);
+	m_iniData.SetLongValue("Core", "CoreForceMode", config.CoreForceMode);
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedFractionChroma", config.CoreForceMaskedFractionChroma);
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedFractionLuma", config.CoreForceMaskedFractionLuma);
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedSmoothing", config.CoreForceMaskedSmoothing);
+
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorR", config.CoreForceMaskedKeyColor[0]);
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorG", config.CoreForceMaskedKeyColor[1]);
+	m_iniData.SetDoubleValue("Core", "CoreForceMaskedKeyColorB", config.CoreForceMaskedKeyColor[2]);
+
+	m_iniData.SetBoolValue("Core", "CoreForceMaskedUseCameraImage", config.CoreForceMaskedUseCameraImage);
+	m_iniData.SetBoolValue("Core", "CoreForceMaskedInvertMask", config.CoreForceMaskedInvertMask);
 }
 
-void ConfigManager::UpdateConfig_Extensions()
+void ConfigManager::UpdateConfig_Extensions(const Config_Extensions& config)
 {
-	m_iniData.SetBoolValue("Extensions", "ExtVarjoDepthEstimation", m_configExtensions.ExtVarjoDepthEstimation);
-	m_iniData.SetBoolValue("Extensions", "ExtVarjoDepthComposition", m_configExtensions.ExtVarjoDepthComposition);
+	m_iniData.SetBoolValue("Extensions", "ExtVarjoDepthEstimation", config.ExtVarjoDepthEstimation);
+	m_iniData.SetBoolValue("Extensions", "ExtVarjoDepthComposition", config.ExtVarjoDepthComposition);
 }
 
-void ConfigManager::UpdateConfig_Stereo()
+void ConfigManager::UpdateConfig_Stereo(const Config_Stereo& config)
 {
-	m_iniData.SetBoolValue("StereoCustom", "StereoUseMulticore", m_configCustomStereo.StereoUseMulticore);
-	m_iniData.SetBoolValue("StereoCustom", "StereoRectificationFiltering", m_configCustomStereo.StereoRectificationFiltering);
-	m_iniData.SetBoolValue("StereoCustom", "StereoUseColor", m_configCustomStereo.StereoUseColor);
-	m_iniData.SetBoolValue("StereoCustom", "StereoUseBWInputAlpha", m_configCustomStereo.StereoUseBWInputAlpha);
-	m_iniData.SetBoolValue("StereoCustom", "StereoUseHexagonGridMesh", m_configCustomStereo.StereoUseHexagonGridMesh);
-	m_iniData.SetBoolValue("StereoCustom", "StereoFillHoles", m_configCustomStereo.StereoFillHoles);
-	m_iniData.SetLongValue("StereoCustom", "StereoFrameSkip", m_configCustomStereo.StereoFrameSkip);
-	m_iniData.SetLongValue("StereoCustom", "StereoDownscaleFactor", m_configCustomStereo.StereoDownscaleFactor);
-	m_iniData.SetBoolValue("StereoCustom", "StereoUseDisparityTemporalFiltering", m_configCustomStereo.StereoUseDisparityTemporalFiltering);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoDisparityTemporalFilteringStrength", m_configCustomStereo.StereoDisparityTemporalFilteringStrength);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoDisparityTemporalFilteringDistance", m_configCustomStereo.StereoDisparityTemporalFilteringDistance);
-
-	m_iniData.SetBoolValue("StereoCustom", "StereoDisparityBothEyes", m_configCustomStereo.StereoDisparityBothEyes);
-	m_iniData.SetBoolValue("StereoCustom", "StereoCutoutEnabled", m_configCustomStereo.StereoCutoutEnabled);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutFactor", m_configCustomStereo.StereoCutoutFactor);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutOffset", m_configCustomStereo.StereoCutoutOffset);
-	m_iniData.SetLongValue("StereoCustom", "StereoDisparityFilterWidth", m_configCustomStereo.StereoDisparityFilterWidth);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutFilterWidth", m_configCustomStereo.StereoCutoutFilterWidth);
-
-	m_iniData.SetLongValue("StereoCustom", "StereoBlockSize", m_configCustomStereo.StereoBlockSize);
-	m_iniData.SetLongValue("StereoCustom", "StereoMinDisparity", m_configCustomStereo.StereoMinDisparity);
-	m_iniData.SetLongValue("StereoCustom", "StereoMaxDisparity", m_configCustomStereo.StereoMaxDisparity);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_Mode", m_configCustomStereo.StereoSGBM_Mode);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_P1", m_configCustomStereo.StereoSGBM_P1);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_P2", m_configCustomStereo.StereoSGBM_P2);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_DispMaxDiff", m_configCustomStereo.StereoSGBM_DispMaxDiff);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_PreFilterCap", m_configCustomStereo.StereoSGBM_PreFilterCap);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_UniquenessRatio", m_configCustomStereo.StereoSGBM_UniquenessRatio);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_SpeckleWindowSize", m_configCustomStereo.StereoSGBM_SpeckleWindowSize);
-	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_SpeckleRange", m_configCustomStereo.StereoSGBM_SpeckleRange);
-
-	m_iniData.SetLongValue("StereoCustom", "StereoFiltering", m_configCustomStereo.StereoFiltering);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_Lambda", m_configCustomStereo.StereoWLS_Lambda);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_Sigma", m_configCustomStereo.StereoWLS_Sigma);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_ConfidenceRadius", m_configCustomStereo.StereoWLS_ConfidenceRadius);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Spatial", m_configCustomStereo.StereoFBS_Spatial);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Luma", m_configCustomStereo.StereoFBS_Luma);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Chroma", m_configCustomStereo.StereoFBS_Chroma);
-	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Lambda", m_configCustomStereo.StereoFBS_Lambda);
-	m_iniData.SetLongValue("StereoCustom", "StereoFBS_Iterations", m_configCustomStereo.StereoFBS_Iterations);
+	m_iniData.SetBoolValue("StereoCustom", "StereoUseMulticore", config.StereoUseMulticore);
+	m_iniData.SetLongValue("StereoCustom", "StereoThreadCount", config.StereoThreadCount);
+	m_iniData.SetValue("StereoCustom", "StereoThreadAffinityMask", std::format("0x{:X}", config.StereoThreadAffinityMask).c_str());
+	m_iniData.SetLongValue("StereoCustom", "StereoThreadPriority", config.StereoThreadPriority);
+	m_iniData.SetBoolValue("StereoCustom", "StereoRectificationFiltering", config.StereoRectificationFiltering);
+	m_iniData.SetBoolValue("StereoCustom", "StereoUseColor", config.StereoUseColor);
+	m_iniData.SetBoolValue("StereoCustom", "StereoUseBWInputAlpha", config.StereoUseBWInputAlpha);
+	m_iniData.SetBoolValue("StereoCustom", "StereoUseHexagonGridMesh", config.StereoUseHexagonGridMesh);
+	m_iniData.SetBoolValue("StereoCustom", "StereoFillHoles", config.StereoFillHoles);
+	m_iniData.SetBoolValue("StereoCustom", "StereoRoomCache", config.StereoRoomCache);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoRoomCacheVoxelSize", config.StereoRoomCacheVoxelSize);
+	m_iniData.SetLongValue("StereoCustom", "StereoFrameSkip", config.StereoFrameSkip);
+	m_iniData.SetBoolValue("StereoCustom", "StereoSkipUnchanged", config.StereoSkipUnchanged);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoChangeThreshold", config.StereoChangeThreshold);
+	m_iniData.SetLongValue("StereoCustom", "StereoDownscaleFactor", config.StereoDownscaleFactor);
+	m_iniData.SetBoolValue("StereoCustom", "StereoUseDisparityTemporalFiltering", config.StereoUseDisparityTemporalFiltering);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoDisparityTemporalFilteringStrength", config.StereoDisparityTemporalFilteringStrength);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoDisparityTemporalFilteringDistance", config.StereoDisparityTemporalFilteringDistance);
+
+	m_iniData.SetBoolValue("StereoCustom", "StereoDisparityBothEyes", config.StereoDisparityBothEyes);
+	m_iniData.SetBoolValue("StereoCustom", "StereoCutoutEnabled", config.StereoCutoutEnabled);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutFactor", config.StereoCutoutFactor);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutOffset", config.StereoCutoutOffset);
+	m_iniData.SetLongValue("StereoCustom", "StereoDisparityFilterWidth", config.StereoDisparityFilterWidth);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoCutoutFilterWidth", config.StereoCutoutFilterWidth);
+
+	m_iniData.SetLongValue("StereoCustom", "StereoBlockSize", config.StereoBlockSize);
+	m_iniData.SetLongValue("StereoCustom", "StereoMinDisparity", config.StereoMinDisparity);
+	m_iniData.SetLongValue("StereoCustom", "StereoMaxDisparity", config.StereoMaxDisparity);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_Mode", config.StereoSGBM_Mode);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_P1", config.StereoSGBM_P1);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_P2", config.StereoSGBM_P2);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_DispMaxDiff", config.StereoSGBM_DispMaxDiff);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_PreFilterCap", config.StereoSGBM_PreFilterCap);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_UniquenessRatio", config.StereoSGBM_UniquenessRatio);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_SpeckleWindowSize", config.StereoSGBM_SpeckleWindowSize);
+	m_iniData.SetLongValue("StereoCustom", "StereoSGBM_SpeckleRange", config.StereoSGBM_SpeckleRange);
+
+	m_iniData.SetLongValue("StereoCustom", "StereoFiltering", config.StereoFiltering);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_Lambda", config.StereoWLS_Lambda);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_Sigma", config.StereoWLS_Sigma);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoWLS_ConfidenceRadius", config.StereoWLS_ConfidenceRadius);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Spatial", config.StereoFBS_Spatial);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Luma", config.StereoFBS_Luma);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Chroma", config.StereoFBS_Chroma);
+	m_iniData.SetDoubleValue("StereoCustom", "StereoFBS_Lambda", config.StereoFBS_Lambda);
+	m_iniData.SetLongValue("StereoCustom", "StereoFBS_Iterations", config.StereoFBS_Iterations);
 }
 
-void ConfigManager::UpdateConfig_Depth()
+void ConfigManager::UpdateConfig_Depth(const Config_Depth& config)
 {
-	m_iniData.SetBoolValue("Depth", "DepthReadFromApplication", m_configDepth.DepthReadFromApplication);
-	m_iniData.SetBoolValue("Depth", "DepthWriteOutput", m_configDepth.DepthWriteOutput);
-	m_iniData.SetBoolValue("Depth", "DepthForceComposition", m_configDepth.DepthForceComposition);
+	m_iniData.SetBoolValue("Depth", "DepthReadFromApplication", config.DepthReadFromApplication);
+	m_iniData.SetBoolValue("Depth", "DepthWriteOutput", config.DepthWriteOutput);
+	m_iniData.SetBoolValue("Depth", "DepthForceComposition", config.DepthForceComposition);
 
-	m_iniData.SetBoolValue("Depth", "DepthForceRangeTest", m_configDepth.DepthForceRangeTest);
-	m_iniData.SetDoubleValue("Depth", "DepthForceRangeTestMin", m_configDepth.DepthForceRangeTestMin);
-	m_iniData.SetDoubleValue("Depth", "DepthForceRangeTestMax", m_configDepth.DepthForceRangeTestMax);
+	m_iniData.SetBoolValue("Depth", "DepthForceRangeTest", config.DepthForceRangeTest);
+	m_iniData.SetDoubleValue("Depth", "DepthForceRangeTestMin", config.DepthForceRangeTestMin);
+	m_iniData.SetDoubleValue("Depth", "DepthForceRangeTestMax", config.DepthForceRangeTestMax);
 }
\ No newline at end of file
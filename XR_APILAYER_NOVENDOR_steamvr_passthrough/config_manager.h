@@ -1,5 +1,18 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "SimpleIni.h"
+#include "debounced_writer.h"
+#include "metrics.h"
+#include "profiled_mutex.h"
+#include "snapshot_publisher.h"
+
+
+// Settings edited in the dashboard are written once they have been left unchanged for this long.
+#define CONFIG_PERSIST_DEBOUNCE (std::chrono::milliseconds(1000))
 
 
 enum EProjectionMode
@@ -35,7 +48,7 @@ struct DebugTexture
 		, PixelSize(0)
 		, Format(DebugTextureFormat_RGBA8)
 		, bDimensionsUpdated(false)
-		, RWMutex()
+		, RWMutex("DebugTexture")
 		, CurrentTexture(DebugTexture_None)
 	{}
 
@@ -46,7 +59,7 @@ struct DebugTexture
 	EDebugTextureFormat Format;
 	ESelectedDebugTexture CurrentTexture;
 	bool bDimensionsUpdated;
-	std::mutex RWMutex;
+	ProfiledMutex RWMutex;
 };
 
 enum EStereoPreset
@@ -65,6 +78,7 @@ struct Config_Main
 	EProjectionMode ProjectionMode = Projection_Custom2D;
 
 	bool ProjectToRenderModels = false;
+	int RenderModelMaxTriangles = 2000;
 
 	float PassthroughOpacity = 1.0f;
 	float ProjectionDistanceFar = 10.0f;
@@ -90,6 +104,8 @@ struct Config_Main
 	bool DebugDepth = false;
 	bool DebugStereoValid = false;
 	ESelectedDebugTexture DebugTexture = DebugTexture_None;
+
+	bool operator==(const Config_Main&) const = default;
 };
 
 // Configuration for core-spec passthrough
@@ -107,12 +123,16 @@ struct Config_Core
 	float CoreForceMaskedKeyColor[3] = { 0 ,0 ,0 };
 	bool CoreForceMaskedUseCameraImage = false;
 	bool CoreForceMaskedInvertMask = false;
+
+	bool operator==(const Config_Core&) const = default;
 };
 
 struct Config_Extensions
 {
 	bool ExtVarjoDepthEstimation = true;
 	bool ExtVarjoDepthComposition = true;
+
+	bool operator==(const Config_Extensions&) const = default;
 };
 
 enum EStereoSGBM_Mode
@@ -135,13 +155,20 @@ enum EStereoFiltering
 struct Config_Stereo
 {
 	bool StereoUseMulticore = true;
+	int StereoThreadCount = 0;
+	uint64_t StereoThreadAffinityMask = 0;
+	int StereoThreadPriority = -1;
 	bool StereoReconstructionFreeze = false;
 	bool StereoRectificationFiltering = false;
 	bool StereoUseColor = false;
 	bool StereoUseBWInputAlpha= false;
 	bool StereoUseHexagonGridMesh = true;
 	bool StereoFillHoles = true;
+	bool StereoRoomCache = false;
+	float StereoRoomCacheVoxelSize = 0.05f;
 	int StereoFrameSkip = 0;
+	bool StereoSkipUnchanged = false;
+	float StereoChangeThreshold = 4.0f;
 	int StereoDownscaleFactor = 2;
 	bool StereoUseDisparityTemporalFiltering = false;
 	float StereoDisparityTemporalFilteringStrength = 0.9f;
@@ -175,6 +202,8 @@ struct Config_Stereo
 	float StereoFBS_Chroma = 8.0f;
 	float StereoFBS_Lambda = 128.0f;
 	int StereoFBS_Iterations = 11;
+
+	bool operator==(const Config_Stereo&) const = default;
 };
 
 struct Config_Depth
@@ -186,6 +215,32 @@ struct Config_Depth
 	bool DepthForceRangeTest = false;
 	float DepthForceRangeTestMin = 0.0f;
 	float DepthForceRangeTestMax = 1.0f;
+
+	bool operator==(const Config_Depth&) const = default;
+};
+
+
+// Immutable copy of the whole configuration, with the stereo settings resolved from the selected preset.
+struct ConfigSnapshot
+{
+	uint64_t Generation = 0;
+	Config_Main Main;
+	Config_Core Core;
+	Config_Extensions Extensions;
+	Config_Stereo Stereo;
+	Config_Depth Depth;
+
+	bool operator==(const ConfigSnapshot&) const = default;
+};
+
+// The settings written to the config file.
+struct ConfigFileData
+{
+	Config_Main Main;
+	Config_Core Core;
+	Config_Extensions Extensions;
+	Config_Stereo CustomStereo;
+	Config_Depth Depth;
 };
 
 
@@ -197,20 +252,43 @@ public:
 
 	void ReadConfigFile();
 	void ConfigUpdated();
+
+	// Writes any pending changes without waiting out the debounce interval. Does not block, the file
+	// is written by the persistence thread.
 	void DispatchUpdate();
 	void ResetToDefaults();
 
-	Config_Main& GetConfig_Main() { return m_configMain; }
-	Config_Core& GetConfig_Core() { return m_configCore; }
-	Config_Extensions& GetConfig_Extensions() { return m_configExtensions; }
-	Config_Stereo& GetConfig_Stereo() { return m_stereoPresets[m_configMain.StereoPreset]; }
-	Config_Stereo& GetConfig_CustomStereo() { return m_configCustomStereo; }
-	Config_Depth& GetConfig_Depth() { return m_configDepth; }
+	// Publishes the editable settings to readers if they have changed since the last snapshot.
+	void PublishSnapshot();
+
+	// Settings edited by the dashboard. Only the dashboard thread may access these,
+	// other threads read the published snapshots.
+	Config_Main& GetEditableConfig_Main() { return m_configMain; }
+	Config_Core& GetEditableConfig_Core() { return m_configCore; }
+	Config_Extensions& GetEditableConfig_Extensions() { return m_configExtensions; }
+	Config_Stereo& GetEditableConfig_Stereo() { return m_stereoPresets[m_configMain.StereoPreset]; }
+	Config_Stereo& GetEditableConfig_CustomStereo() { return m_configCustomStereo; }
+	Config_Depth& GetEditableConfig_Depth() { return m_configDepth; }
+
+	// The snapshot is replaced as a whole when the settings change, and the generation is incremented after it.
+	std::shared_ptr<const ConfigSnapshot> GetConfigSnapshot() const { return m_snapshots.Get(); }
+	uint64_t GetConfigGeneration() const { return m_snapshots.GetGeneration(); }
+
+	// Blocks until a snapshot newer than the given generation is published, or bKeepWaiting is cleared.
+	// WakeConfigWaiters() must be called after clearing the flag for the waiter to notice it.
+	void WaitForConfigChange(uint64_t generation, const std::atomic_bool& bKeepWaiting) { m_snapshots.WaitForChange(generation, bKeepWaiting); }
+
+	// As above, but gives up after the timeout. Returns true if a newer snapshot was published.
+	bool WaitForConfigChange(uint64_t generation, const std::atomic_bool& bKeepWaiting, std::chrono::milliseconds timeout) { return m_snapshots.WaitForChange(generation, bKeepWaiting, timeout); }
+	void WakeConfigWaiters() { m_snapshots.WakeWaiters(); }
 
 	DebugTexture& GetDebugTexture() { return m_debugTexture; }
 
 private:
-	void UpdateConfigFile();
+	// Queues the current settings to be written by the persistence thread.
+	void RequestPersist(bool bImmediate);
+	void RunPersistThread();
+	void WriteConfigFile(const ConfigFileData& config);
 
 	void SetupStereoPresets();
 
@@ -220,16 +298,19 @@ private:
 	void ParseConfig_Stereo();
 	void ParseConfig_Depth();
 
-	void UpdateConfig_Main();
-	void UpdateConfig_Core();
-	void UpdateConfig_Extensions();
-	void UpdateConfig_Stereo();
-	void UpdateConfig_Depth();
+	void UpdateConfig_Main(const Config_Main& config);
+	void UpdateConfig_Core(const Config_Core& config);
+	void UpdateConfig_Extensions(const Config_Extensions& config);
+	void UpdateConfig_Stereo(const Config_Stereo& config);
+	void UpdateConfig_Depth(const Config_Depth& config);
 
 	std::wstring m_configFile;
-	CSimpleIniA m_iniData;
 	bool m_bConfigUpdated;
 
+	// Shared between the reading thread and the persistence thread.
+	std::mutex m_iniMutex;
+	CSimpleIniA m_iniData;
+
 	Config_Main m_configMain;
 	Config_Core m_configCore;
 	Config_Extensions m_configExtensions;
@@ -238,5 +319,36 @@ private:
 	Config_Depth m_configDepth;
 
 	DebugTexture m_debugTexture;
+
+	SnapshotPublisher<ConfigSnapshot> m_snapshots;
+
+	std::thread m_persistThread;
+	DebouncedWriter<ConfigFileData> m_persistWriter;
+
+	MetricTimer& m_writeTimer;
+	MetricCounter& m_writeCounter;
+};
+
+
+// Holds the latest snapshot for a single reader, and only fetches a new one when the generation changes.
+class ConfigSnapshotReader
+{
+public:
+	ConfigSnapshotReader(std::shared_ptr<ConfigManager> configManager)
+		: m_configManager(configManager)
+	{}
+
+	const ConfigSnapshot& Get()
+	{
+		if (!m_snapshot || m_snapshot->Generation != m_configManager->GetConfigGeneration())
+		{
+			m_snapshot = m_configManager->GetConfigSnapshot();
+		}
+		return *m_snapshot;
+	}
+
+private:
+	std::shared_ptr<ConfigManager> m_configManager;
+	std::shared_ptr<const ConfigSnapshot> m_snapshot;
 };
 
@@ -4,6 +4,7 @@
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "imgui_impl_dx11.h"
+#include "trace.h"
 
 #include "fonts/roboto_medium.cpp"
 #include "fonts/cousine_regular.cpp"
@@ -21,6 +22,24 @@ DashboardMenu::DashboardMenu(HMODULE dllModule, std::shared_ptr<ConfigManager> c
 	, m_bMenuIsVisible(false)
 	, m_displayValues()
 	, m_activeTab(TabMain)
+	, m_frameToRenderWindow(MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_TO_RENDER))
+	, m_frameToPhotonsWindow(MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_TO_PHOTONS))
+	, m_renderTimeWindow(MetricsRegistry::Get().GetTimer(METRIC_TIMER_PASSTHROUGH_RENDER))
+	, m_reconstructionTimeWindow(MetricsRegistry::Get().GetTimer(METRIC_TIMER_RECONSTRUCTION))
+	, m_frameRetrievalTimeWindow(MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_RETRIEVAL))
+	, m_drawnDisplayValues()
+	, m_drawnConfigGeneration(0)
+	, m_lastDrawTime(0)
+	, m_redrawFrames(0)
+	, m_bTimelineOpen(false)
+	, m_bTimelineFrozen(false)
+	, m_timelineSeconds(5)
+	, m_timelineCaptureTime(0)
+	, m_redrawCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_DASHBOARD_REDRAWS))
+	, m_idleWakeupCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_DASHBOARD_IDLE_WAKEUPS))
+	, m_hiddenWakeupCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_DASHBOARD_HIDDEN_WAKEUPS))
+	, m_visibleCPUTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_DASHBOARD_CPU_VISIBLE))
+	, m_hiddenCPUTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_DASHBOARD_CPU_HIDDEN))
 {
 	m_bRunThread = true;
 	m_menuThread = std::thread(&DashboardMenu::RunThread, this);
@@ -30,10 +49,32 @@ DashboardMenu::DashboardMenu(HMODULE dllModule, std::shared_ptr<ConfigManager> c
 DashboardMenu::~DashboardMenu()
 {
 	m_bRunThread = false;
+	m_configManager->WakeConfigWaiters();
 	if (m_menuThread.joinable())
 	{
 		m_menuThread.join();
 	}
+
+	Tracer::Get().Stop();
+}
+
+
+// CPU time used by the calling thread, in both user and kernel mode.
+// Windows only updates it at the scheduler tick, so single samples are coarse but the averages are meaningful.
+static uint64_t GetThreadCPUTimeNs()
+{
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+	{
+		return 0;
+	}
+
+	uint64_t kernel = ((uint64_t)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+	uint64_t user = ((uint64_t)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+
+	// FILETIME is in 100ns units.
+	return (kernel + user) * 100;
 }
 
 
@@ -70,7 +111,40 @@ void DashboardMenu::RunThread()
 
 	while (m_bRunThread)
 	{
-		TickMenu();
+		uint64_t startCPUTime = GetThreadCPUTimeNs();
+
+		if (HandleEvents())
+		{
+			m_redrawFrames = DASHBOARD_SETTLE_FRAMES;
+		}
+
+		if (!m_bMenuIsVisible)
+		{
+			m_hiddenWakeupCounter.Add();
+			m_hiddenCPUTimer.Record(GetThreadCPUTimeNs() - startCPUTime);
+
+			// Nothing is drawn while hidden, so only poll for the overlay being shown, or wake early on config changes.
+			m_configManager->WaitForConfigChange(m_configManager->GetConfigGeneration(), m_bRunThread, DASHBOARD_HIDDEN_POLL_INTERVAL);
+			continue;
+		}
+
+		uint64_t currentTime = GetMonotonicTimeNs();
+
+		if (NeedsRedraw(currentTime))
+		{
+			TickMenu();
+
+			m_drawnDisplayValues = m_displayValues;
+			m_drawnConfigGeneration = m_configManager->GetConfigGeneration();
+			m_lastDrawTime = currentTime;
+			m_redrawCounter.Add();
+		}
+		else
+		{
+			m_idleWakeupCounter.Add();
+		}
+
+		m_visibleCPUTimer.Record(GetThreadCPUTimeNs() - startCPUTime);
 
 		vrOverlay->WaitFrameSync(100);
 	}
@@ -202,7 +276,7 @@ inline void ScrollableSliderInt(const char* label, int* v, int v_min, int v_max,
 
 inline void DashboardMenu::TextDescription(const char* fmt, ...)
 {
-	if (m_configManager->GetConfig_Main().ShowSettingDescriptions)
+	if (m_configManager->GetEditableConfig_Main().ShowSettingDescriptions)
 	{
 		ImGui::Indent();
 		ImGui::PushFont(m_smallFont);
@@ -219,7 +293,7 @@ inline void DashboardMenu::TextDescription(const char* fmt, ...)
 
 inline void DashboardMenu::TextDescriptionSpaced(const char* fmt, ...)
 {
-	if (m_configManager->GetConfig_Main().ShowSettingDescriptions)
+	if (m_configManager->GetEditableConfig_Main().ShowSettingDescriptions)
 	{
 		ImGui::Indent();
 		ImGui::PushFont(m_smallFont);
@@ -252,21 +326,358 @@ inline void EndSoftDisabled(bool bIsDisabled)
 }
 
 
-void DashboardMenu::TickMenu() 
+void DashboardMenu::UpdatePerfValues()
 {
-	HandleEvents();
+	uint64_t currentTime = GetMonotonicTimeNs();
 
-	if (!m_bMenuIsVisible)
+	m_displayValues.frameToRenderLatencyMS = m_frameToRenderWindow.GetAverageMS(currentTime);
+	m_displayValues.frameToPhotonsLatencyMS = m_frameToPhotonsWindow.GetAverageMS(currentTime);
+	m_displayValues.renderTimeMS = m_renderTimeWindow.GetAverageMS(currentTime);
+	m_displayValues.stereoReconstructionTimeMS = m_reconstructionTimeWindow.GetAverageMS(currentTime);
+	m_displayValues.frameRetrievalTimeMS = m_frameRetrievalTimeWindow.GetAverageMS(currentTime);
+}
+
+
+static bool HasValueChanged(float value, float drawnValue)
+{
+	return fabsf(value - drawnValue) >= DASHBOARD_REDRAW_THRESHOLD_MS;
+}
+
+
+// Checks if the menu would show different values than in the last drawn frame.
+static bool HaveDisplayValuesChanged(const MenuDisplayValues& values, const MenuDisplayValues& drawn)
+{
+	return values.bSessionActive != drawn.bSessionActive ||
+		values.bDepthBlendingActive != drawn.bDepthBlendingActive ||
+		values.renderAPI != drawn.renderAPI ||
+		values.currentApplication != drawn.currentApplication ||
+		values.frameBufferWidth != drawn.frameBufferWidth ||
+		values.frameBufferHeight != drawn.frameBufferHeight ||
+		values.frameBufferFlags != drawn.frameBufferFlags ||
+		values.frameBufferFormat != drawn.frameBufferFormat ||
+		values.depthBufferFormat != drawn.depthBufferFormat ||
+		HasValueChanged(values.frameToRenderLatencyMS, drawn.frameToRenderLatencyMS) ||
+		HasValueChanged(values.frameToPhotonsLatencyMS, drawn.frameToPhotonsLatencyMS) ||
+		HasValueChanged(values.renderTimeMS, drawn.renderTimeMS) ||
+		HasValueChanged(values.stereoReconstructionTimeMS, drawn.stereoReconstructionTimeMS) ||
+		HasValueChanged(values.frameRetrievalTimeMS, drawn.frameRetrievalTimeMS) ||
+		values.bCorePassthroughActive != drawn.bCorePassthroughActive ||
+		values.CoreCurrentMode != drawn.CoreCurrentMode ||
+		values.bVarjoDepthEstimationExtensionActive != drawn.bVarjoDepthEstimationExtensionActive ||
+		values.bVarjoDepthCompositionExtensionActive != drawn.bVarjoDepthCompositionExtensionActive;
+}
+
+
+bool DashboardMenu::NeedsRedraw(uint64_t currentTime)
+{
+	UpdatePerfValues();
+
+	bool bRedraw = m_redrawFrames > 0;
+
+	if (m_redrawFrames > 0)
 	{
-		return;
+		m_redrawFrames--;
+	}
+
+	// Settings can be changed from outside the menu, such as by reading the config file.
+	if (m_configManager->GetConfigGeneration() != m_drawnConfigGeneration)
+	{
+		bRedraw = true;
+	}
+
+	if (HaveDisplayValuesChanged(m_displayValues, m_drawnDisplayValues))
+	{
+		bRedraw = true;
+	}
+
+	if (m_activeTab == TabDebug && currentTime - m_lastDrawTime >= DASHBOARD_LIVE_REFRESH_INTERVAL_NS)
+	{
+		bRedraw = true;
+	}
+
+	// The timeline scrolls, so it is redrawn every frame while it is shown.
+	if (m_activeTab == TabDebug && m_bTimelineOpen && !m_bTimelineFrozen)
+	{
+		bRedraw = true;
+	}
+
+	return bRedraw;
+}
+
+
+static void TextBucketBound(const char* prefix, uint64_t boundNs)
+{
+	if (boundNs < 1000000)
+	{
+		ImGui::Text("%s %.2fus", prefix, (float)boundNs / 1000.0f);
+	}
+	else
+	{
+		ImGui::Text("%s %.2fms", prefix, NsToMS(boundNs));
 	}
+}
 
-	Config_Main& mainConfig = m_configManager->GetConfig_Main();
-	Config_Core& coreConfig = m_configManager->GetConfig_Core();
-	Config_Extensions& extConfig = m_configManager->GetConfig_Extensions();
-	Config_Stereo& stereoConfig = m_configManager->GetConfig_Stereo();
-	Config_Stereo& stereoCustomConfig = m_configManager->GetConfig_CustomStereo();
-	Config_Depth& depthConfig = m_configManager->GetConfig_Depth();
+static void TextMedianBucket(const MetricTimer& timer, const MetricTimerStats& stats)
+{
+	uint64_t accumulated = 0;
+	for (uint32_t bucket = 0; bucket < METRICS_NUM_TIMER_BUCKETS; bucket++)
+	{
+		accumulated += stats.buckets[bucket];
+		if (stats.count > 0 && accumulated * 2 >= stats.count)
+		{
+			if (bucket < METRICS_NUM_TIMER_BUCKETS - 1)
+			{
+				TextBucketBound("<", timer.GetBucketUpperBoundNs(bucket));
+			}
+			else
+			{
+				TextBucketBound(">=", timer.GetBucketUpperBoundNs(bucket - 1));
+			}
+			break;
+		}
+	}
+}
+
+void DashboardMenu::DrawMetricsTable()
+{
+	ImGui::PushFont(m_fixedFont);
+
+	if (ImGui::BeginTable("MetricsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Metric");
+		ImGui::TableSetupColumn("Count / Value");
+		ImGui::TableSetupColumn("Average");
+		ImGui::TableSetupColumn("Max");
+		ImGui::TableSetupColumn("Median bucket");
+		ImGui::TableHeadersRow();
+
+		MetricsRegistry& registry = MetricsRegistry::Get();
+
+		for (uint32_t i = 0; i < registry.GetNumMetrics(); i++)
+		{
+			const IMetric* metric = registry.GetMetric(i);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", metric->GetName().c_str());
+			ImGui::TableNextColumn();
+
+			switch (metric->GetType())
+			{
+			case MetricType_Counter:
+				ImGui::Text("%llu", static_cast<const MetricCounter*>(metric)->Read());
+				break;
+
+			case MetricType_Gauge:
+				ImGui::Text("%.2f", static_cast<const MetricGauge*>(metric)->Read());
+				break;
+
+			case MetricType_Timer:
+			{
+				MetricTimerStats stats;
+				static_cast<const MetricTimer*>(metric)->Read(stats);
+
+				ImGui::Text("%llu", stats.count);
+				ImGui::TableNextColumn();
+				// Some timers measure the layer overhead, which is only a few microseconds.
+				ImGui::Text("%.3fms", stats.GetAverageMS());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3fms", NsToMS(stats.maxNs));
+				ImGui::TableNextColumn();
+				TextMedianBucket(*static_cast<const MetricTimer*>(metric), stats);
+				break;
+			}
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::PopFont();
+}
+
+
+void DashboardMenu::DrawLockProfileTable()
+{
+	ImGui::PushFont(m_fixedFont);
+
+	if (ImGui::BeginTable("LockProfileTable", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Lock");
+		ImGui::TableSetupColumn("Acquisitions");
+		ImGui::TableSetupColumn("Contended");
+		ImGui::TableSetupColumn("Average wait");
+		ImGui::TableSetupColumn("Max wait");
+		ImGui::TableSetupColumn("Median wait bucket");
+		ImGui::TableSetupColumn("Average hold");
+		ImGui::TableHeadersRow();
+
+		LockProfiler& profiler = LockProfiler::Get();
+
+		for (uint32_t i = 0; i < profiler.GetNumProfiles(); i++)
+		{
+			const LockProfile* profile = profiler.GetProfileAt(i);
+
+			MetricTimerStats waitStats, holdStats;
+			profile->waitTimer.Read(waitStats);
+			profile->holdTimer.Read(holdStats);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", profile->name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", profile->acquisitions.Read());
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", profile->contentions.Read());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3fms", waitStats.GetAverageMS());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3fms", NsToMS(waitStats.maxNs));
+			ImGui::TableNextColumn();
+			TextMedianBucket(profile->waitTimer, waitStats);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3fms", holdStats.GetAverageMS());
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::PopFont();
+}
+
+
+void DashboardMenu::DrawTimelineGraph(const char* label, EPerfTimelineSeries series, uint64_t windowNs)
+{
+	const std::vector<PerfTimelineSample>& samples = m_timelineSamples[series];
+	const std::vector<PerfTimelineSample>& cameraPeriods = m_timelineSamples[PerfTimeline_CameraFramePeriod];
+	const std::vector<PerfTimelineSample>& appPeriods = m_timelineSamples[PerfTimeline_AppFramePeriod];
+
+	const ImU32 colorBackground = IM_COL32(20, 20, 25, 255);
+	const ImU32 colorSeries = IM_COL32(90, 170, 250, 255);
+	const ImU32 colorCameraPeriod = IM_COL32(220, 180, 50, 200);
+	const ImU32 colorAppPeriod = IM_COL32(150, 220, 150, 200);
+	const ImU32 colorMissed = IM_COL32(220, 50, 50, 255);
+	const ImU32 colorText = IM_COL32(200, 200, 200, 255);
+
+	// Scaled to fit the samples and the frame periods they are compared against.
+	float maxMS = 1.0f;
+	for (const std::vector<PerfTimelineSample>* graphSamples : { &samples, &cameraPeriods, &appPeriods })
+	{
+		for (const PerfTimelineSample& sample : *graphSamples)
+		{
+			if (m_timelineCaptureTime - sample.timeNs <= windowNs)
+			{
+				maxMS = std::max(maxMS, sample.durationMS);
+			}
+		}
+	}
+	maxMS = ceilf(maxMS * 1.1f);
+
+	ImGui::Text("%s", label);
+
+	ImVec2 graphMin = ImGui::GetCursorScreenPos();
+	ImVec2 graphSize(ImGui::GetContentRegionAvail().x, TIMELINE_GRAPH_HEIGHT);
+	ImVec2 graphMax(graphMin.x + graphSize.x, graphMin.y + graphSize.y);
+	ImGui::Dummy(graphSize);
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	drawList->AddRectFilled(graphMin, graphMax, colorBackground);
+	drawList->PushClipRect(graphMin, graphMax, true);
+
+	auto toScreen = [&](const PerfTimelineSample& sample)
+	{
+		float age = (float)(m_timelineCaptureTime - sample.timeNs) / (float)windowNs;
+		return ImVec2(graphMax.x - age * graphSize.x, graphMax.y - std::min(sample.durationMS / maxMS, 1.0f) * graphSize.y);
+	};
+
+	auto drawLines = [&](const std::vector<PerfTimelineSample>& lineSamples, ImU32 color, float thickness)
+	{
+		for (size_t i = 1; i < lineSamples.size(); i++)
+		{
+			drawList->AddLine(toScreen(lineSamples[i - 1]), toScreen(lineSamples[i]), color, thickness);
+		}
+	};
+
+	drawLines(cameraPeriods, colorCameraPeriod, 1.0f);
+	drawLines(appPeriods, colorAppPeriod, 1.0f);
+	drawLines(samples, colorSeries, 2.0f);
+
+	for (const PerfTimelineSample& sample : samples)
+	{
+		if (sample.bFlagged)
+		{
+			ImVec2 position = toScreen(sample);
+			drawList->AddLine(ImVec2(position.x, graphMin.y), ImVec2(position.x, graphMax.y), colorMissed, 1.0f);
+			drawList->AddCircleFilled(position, 4.0f, colorMissed);
+		}
+	}
+
+	std::string scaleText = std::format("{:.0f} ms", maxMS);
+	drawList->AddText(ImVec2(graphMin.x + 4.0f, graphMin.y + 2.0f), colorText, scaleText.c_str());
+
+	drawList->PopClipRect();
+}
+
+
+void DashboardMenu::DrawTimeline()
+{
+	uint64_t windowNs = (uint64_t)m_timelineSeconds * 1000000000ULL;
+
+	// Always read the longest window, so it can still be changed while frozen.
+	if (!m_bTimelineFrozen)
+	{
+		m_timelineCaptureTime = GetMonotonicTimeNs();
+
+		for (int i = 0; i < PerfTimeline_NumSeries; i++)
+		{
+			m_timelineSamples[i].clear();
+			PerfTimeline::Get().GetSeries((EPerfTimelineSeries)i).Read(m_timelineSamples[i], m_timelineCaptureTime, TIMELINE_MAX_SECONDS * 1000000000ULL);
+		}
+	}
+
+	if (ImGui::Button(m_bTimelineFrozen ? "Resume" : "Freeze"))
+	{
+		m_bTimelineFrozen = !m_bTimelineFrozen;
+	}
+	ImGui::SameLine();
+	ImGui::SliderInt("Seconds", &m_timelineSeconds, 1, TIMELINE_MAX_SECONDS);
+
+	int numMissed = 0;
+	int numReconstructed = 0;
+	for (const PerfTimelineSample& sample : m_timelineSamples[PerfTimeline_Reconstruction])
+	{
+		if (m_timelineCaptureTime - sample.timeNs <= windowNs)
+		{
+			numReconstructed++;
+			numMissed += sample.bFlagged ? 1 : 0;
+		}
+	}
+
+	ImGui::PushFont(m_smallFont);
+	ImGui::TextColored(ImVec4(0.86f, 0.7f, 0.2f, 1.0f), "Camera frame period");
+	ImGui::SameLine();
+	ImGui::TextColored(ImVec4(0.6f, 0.86f, 0.6f, 1.0f), "Application frame period");
+	ImGui::SameLine();
+	ImGui::TextColored(ImVec4(0.86f, 0.2f, 0.2f, 1.0f), "Missed reconstruction budget: %d of %d frames", numMissed, numReconstructed);
+
+	PerfTimelinePercentiles overhead = PerfTimelineGetPercentiles(m_timelineSamples[PerfTimeline_LayerEndFrameOverhead], m_timelineCaptureTime, windowNs);
+	ImGui::Text("Layer xrEndFrame overhead: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms (%u frames)", overhead.p50MS, overhead.p90MS, overhead.p99MS, overhead.maxMS, overhead.numSamples);
+
+	DrawTimelineGraph("Camera frame retrieval", PerfTimeline_FrameRetrieval, windowNs);
+	DrawTimelineGraph("Stereo reconstruction", PerfTimeline_Reconstruction, windowNs);
+	DrawTimelineGraph("Passthrough render", PerfTimeline_PassthroughRender, windowNs);
+	ImGui::PopFont();
+}
+
+
+void DashboardMenu::TickMenu() 
+{
+	Config_Main& mainConfig = m_configManager->GetEditableConfig_Main();
+	Config_Core& coreConfig = m_configManager->GetEditableConfig_Core();
+	Config_Extensions& extConfig = m_configManager->GetEditableConfig_Extensions();
+	Config_Stereo& stereoConfig = m_configManager->GetEditableConfig_Stereo();
+	Config_Stereo& stereoCustomConfig = m_configManager->GetEditableConfig_CustomStereo();
+	Config_Depth& depthConfig = m_configManager->GetEditableConfig_Depth();
 
 	ImVec4 colorTextGreen(0.2f, 0.8f, 0.2f, 1.0f);
 	ImVec4 colorTextRed(0.8f, 0.2f, 0.2f, 1.0f);
@@ -389,6 +800,12 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 			ImGui::Checkbox("Project onto Render Models (Experimental)", &mainConfig.ProjectToRenderModels);
 			TextDescriptionSpaced("Project the passthough view to the correct distance on render models, such as controllers. Requires good camera calibration.");
 
+			if (mainConfig.ProjectToRenderModels)
+			{
+				ScrollableSliderInt("Render Model Triangle Budget", &mainConfig.RenderModelMaxTriangles, 0, 20000, "%d", 100);
+				TextDescriptionSpaced("Maximum number of triangles per render model. Models with more triangles are simplified when loaded. Set to 0 to use the full models.");
+			}
+
 			ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 			if (ImGui::TreeNode("Image Controls"))
 			{
@@ -699,10 +1116,32 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 				ImGui::Checkbox("Use Multiple Cores", &stereoCustomConfig.StereoUseMulticore);
 				TextDescriptionSpaced("Allows the stereo calculations to use multiple CPU cores. This can be turned off for CPU limited applications.");
 
+				BeginSoftDisabled(!stereoCustomConfig.StereoUseMulticore);
+				ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
+				ScrollableSliderInt("Reconstruction Threads", &stereoCustomConfig.StereoThreadCount, 0, 16, stereoCustomConfig.StereoThreadCount > 0 ? "%d" : "Auto", 1);
+				EndSoftDisabled(!stereoCustomConfig.StereoUseMulticore);
+				TextDescription("Number of threads used for the stereo calculations. Auto uses half of the CPU cores, leaving the rest to the application.");
+
+				ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
+				ImGui::InputScalar("Thread Affinity Mask", ImGuiDataType_U64, &stereoCustomConfig.StereoThreadAffinityMask, nullptr, nullptr, "%llX", ImGuiInputTextFlags_CharsHexadecimal);
+				TextDescription("Hexadecimal mask of the CPU cores the stereo threads may run on. 0 allows all cores.");
+
+				ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
+				ScrollableSliderInt("Thread Priority", &stereoCustomConfig.StereoThreadPriority, -2, 2, "%d", 1);
+				TextDescriptionSpaced("Windows priority of the stereo threads. Below normal keeps them from delaying the application render thread.");
+
 				ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
 				ScrollableSliderInt("Frame Skip Ratio", &stereoCustomConfig.StereoFrameSkip, 0, 14, "%d", 1);
 				TextDescription("Skip stereo processing of this many frames for each frame processed. This does not affect the frame rate of viewed camera frames, every frame will still be reprojected on the latest stereo data.");
 
+				ImGui::Checkbox("Skip Unchanged Frames", &stereoCustomConfig.StereoSkipUnchanged);
+				TextDescription("Skips stereo matching while the headset is still, and only matches the rows of the image that have changed.");
+				ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
+				BeginSoftDisabled(!stereoCustomConfig.StereoSkipUnchanged);
+				ScrollableSlider("Change Threshold", &stereoCustomConfig.StereoChangeThreshold, 1.0f, 32.0f, "%.1f", 0.5f);
+				EndSoftDisabled(!stereoCustomConfig.StereoSkipUnchanged);
+				TextDescription("Average brightness difference in an image tile that counts as a change. Raise this if camera noise keeps triggering matching.");
+
 			IMGUI_BIG_SPACING;
 		}
 
@@ -719,6 +1158,15 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 				ImGui::Checkbox("Fill Holes", &stereoCustomConfig.StereoFillHoles);
 				TextDescription("Extra pass to render a cylinder mesh behind the stereo mesh.");
 
+				ImGui::Checkbox("Cache Room Geometry (Experimental)", &stereoCustomConfig.StereoRoomCache);
+				TextDescription("Accumulates the reconstructed depth into a voxel model of the room, and skips stereo matching for rows where the model still matches the camera images.");
+				ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
+				BeginSoftDisabled(!stereoCustomConfig.StereoRoomCache);
+				ScrollableSlider("Room Cache Voxel Size", &stereoCustomConfig.StereoRoomCacheVoxelSize, 0.02f, 0.2f, "%.2f", 0.01f);
+				EndSoftDisabled(!stereoCustomConfig.StereoRoomCache);
+				ImGui::PopItemWidth();
+				TextDescription("Size of the cached voxels in meters. Changing it clears the cache.");
+
 				IMGUI_BIG_SPACING;
 				ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.45f);
 				BeginSoftDisabled(!stereoCustomConfig.StereoCutoutEnabled);
@@ -973,6 +1421,24 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 			ImGui::Checkbox("Debug Depth", &mainConfig.DebugDepth);
 			ImGui::Checkbox("Debug Valid Stereo", &mainConfig.DebugStereoValid);
 
+			bool bTracing = Tracer::IsEnabled();
+			if (ImGui::Checkbox("Write Trace File", &bTracing))
+			{
+				if (bTracing)
+				{
+					Tracer::Get().Start();
+				}
+				else
+				{
+					Tracer::Get().Stop();
+				}
+			}
+			TextDescription("Writes Chrome trace event JSON to the LocalAppData folder, viewable in Perfetto.");
+			if (Tracer::IsEnabled())
+			{
+				ImGui::Text("Dropped trace events: %llu", Tracer::Get().GetDroppedEvents());
+			}
+
 			ImGui::BeginGroup();
 			ImGui::Text("Debug Texture");
 			if (ImGui::RadioButton("None", mainConfig.DebugTexture == DebugTexture_None))
@@ -1049,29 +1515,58 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 			ImGui::EndGroup();		
 		}
 
+		m_bTimelineOpen = ImGui::CollapsingHeader("Performance Timeline");
+		if (m_bTimelineOpen)
+		{
+			TextDescription("Frame times of the pipeline threads over the last seconds, against the camera and application frame periods. Stereo reconstruction frames that took longer than the camera frames they process are marked.");
+			DrawTimeline();
+		}
+
+		if (ImGui::CollapsingHeader("Metrics"))
+		{
+			DrawMetricsTable();
+		}
+
+		if (ImGui::CollapsingHeader("Lock Contention"))
+		{
+			bool bProfiling = LockProfiler::IsEnabled();
+			if (ImGui::Checkbox("Profile Shared Locks", &bProfiling))
+			{
+				LockProfiler::SetEnabled(bProfiling);
+			}
+			TextDescription("Records how often the locks shared between the render thread and the background threads are contended, and for how long. Adds a small overhead to every lock while enabled.");
+
+			DrawLockProfileTable();
+		}
+
 		ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 		if (ImGui::CollapsingHeader("Device Properties"))
 		{
+			// The properties are queried in the background, so the snapshot may be missing or a bit behind.
+			std::shared_ptr<const DeviceDebugSnapshot> deviceSnapshot = m_openVRManager->GetDeviceDebugSnapshot();
+			static const std::vector<DeviceDebugProperties> noDevices;
+			const std::vector<DeviceDebugProperties>& devices = deviceSnapshot ? deviceSnapshot->Devices : noDevices;
+
 			if (ImGui::Button("Refresh"))
 			{
-				m_openVRManager->GetCameraDebugProperties(m_deviceDebugProps);
+				m_openVRManager->RequestDeviceDebugRefresh();
 			}
 
 			ImGui::SameLine();
 
-			std::string comboPreview = "No device";
+			std::string comboPreview = deviceSnapshot ? "No device" : "Querying devices...";
 
-			if (m_deviceDebugProps.size() > m_currentDebugDevice)
+			if (devices.size() > m_currentDebugDevice)
 			{
-				comboPreview.assign(std::format("[{}] {}", m_currentDebugDevice, m_deviceDebugProps[m_currentDebugDevice].DeviceName));
+				comboPreview.assign(std::format("[{}] {}", m_currentDebugDevice, devices[m_currentDebugDevice].DeviceName));
 			}
 			 
 
 			if (ImGui::BeginCombo("Devices", comboPreview.c_str()))
 			{
-				for (int i = 0; i < m_deviceDebugProps.size(); i++)
+				for (int i = 0; i < devices.size(); i++)
 				{
-					std::string comboValue = std::format("[{}] {}", i, m_deviceDebugProps[i].DeviceName);
+					std::string comboValue = std::format("[{}] {}", i, devices[i].DeviceName);
 
 					const bool bIsSelected = (m_currentDebugDevice == i);
 					if (ImGui::Selectable(comboValue.c_str(), bIsSelected))
@@ -1088,9 +1583,9 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 			}
 
 			ImGui::Spacing();
-			if (m_deviceDebugProps.size() > m_currentDebugDevice)
+			if (devices.size() > m_currentDebugDevice)
 			{
-				DeviceDebugProperties& props = m_deviceDebugProps[m_currentDebugDevice];
+				const DeviceDebugProperties& props = devices[m_currentDebugDevice];
 
 				ImGui::PushFont(m_fixedFont);
 
@@ -1323,6 +1818,11 @@ if (bIsActiveTab) { ImGui::PopStyleColor(1); bIsActiveTab = false; }
 	{
 		m_configManager->ConfigUpdated();
 	}
+	else
+	{
+		// Catches settings adjusted after a control was released.
+		m_configManager->PublishSnapshot();
+	}
 
 	ImGui::End();
 
@@ -1435,20 +1935,23 @@ void DashboardMenu::CreateThumbnail()
 }
 
 
-void DashboardMenu::HandleEvents()
+bool DashboardMenu::HandleEvents()
 {
 	vr::IVROverlay* vrOverlay = m_openVRManager->GetVROverlay();
 
 	if (!vrOverlay || m_overlayHandle == vr::k_ulOverlayHandleInvalid)
 	{
-		return;
+		return false;
 	}
 
 	ImGuiIO& io = ImGui::GetIO();
+	bool bHadEvents = false;
 
 	vr::VREvent_t event;
 	while (vrOverlay->PollNextOverlayEvent(m_overlayHandle, &event, sizeof(event)))
 	{
+		bHadEvents = true;
+
 		vr::VREvent_Overlay_t& overlayData = (vr::VREvent_Overlay_t&)event.data;
 		vr::VREvent_Mouse_t& mouseData = (vr::VREvent_Mouse_t&)event.data;
 		vr::VREvent_Scroll_t& scrollData = (vr::VREvent_Scroll_t&)event.data;
@@ -1532,6 +2035,8 @@ void DashboardMenu::HandleEvents()
 
 		}
 	}
+
+	return bHadEvents;
 }
 
 
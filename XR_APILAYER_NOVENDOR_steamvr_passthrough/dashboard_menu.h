@@ -6,6 +6,7 @@
 #include "layer.h"
 #include "config_manager.h"
 #include "openvr_manager.h"
+#include "perf_timeline.h"
 #include "imgui.h"
 
 using Microsoft::WRL::ComPtr;
@@ -16,6 +17,22 @@ using Microsoft::WRL::ComPtr;
 #define OVERLAY_RES_WIDTH 1200
 #define OVERLAY_RES_HEIGHT 700
 
+// Overlay events are polled at this interval while the dashboard is hidden, instead of every compositor frame.
+#define DASHBOARD_HIDDEN_POLL_INTERVAL std::chrono::milliseconds(100)
+
+// ImGui needs a few frames to process queued input and settle hover and active states.
+#define DASHBOARD_SETTLE_FRAMES 3
+
+// Changes in the displayed timings below this are not visible at the printed precision.
+#define DASHBOARD_REDRAW_THRESHOLD_MS 0.005f
+
+// The Debug tab shows live tables that are not tracked for changes, so it is refreshed at this interval.
+#define DASHBOARD_LIVE_REFRESH_INTERVAL_NS 500000000ULL
+
+// Longest history the timeline can show, limited by the sample ring capacity at high frame rates.
+#define TIMELINE_MAX_SECONDS 15
+#define TIMELINE_GRAPH_HEIGHT 110.0f
+
 enum EMenuTab
 {
 	TabMain,
@@ -67,8 +84,14 @@ private:
 	void CreateThumbnail();
 
 	void RunThread();
-	void HandleEvents();
+	bool HandleEvents();
+	bool NeedsRedraw(uint64_t currentTime);
 	void TickMenu();
+	void UpdatePerfValues();
+	void DrawMetricsTable();
+	void DrawLockProfileTable();
+	void DrawTimeline();
+	void DrawTimelineGraph(const char* label, EPerfTimelineSeries series, uint64_t windowNs);
 
 	void SetupDX11();
 
@@ -83,7 +106,7 @@ private:
 	vr::VROverlayHandle_t m_thumbnailHandle;
 
 	std::thread m_menuThread;
-	bool m_bRunThread;
+	std::atomic_bool m_bRunThread;
 
 	ComPtr<ID3D11Device> m_d3d11Device;
 	ComPtr<ID3D11DeviceContext> m_d3d11DeviceContext;
@@ -94,11 +117,34 @@ private:
 	MenuDisplayValues m_displayValues;
 	EMenuTab m_activeTab;
 
+	// State of the last drawn frame, the overlay is only redrawn when something visible has changed.
+	MenuDisplayValues m_drawnDisplayValues;
+	uint64_t m_drawnConfigGeneration;
+	uint64_t m_lastDrawTime;
+	int m_redrawFrames;
+
+	bool m_bTimelineOpen;
+	bool m_bTimelineFrozen;
+	int m_timelineSeconds;
+	uint64_t m_timelineCaptureTime;
+	std::array<std::vector<PerfTimelineSample>, PerfTimeline_NumSeries> m_timelineSamples;
+
 	ImFont* m_mainFont;
 	ImFont* m_smallFont;
 	ImFont* m_fixedFont;
 
-	std::vector<DeviceDebugProperties> m_deviceDebugProps;
 	int m_currentDebugDevice;
+
+	MetricTimerWindow m_frameToRenderWindow;
+	MetricTimerWindow m_frameToPhotonsWindow;
+	MetricTimerWindow m_renderTimeWindow;
+	MetricTimerWindow m_reconstructionTimeWindow;
+	MetricTimerWindow m_frameRetrievalTimeWindow;
+
+	MetricCounter& m_redrawCounter;
+	MetricCounter& m_idleWakeupCounter;
+	MetricCounter& m_hiddenWakeupCounter;
+	MetricTimer& m_visibleCPUTimer;
+	MetricTimer& m_hiddenCPUTimer;
 };
 
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+
+// Coalesces requests to write data, and writes the latest data once the requests have stopped
+// coming in for the debounce interval. The writes are done by Run(), on a thread owned by the caller.
+template<typename T>
+class DebouncedWriter
+{
+public:
+	DebouncedWriter(std::chrono::milliseconds debounce, std::function<void(const T&)> write)
+		: m_write(write)
+		, m_debounce(debounce)
+		, m_bRunning(true)
+		, m_bPending(false)
+	{}
+
+	// Replaces any pending data. Further requests push the write back, but never delay an
+	// already requested immediate write.
+	void Request(const T& data, bool bImmediate)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+			if (bImmediate)
+			{
+				m_deadline = now;
+			}
+			else if (!m_bPending || m_deadline > now)
+			{
+				m_deadline = now + m_debounce;
+			}
+
+			m_data = data;
+			m_bPending = true;
+		}
+		m_condition.notify_all();
+	}
+
+	// Writes the requested data until Stop() is called. Pending data is written right away when stopping.
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		while (true)
+		{
+			if (!m_bPending)
+			{
+				if (!m_bRunning)
+				{
+					break;
+				}
+				m_condition.wait(lock);
+				continue;
+			}
+
+			if (m_bRunning && std::chrono::steady_clock::now() < m_deadline)
+			{
+				m_condition.wait_until(lock, m_deadline);
+				continue;
+			}
+
+			T data = m_data;
+			m_bPending = false;
+
+			lock.unlock();
+			m_write(data);
+			lock.lock();
+		}
+	}
+
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bRunning = false;
+		}
+		m_condition.notify_all();
+	}
+
+private:
+	std::function<void(const T&)> m_write;
+	std::chrono::milliseconds m_debounce;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_bRunning;
+	bool m_bPending;
+	std::chrono::steady_clock::time_point m_deadline;
+	T m_data;
+};
@@ -2,6 +2,8 @@
 #include "depth_reconstruction.h"
 
 #include <log.h>
+#include "trace.h"
+#include "perf_timeline.h"
 
 
 using namespace steamvr_passthrough;
@@ -38,14 +40,27 @@ XrMatrix4x4f CVMatToXrMatrix(cv::Mat& inMatrix)
 
 DepthReconstruction::DepthReconstruction(std::shared_ptr<ConfigManager> configManager, std::shared_ptr<OpenVRManager> openVRManager, std::shared_ptr<CameraManager> cameraManager)
     : m_bRunThread(true)
+    , m_serveMutex("DepthServe")
     , m_configManager(configManager)
     , m_openVRManager(openVRManager)
     , m_cameraManager(cameraManager)
+    , m_depthFrameGeneration(0)
     , m_distortionParams()
-    , m_reconstructionTimes({0.0f})
-    , m_averageReconstructionTime(0.0f)
+    , m_reconstructionTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_RECONSTRUCTION))
+    , m_reconstructedFramesCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_RECONSTRUCTED_FRAMES))
+    , m_roomCacheTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_ROOM_CACHE_UPDATE))
+    , m_roomCacheMemoryGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_ROOM_CACHE_MEMORY))
+    , m_roomCacheSkippedGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_ROOM_CACHE_SKIPPED))
+    , m_skippedFramesCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_RECONSTRUCTION_SKIPPED))
+    , m_reusedBandsGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_RECONSTRUCTION_REUSED))
+    , m_depthStalenessGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_DEPTH_STALENESS))
+    , m_threadCountGauge(MetricsRegistry::Get().GetGauge(METRIC_GAUGE_RECONSTRUCTION_THREADS))
+    , m_rectificationTimer(MetricsRegistry::Get().GetTimer(METRIC_TIMER_STEREO_RECTIFICATION))
+    , m_bDistortionReady(false)
+    , m_bStereoBuffersValid(false)
 {
-    Config_Stereo& stereoConfig = m_configManager->GetConfig_Stereo();
+    std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+    const Config_Stereo& stereoConfig = config->Stereo;
 
     m_maxDisparity = stereoConfig.StereoMaxDisparity;
     m_downscaleFactor = stereoConfig.StereoDownscaleFactor;
@@ -53,16 +68,24 @@ DepthReconstruction::DepthReconstruction(std::shared_ptr<ConfigManager> configMa
     m_servedDepthFrame = std::make_shared<DepthFrame>();
     m_underConstructionDepthFrame = std::make_shared<DepthFrame>();
 
-    m_fovScale = m_configManager->GetConfig_Main().FieldOfViewScale;
-    m_depthOffsetCalibration = m_configManager->GetConfig_Main().DepthOffsetCalibration;
+    m_fovScale = config->Main.FieldOfViewScale;
+    m_depthOffsetCalibration = config->Main.DepthOffsetCalibration;
     m_bUseColor = stereoConfig.StereoUseColor;
     m_bDisparityBothEyes = stereoConfig.StereoDisparityBothEyes;
 
+    // The thread settings are applied from the reconstruction thread, since they also change its own priority.
     m_bUseMulticore = stereoConfig.StereoUseMulticore;
-    cv::setNumThreads(m_bUseMulticore ? -1 : 0);
+    m_threadCount = -1;
+    m_threadAffinityMask = 0;
+    m_threadPriority = THREAD_PRIORITY_NORMAL;
+    m_threadPool = std::make_shared<ReconstructionThreadPool>();
 
-    InitReconstruction();
+    // The backend is process wide, so the previous one is restored when reconstruction is destroyed.
+    const char* previousBackend = cv::currentParallelFramework();
+    m_previousParallelBackend = previousBackend ? previousBackend : "";
+    cv::parallel::setParallelForBackend(m_threadPool, false);
 
+    // The rectification is built on the reconstruction thread, so it doesn't delay the session start.
     m_thread = std::thread(&DepthReconstruction::RunThread, this);
 }
 
@@ -71,13 +94,23 @@ DepthReconstruction::~DepthReconstruction()
     if (m_thread.joinable())
     {
         m_bRunThread = false;
+        m_configManager->WakeConfigWaiters();
         m_thread.join();
     }
+
+    m_threadPool->Stop();
+
+    // OpenCV only exposes the name of the current backend. Plugin backends are reloaded by name,
+    // otherwise clearing the custom backend returns to the built-in one.
+    if (m_previousParallelBackend.empty() || !cv::parallel::setParallelForBackend(m_previousParallelBackend, false))
+    {
+        cv::parallel::setParallelForBackend(std::shared_ptr<cv::parallel::ParallelForAPI>(), false);
+    }
 }
 
 std::shared_ptr<DepthFrame> DepthReconstruction::GetDepthFrame()
 {
-    std::unique_lock<std::mutex> lock(m_serveMutex, std::try_to_lock);
+    std::unique_lock<ProfiledMutex> lock(m_serveMutex, std::try_to_lock);
     if (lock.owns_lock() && m_servedDepthFrame->bIsValid)
     {
         m_depthFrame->bIsValid = false;
@@ -189,6 +222,12 @@ void DepthReconstruction::InitReconstruction()
     
     CreateDistortionMap();
 
+    m_bDistortionReady = true;
+    m_bStereoBuffersValid = false;
+}
+
+void DepthReconstruction::InitStereoBuffers()
+{
     int frameFormat = m_bUseColor ? CV_8UC3 : CV_8U;
 
     int disparityWidth = m_bDisparityBothEyes ? m_cvImageWidth + m_maxDisparity * 2 : m_cvImageWidth + m_maxDisparity;
@@ -219,6 +258,12 @@ void DepthReconstruction::InitReconstruction()
         m_servedDepthFrame->disparityMap->resize(m_cvImageWidth * m_cvImageHeight * 2 * 2);
         m_underConstructionDepthFrame->disparityMap->resize(m_cvImageWidth * m_cvImageHeight * 2 * 2);
     }
+
+    // The cached geometry and previous disparity depend on the rectification.
+    m_roomCache.Reset(m_roomCache.GetVoxelSize());
+    m_changeDetector.Reset();
+
+    m_bStereoBuffersValid = true;
 }
 
 
@@ -300,17 +345,115 @@ void DepthReconstruction::CreateDistortionMap()
 }
 
 
-void DepthReconstruction::RunThread()
+// Runs the matcher only on the bands that have changed and can not be predicted by the room cache.
+// Predicted bands are filled from the room cache, and unchanged bands keep the previous disparity.
+void DepthReconstruction::ComputeDisparity(cv::Ptr<cv::StereoMatcher>& matcher, const cv::Mat& frame, const cv::Mat& otherFrame, cv::Mat& disparity, const std::vector<uint8_t>* changedBands, const RoomCachePrediction* prediction, int minDisparity, std::vector<uint8_t>& matchedBands)
 {
-    while (m_bRunThread)
+    enum EBandSource
     {
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        BandSource_Match,
+        BandSource_Cache,
+        BandSource_Previous
+    };
 
-        LARGE_INTEGER startReconstructionTime = StartPerfTimer();
+    int numBands = (frame.rows + ROOM_CACHE_TILE_SIZE - 1) / ROOM_CACHE_TILE_SIZE;
+    bool bHasPrevious = disparity.size() == frame.size();
 
-        // Make local copies for consistency
-        Config_Main mainConfig = m_configManager->GetConfig_Main();
-        Config_Stereo stereoConfig = m_configManager->GetConfig_Stereo();
+    auto getBandSource = [&](int band)
+    {
+        if (prediction && prediction->bandCached[band])
+        {
+            return BandSource_Cache;
+        }
+        if (changedBands && !(*changedBands)[band] && bHasPrevious)
+        {
+            return BandSource_Previous;
+        }
+        return BandSource_Match;
+    };
+
+    matchedBands.resize(numBands);
+    bool bMatchAll = true;
+
+    for (int band = 0; band < numBands; band++)
+    {
+        matchedBands[band] = getBandSource(band) == BandSource_Match ? 1 : 0;
+        bMatchAll = bMatchAll && matchedBands[band];
+    }
+
+    if (bMatchAll)
+    {
+        matcher->compute(frame, otherFrame, disparity);
+        return;
+    }
+
+    disparity.create(frame.rows, frame.cols, CV_16S);
+
+    int16_t invalidDisparity = (int16_t)((minDisparity - 1) * cv::StereoMatcher::DISP_SCALE);
+    int padding = matcher->getBlockSize() + ROOM_CACHE_MATCH_PADDING;
+    int band = 0;
+
+    while (band < numBands)
+    {
+        int runStart = band;
+        EBandSource source = getBandSource(band);
+
+        while (band < numBands && getBandSource(band) == source)
+        {
+            band++;
+        }
+
+        int startY = runStart * ROOM_CACHE_TILE_SIZE;
+        int endY = std::min(band * ROOM_CACHE_TILE_SIZE, frame.rows);
+
+        if (source == BandSource_Cache)
+        {
+            for (int y = startY; y < endY; y++)
+            {
+                int16_t* row = disparity.ptr<int16_t>(y);
+                const int16_t* predictedRow = &prediction->disparity[y * prediction->width];
+
+                std::fill(row, row + disparity.cols, invalidDisparity);
+
+                for (int x = 0; x < prediction->width; x++)
+                {
+                    if (predictedRow[x] != 0)
+                    {
+                        row[x + m_maxDisparity] = predictedRow[x];
+                    }
+                }
+            }
+        }
+        else if (source == BandSource_Match)
+        {
+            int matchStartY = std::max(startY - padding, 0);
+            int matchEndY = std::min(endY + padding, frame.rows);
+
+            matcher->compute(frame.rowRange(matchStartY, matchEndY), otherFrame.rowRange(matchStartY, matchEndY), m_roomCacheBandDisparity);
+            m_roomCacheBandDisparity.rowRange(startY - matchStartY, endY - matchStartY).copyTo(disparity.rowRange(startY, endY));
+        }
+    }
+}
+
+
+void DepthReconstruction::RunThread()
+{
+    Tracer::Get().SetThreadName("Stereo reconstruction");
+
+    ConfigSnapshotReader configReader(m_configManager);
+
+    {
+        uint64_t startTime = GetMonotonicTimeNs();
+        InitReconstruction();
+        m_rectificationTimer.RecordSince(startTime);
+    }
+
+    while (m_bRunThread)
+    {
+        // The snapshot stays consistent for the whole iteration, and is only re-fetched when the settings change.
+        const ConfigSnapshot& config = configReader.Get();
+        const Config_Main& mainConfig = config.Main;
+        const Config_Stereo& stereoConfig = config.Stereo;
 
 
         if (m_maxDisparity != stereoConfig.StereoMaxDisparity ||
@@ -327,19 +470,46 @@ void DepthReconstruction::RunThread()
             m_bUseColor = stereoConfig.StereoUseColor;
             m_bDisparityBothEyes = stereoConfig.StereoDisparityBothEyes;
 
+            uint64_t startTime = GetMonotonicTimeNs();
             InitReconstruction();
+            m_rectificationTimer.RecordSince(startTime);
         }
 
-        if (m_bUseMulticore != stereoConfig.StereoUseMulticore)
+        // The rectification is still needed by the other projection modes, but nothing else is until stereo is enabled.
+        if (mainConfig.ProjectionMode != Projection_StereoReconstruction || stereoConfig.StereoReconstructionFreeze)
+        {
+            m_configManager->WaitForConfigChange(config.Generation, m_bRunThread);
+            continue;
+        }
+
+        if (!m_bStereoBuffersValid)
+        {
+            InitStereoBuffers();
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+        uint64_t startReconstructionTime = GetMonotonicTimeNs();
+
+        if (m_bUseMulticore != stereoConfig.StereoUseMulticore || m_threadCount != stereoConfig.StereoThreadCount ||
+            m_threadAffinityMask != stereoConfig.StereoThreadAffinityMask || m_threadPriority != stereoConfig.StereoThreadPriority)
         {
             m_bUseMulticore = stereoConfig.StereoUseMulticore;
-            cv::setNumThreads(m_bUseMulticore ? -1 : 0);
+            m_threadCount = stereoConfig.StereoThreadCount;
+            m_threadAffinityMask = stereoConfig.StereoThreadAffinityMask;
+            m_threadPriority = stereoConfig.StereoThreadPriority;
+
+            m_threadPool->SetThreadAttributes(m_threadAffinityMask, m_threadPriority);
+
+            int numThreads = !m_bUseMulticore ? 0 : (m_threadCount > 0 ? m_threadCount : ReconstructionThreadPool::GetDefaultNumThreads());
+            cv::setNumThreads(numThreads);
+            m_threadCountGauge.Set(std::max(numThreads, 1));
         }
 
         std::shared_ptr<CameraFrame> frame;
         XrMatrix4x4f viewToWorldLeft, viewToWorldRight;
 
-        if (mainConfig.ProjectionMode != Projection_StereoReconstruction || stereoConfig.StereoReconstructionFreeze || !m_cameraManager->GetCameraFrame(frame))
+        if (!m_cameraManager->GetCameraFrame(frame))
         {
             continue;
         }
@@ -358,6 +528,8 @@ void DepthReconstruction::RunThread()
 
             m_lastFrameSequence = frame->header.nFrameSequence;
 
+            TraceSpan inputSpan("Reconstruction input", m_lastFrameSequence);
+
             viewToWorldLeft = frame->cameraViewToWorldLeft;
             viewToWorldRight = frame->cameraViewToWorldRight;
 
@@ -397,6 +569,8 @@ void DepthReconstruction::RunThread()
             }
         }
 
+        TraceSpan rectifySpan("Reconstruction rectify", m_lastFrameSequence);
+
         int filter = stereoConfig.StereoRectificationFiltering ? CV_INTER_LINEAR : CV_INTER_NN;
 
         cv::remap(m_inputFrameLeft, m_rectifiedFrameLeft, m_leftMap1, m_leftMap2, filter, cv::BORDER_CONSTANT);
@@ -408,6 +582,86 @@ void DepthReconstruction::RunThread()
         m_scaledFrameLeft.copyTo(m_scaledExtFrameLeft(cv::Rect(m_maxDisparity, 0, m_cvImageWidth, m_cvImageHeight)));
         m_scaledFrameRight.copyTo(m_scaledExtFrameRight(cv::Rect(m_maxDisparity, 0, m_cvImageWidth, m_cvImageHeight)));
 
+        rectifySpan.End();
+
+        XrMatrix4x4f disparityViewToWorldLeft, disparityViewToWorldRight;
+        XrMatrix4x4f_Multiply(&disparityViewToWorldLeft, &viewToWorldLeft, &m_rectifiedRotationLeft);
+        if (m_bDisparityBothEyes)
+        {
+            XrMatrix4x4f_Multiply(&disparityViewToWorldRight, &viewToWorldRight, &m_rectifiedRotationRight);
+        }
+        else
+        {
+            disparityViewToWorldRight = disparityViewToWorldLeft;
+        }
+
+        const std::vector<uint8_t>* changedBands = nullptr;
+
+        if (stereoConfig.StereoSkipUnchanged)
+        {
+            TraceSpan changeSpan("Reconstruction change detection", m_lastFrameSequence);
+
+            EFrameChange change = m_changeDetector.Update(m_scaledFrameLeft, m_scaledFrameRight, viewToWorldLeft, stereoConfig.StereoChangeThreshold, ROOM_CACHE_TILE_SIZE, m_changedBands);
+            m_depthStalenessGauge.Set(m_changeDetector.GetMaxBandAge());
+
+            if (change == FrameChange_None)
+            {
+                m_reusedBandsGauge.Set(1.0);
+                m_skippedFramesCounter.Add();
+                continue;
+            }
+            else if (change == FrameChange_Partial)
+            {
+                size_t numChanged = std::count(m_changedBands.begin(), m_changedBands.end(), 1);
+                m_reusedBandsGauge.Set(1.0 - (double)numChanged / m_changedBands.size());
+                changedBands = &m_changedBands;
+            }
+            else
+            {
+                m_reusedBandsGauge.Set(0.0);
+            }
+        }
+        else
+        {
+            m_changeDetector.Reset();
+        }
+
+        bool bUseRoomCache = stereoConfig.StereoRoomCache;
+        uint64_t roomCacheUpdateTime = 0;
+
+        if (!bUseRoomCache && m_roomCache.GetNumVoxels() > 0)
+        {
+            m_roomCache.Reset(stereoConfig.StereoRoomCacheVoxelSize);
+            m_roomCacheMemoryGauge.Set(0.0);
+            m_roomCacheSkippedGauge.Set(0.0);
+        }
+
+        if (bUseRoomCache)
+        {
+            TraceSpan predictSpan("Reconstruction room cache predict", m_lastFrameSequence);
+            uint64_t predictStartTime = GetMonotonicTimeNs();
+
+            if (m_roomCache.GetVoxelSize() != stereoConfig.StereoRoomCacheVoxelSize)
+            {
+                m_roomCache.Reset(stereoConfig.StereoRoomCacheVoxelSize);
+            }
+
+            m_roomCache.Predict(m_roomCachePredictionLeft, disparityViewToWorldLeft, m_disparityToDepth, (float)m_downscaleFactor, m_cvImageWidth, m_cvImageHeight, false);
+            int numCachedBands = m_roomCache.ClassifyBands(m_roomCachePredictionLeft, m_scaledExtFrameLeft, m_scaledExtFrameRight, m_maxDisparity);
+            int numBands = m_roomCachePredictionLeft.NumBands();
+
+            if (m_bDisparityBothEyes)
+            {
+                m_roomCache.Predict(m_roomCachePredictionRight, disparityViewToWorldRight, m_disparityToDepth, (float)m_downscaleFactor, m_cvImageWidth, m_cvImageHeight, true);
+                numCachedBands += m_roomCache.ClassifyBands(m_roomCachePredictionRight, m_scaledExtFrameRight, m_scaledExtFrameLeft, m_maxDisparity);
+                numBands += m_roomCachePredictionRight.NumBands();
+            }
+
+            m_roomCacheSkippedGauge.Set(numBands > 0 ? (double)numCachedBands / numBands : 0.0);
+            roomCacheUpdateTime += GetMonotonicTimeNs() - predictStartTime;
+        }
+
+        TraceSpan matchingSpan("Reconstruction matching", m_lastFrameSequence);
 
         int minDisparity = m_bDisparityBothEyes ? stereoConfig.StereoMinDisparity - m_maxDisparity + 1 : 0;
         int numDisparities = m_bDisparityBothEyes ? m_maxDisparity * 2 - stereoConfig.StereoMinDisparity : m_maxDisparity - stereoConfig.StereoMinDisparity;
@@ -421,7 +675,7 @@ void DepthReconstruction::RunThread()
             stereoConfig.StereoSGBM_SpeckleWindowSize, speckleRange,
             (int)stereoConfig.StereoSGBM_Mode);
 
-        m_stereoLeftMatcher->compute(m_scaledExtFrameLeft, m_scaledExtFrameRight, m_rawDisparityLeft);
+        ComputeDisparity(m_stereoLeftMatcher, m_scaledExtFrameLeft, m_scaledExtFrameRight, m_rawDisparityLeft, changedBands, bUseRoomCache ? &m_roomCachePredictionLeft : nullptr, minDisparity, m_matchedBandsLeft);
 
         cv::Mat* outputMatrixLeft = &m_rawDisparityLeft;
         cv::Mat* outputMatrixRight = &m_rawDisparityLeft;
@@ -435,7 +689,7 @@ void DepthReconstruction::RunThread()
                 stereoConfig.StereoSGBM_SpeckleWindowSize, speckleRange,
                 (int)stereoConfig.StereoSGBM_Mode);
 
-            m_stereoRightMatcher->compute(m_scaledExtFrameRight, m_scaledExtFrameLeft, m_rawDisparityRight);
+            ComputeDisparity(m_stereoRightMatcher, m_scaledExtFrameRight, m_scaledExtFrameLeft, m_rawDisparityRight, changedBands, bUseRoomCache ? &m_roomCachePredictionRight : nullptr, minDisparity, m_matchedBandsRight);
 
             outputMatrixLeft = &m_rawDisparityLeft;
             outputMatrixRight = &m_rawDisparityRight;
@@ -446,6 +700,8 @@ void DepthReconstruction::RunThread()
             outputMatrixRight = &m_rawDisparityLeft;
         }
 
+        matchingSpan.End();
+        TraceSpan filteringSpan("Reconstruction filtering", m_lastFrameSequence);
 
         if (stereoConfig.StereoFiltering == StereoFiltering_FBS)
         {
@@ -550,7 +806,11 @@ void DepthReconstruction::RunThread()
             }
         }
 
+        filteringSpan.End();
+
         {
+            TraceSpan outputSpan("Reconstruction output", m_lastFrameSequence);
+
             std::unique_lock writeLock(m_underConstructionDepthFrame->readWriteMutex);
 
             // Write disparity and confidence to texture
@@ -626,31 +886,50 @@ void DepthReconstruction::RunThread()
             }
             
 
-            XrMatrix4x4f_Multiply(&m_underConstructionDepthFrame->disparityViewToWorldLeft, &viewToWorldLeft, &m_rectifiedRotationLeft);
-            if (m_bDisparityBothEyes)
-            {
-                XrMatrix4x4f_Multiply(&m_underConstructionDepthFrame->disparityViewToWorldRight, &viewToWorldRight, &m_rectifiedRotationRight);
-            }
-            else
-            {
-                m_underConstructionDepthFrame->disparityViewToWorldRight = m_underConstructionDepthFrame->disparityViewToWorldLeft;
-            }
+            m_underConstructionDepthFrame->disparityViewToWorldLeft = disparityViewToWorldLeft;
+            m_underConstructionDepthFrame->disparityViewToWorldRight = disparityViewToWorldRight;
             m_underConstructionDepthFrame->disparityToDepth = m_disparityToDepth;
             m_underConstructionDepthFrame->disparityTextureSize[0] = m_cvImageWidth * 2;
             m_underConstructionDepthFrame->disparityTextureSize[1] = m_cvImageHeight;
             m_underConstructionDepthFrame->disparityDownscaleFactor = (float)m_downscaleFactor;
+            m_underConstructionDepthFrame->generation = ++m_depthFrameGeneration;
             m_underConstructionDepthFrame->bIsValid = true;
 
+            if (bUseRoomCache)
             {
-                std::lock_guard<std::mutex> lock(m_serveMutex);
+                TraceSpan integrateSpan("Reconstruction room cache integrate", m_lastFrameSequence);
+                uint64_t integrateStartTime = GetMonotonicTimeNs();
+
+                const int16_t* disparity = (const int16_t*)m_underConstructionDepthFrame->disparityMap->data();
+                int rowStride = m_cvImageWidth * 2 * 2;
+                bool bUseConfidence = stereoConfig.StereoFiltering == StereoFiltering_WLS || stereoConfig.StereoFiltering == StereoFiltering_WLS_FBS;
+
+                m_roomCache.Integrate(m_roomCachePredictionLeft, m_matchedBandsLeft, disparity, rowStride, m_disparityToDepth, (float)m_downscaleFactor, m_maxDisparity, bUseConfidence);
+
+                if (m_bDisparityBothEyes)
+                {
+                    m_roomCache.Integrate(m_roomCachePredictionRight, m_matchedBandsRight, disparity + m_cvImageWidth * 2, rowStride, m_disparityToDepth, (float)m_downscaleFactor, m_maxDisparity, bUseConfidence);
+                }
+
+                m_roomCache.EndFrame();
+
+                roomCacheUpdateTime += GetMonotonicTimeNs() - integrateStartTime;
+                m_roomCacheTimer.Record(roomCacheUpdateTime);
+                m_roomCacheMemoryGauge.Set((double)m_roomCache.GetMemoryUsage());
+            }
+
+            {
+                std::lock_guard<ProfiledMutex> lock(m_serveMutex);
                 m_underConstructionDepthFrame.swap(m_servedDepthFrame);
             }
         }
 
         if (mainConfig.DebugTexture != DebugTexture_None)
         {
+            TraceSpan debugSpan("Reconstruction debug texture", m_lastFrameSequence);
+
             DebugTexture& texture = m_configManager->GetDebugTexture();
-            std::lock_guard<std::mutex> writelock(texture.RWMutex);
+            std::lock_guard<ProfiledMutex> writelock(texture.RWMutex);
 
             if (mainConfig.DebugTexture == DebugTexture_Disparity)
             {
@@ -726,7 +1005,16 @@ void DepthReconstruction::RunThread()
             }
         }
         
-        m_averageReconstructionTime = UpdateAveragePerfTime(m_reconstructionTimes, EndPerfTimer(startReconstructionTime), 20);
+        uint64_t reconstructionEndTime = GetMonotonicTimeNs();
+        uint64_t reconstructionTime = reconstructionEndTime - startReconstructionTime;
+
+        // The reconstruction needs to finish before the next camera frame it would process arrives.
+        float budgetMS = PerfTimeline::Get().GetSeries(PerfTimeline_CameraFramePeriod).GetLatestDurationMS() * (stereoConfig.StereoFrameSkip + 1);
+        bool bMissedBudget = budgetMS > 0.0f && NsToMS(reconstructionTime) > budgetMS;
+
+        m_reconstructionTimer.Record(reconstructionTime);
+        PerfTimeline::Get().Record(PerfTimeline_Reconstruction, reconstructionEndTime, reconstructionTime, bMissedBudget);
+        m_reconstructedFramesCounter.Add();
     }
 }
 
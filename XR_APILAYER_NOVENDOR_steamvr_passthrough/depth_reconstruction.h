@@ -4,6 +4,9 @@
 #include "openvr_manager.h"
 #include "config_manager.h"
 #include "camera_manager.h"
+#include "room_geometry_cache.h"
+#include "frame_change_detector.h"
+#include "reconstruction_thread_pool.h"
 
 #include <opencv2/imgproc/types_c.h>
 #include <opencv2/calib3d.hpp>
@@ -17,20 +20,24 @@ public:
 	~DepthReconstruction();
 
 	std::shared_ptr<DepthFrame> GetDepthFrame();
+
+	// The distortion parameters are built in the background after construction, and must not be used before this returns true.
+	bool IsDistortionReady() const { return m_bDistortionReady; }
 	UVDistortionParameters& GetDistortionParameters()
 	{
 		return m_distortionParams;
 	}
-	float GetReconstructionPerfTime() { return m_averageReconstructionTime; }
 
 private:
 	void InitReconstruction();
+	void InitStereoBuffers();
 	void RunThread();
 	void CreateDistortionMap();
+	void ComputeDisparity(cv::Ptr<cv::StereoMatcher>& matcher, const cv::Mat& frame, const cv::Mat& otherFrame, cv::Mat& disparity, const std::vector<uint8_t>* changedBands, const RoomCachePrediction* prediction, int minDisparity, std::vector<uint8_t>& matchedBands);
 
 	std::thread m_thread;
 	std::atomic_bool m_bRunThread;
-	std::mutex m_serveMutex;
+	ProfiledMutex m_serveMutex;
 
 	std::shared_ptr<ConfigManager> m_configManager;
 	std::shared_ptr<OpenVRManager> m_openVRManager;
@@ -39,6 +46,7 @@ private:
 	std::shared_ptr<DepthFrame> m_servedDepthFrame;
 	std::shared_ptr<DepthFrame> m_depthFrame;
 	std::shared_ptr<DepthFrame> m_underConstructionDepthFrame;
+	uint64_t m_depthFrameGeneration;
 
 	UVDistortionParameters m_distortionParams;
 
@@ -60,6 +68,11 @@ private:
 	float m_depthOffsetCalibration;
 	int m_maxDisparity;
 	bool m_bUseMulticore;
+	int m_threadCount;
+	uint64_t m_threadAffinityMask;
+	int m_threadPriority;
+	std::shared_ptr<ReconstructionThreadPool> m_threadPool;
+	std::string m_previousParallelBackend;
 	bool m_bUseColor;
 	bool m_bDisparityBothEyes;
 
@@ -115,8 +128,30 @@ private:
 	cv::Mat m_outputDisparityLeft;
 	cv::Mat m_outputDisparityRight;
 
-	std::deque<float> m_reconstructionTimes;
-	float m_averageReconstructionTime;
+	MetricTimer& m_reconstructionTimer;
+	MetricCounter& m_reconstructedFramesCounter;
+	MetricTimer& m_roomCacheTimer;
+	MetricGauge& m_roomCacheMemoryGauge;
+	MetricGauge& m_roomCacheSkippedGauge;
+
+	RoomGeometryCache m_roomCache;
+	RoomCachePrediction m_roomCachePredictionLeft;
+	RoomCachePrediction m_roomCachePredictionRight;
+	cv::Mat m_roomCacheBandDisparity;
+	std::vector<uint8_t> m_matchedBandsLeft;
+	std::vector<uint8_t> m_matchedBandsRight;
+
+	MetricCounter& m_skippedFramesCounter;
+	MetricGauge& m_reusedBandsGauge;
+	MetricGauge& m_depthStalenessGauge;
+	MetricGauge& m_threadCountGauge;
+	MetricTimer& m_rectificationTimer;
+
+	std::atomic_bool m_bDistortionReady;
+	bool m_bStereoBuffersValid;
+
+	FrameChangeDetector m_changeDetector;
+	std::vector<uint8_t> m_changedBands;
 
 	cv::Mat m_colorRectifyInput;
 	cv::Mat m_colorRectifyLeft;
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "frame_change_detector.h"
+#include <log.h>
+
+#include <opencv2/imgproc.hpp>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+FrameChangeDetector::FrameChangeDetector()
+    : m_bHasReference(false)
+    , m_referencePose()
+    , m_maxBandAge(0)
+{
+}
+
+void FrameChangeDetector::Reset()
+{
+    m_bHasReference = false;
+    m_bandAge.clear();
+    m_maxBandAge = 0;
+}
+
+
+EFrameChange FrameChangeDetector::Update(const cv::Mat& frameLeft, const cv::Mat& frameRight, const XrMatrix4x4f& cameraViewToWorld, float lumaThreshold, int bandHeight, std::vector<uint8_t>& changedBands)
+{
+    int numBands = (frameLeft.rows + bandHeight - 1) / bandHeight;
+
+    DownscaleLuma(frameLeft, m_lumaLeft);
+
+    if (!frameRight.empty())
+    {
+        DownscaleLuma(frameRight, m_lumaRight);
+    }
+    else
+    {
+        m_lumaRight.release();
+    }
+
+    bool bFullMatch = !m_bHasReference ||
+        m_bandAge.size() != (size_t)numBands ||
+        m_referenceLeft.size() != m_lumaLeft.size() ||
+        m_referenceRight.size() != m_lumaRight.size() ||
+        HasPoseChanged(cameraViewToWorld);
+
+    if (bFullMatch)
+    {
+        changedBands.assign(numBands, 1);
+        m_bandAge.assign(numBands, 0);
+        m_maxBandAge = 0;
+
+        m_lumaLeft.copyTo(m_referenceLeft);
+        m_lumaRight.copyTo(m_referenceRight);
+        m_referencePose = cameraViewToWorld;
+        m_bHasReference = true;
+
+        return FrameChange_Full;
+    }
+
+    changedBands.assign(numBands, 0);
+
+    FindChangedBands(m_lumaLeft, m_referenceLeft, lumaThreshold, bandHeight, changedBands);
+
+    if (!m_lumaRight.empty())
+    {
+        FindChangedBands(m_lumaRight, m_referenceRight, lumaThreshold, bandHeight, changedBands);
+    }
+
+    bool bAnyChanged = false;
+    m_maxBandAge = 0;
+
+    for (int band = 0; band < numBands; band++)
+    {
+        if (m_bandAge[band] + 1 >= CHANGE_DETECTOR_MAX_STALE_FRAMES)
+        {
+            changedBands[band] = 1;
+        }
+
+        if (!changedBands[band])
+        {
+            m_bandAge[band]++;
+            m_maxBandAge = std::max(m_maxBandAge, m_bandAge[band]);
+            continue;
+        }
+
+        bAnyChanged = true;
+        m_bandAge[band] = 0;
+
+        // The band is matched against the current frame, so it becomes the new reference.
+        int startRow = std::min(band * bandHeight / CHANGE_DETECTOR_DOWNSCALE, m_lumaLeft.rows);
+        int endRow = std::min((band + 1) * bandHeight / CHANGE_DETECTOR_DOWNSCALE, m_lumaLeft.rows);
+
+        m_lumaLeft.rowRange(startRow, endRow).copyTo(m_referenceLeft.rowRange(startRow, endRow));
+
+        if (!m_lumaRight.empty())
+        {
+            m_lumaRight.rowRange(startRow, endRow).copyTo(m_referenceRight.rowRange(startRow, endRow));
+        }
+    }
+
+    return bAnyChanged ? FrameChange_Partial : FrameChange_None;
+}
+
+
+void FrameChangeDetector::DownscaleLuma(const cv::Mat& frame, cv::Mat& luma)
+{
+    cv::Size size(frame.cols / CHANGE_DETECTOR_DOWNSCALE, frame.rows / CHANGE_DETECTOR_DOWNSCALE);
+
+    if (frame.channels() == 3)
+    {
+        cv::cvtColor(frame, m_grayScratch, cv::COLOR_RGB2GRAY);
+        cv::resize(m_grayScratch, luma, size, 0.0, 0.0, cv::INTER_AREA);
+    }
+    else
+    {
+        cv::resize(frame, luma, size, 0.0, 0.0, cv::INTER_AREA);
+    }
+}
+
+
+bool FrameChangeDetector::HasPoseChanged(const XrMatrix4x4f& cameraViewToWorld) const
+{
+    const float* a = m_referencePose.m;
+    const float* b = cameraViewToWorld.m;
+
+    float dx = b[12] - a[12];
+    float dy = b[13] - a[13];
+    float dz = b[14] - a[14];
+
+    if (dx * dx + dy * dy + dz * dz > CHANGE_DETECTOR_MAX_TRANSLATION * CHANGE_DETECTOR_MAX_TRANSLATION)
+    {
+        return true;
+    }
+
+    // trace(Ra^T * Rb) = 1 + 2 * cos(angle)
+    float trace = 0.0f;
+
+    for (int column = 0; column < 3; column++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            trace += a[column * 4 + row] * b[column * 4 + row];
+        }
+    }
+
+    float cosAngle = std::clamp((trace - 1.0f) * 0.5f, -1.0f, 1.0f);
+
+    return cosAngle < cosf((float)(CHANGE_DETECTOR_MAX_ROTATION_DEG * CV_PI / 180.0));
+}
+
+
+void FrameChangeDetector::FindChangedBands(const cv::Mat& luma, const cv::Mat& reference, float lumaThreshold, int bandHeight, std::vector<uint8_t>& changedBands)
+{
+    int tileSize = std::max(bandHeight / CHANGE_DETECTOR_DOWNSCALE, 1);
+
+    for (int band = 0; band < (int)changedBands.size(); band++)
+    {
+        if (changedBands[band])
+        {
+            continue;
+        }
+
+        int startRow = std::min(band * tileSize, luma.rows);
+        int endRow = std::min((band + 1) * tileSize, luma.rows);
+
+        for (int tileX = 0; tileX < luma.cols && !changedBands[band]; tileX += tileSize)
+        {
+            int tileEndX = std::min(tileX + tileSize, luma.cols);
+            int difference = 0;
+
+            for (int y = startRow; y < endRow; y++)
+            {
+                const uint8_t* row = luma.ptr<uint8_t>(y);
+                const uint8_t* referenceRow = reference.ptr<uint8_t>(y);
+
+                for (int x = tileX; x < tileEndX; x++)
+                {
+                    difference += abs((int)row[x] - (int)referenceRow[x]);
+                }
+            }
+
+            int numPixels = (endRow - startRow) * (tileEndX - tileX);
+
+            if (numPixels > 0 && difference > lumaThreshold * numPixels)
+            {
+                changedBands[band] = 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <xr_linear.h>
+
+#include <opencv2/core.hpp>
+
+
+// Luma is compared at this fraction of the reconstruction resolution.
+#define CHANGE_DETECTOR_DOWNSCALE 4
+#define CHANGE_DETECTOR_MAX_TRANSLATION 0.002f
+#define CHANGE_DETECTOR_MAX_ROTATION_DEG 0.2f
+
+// Every band is matched again after this many frames, even if no change is detected.
+#define CHANGE_DETECTOR_MAX_STALE_FRAMES 30
+
+
+enum EFrameChange
+{
+	FrameChange_None,
+	FrameChange_Partial,
+	FrameChange_Full
+};
+
+
+// Detects which bands of rows of the rectified camera frames have changed since they were last matched.
+// Any camera movement requires a full match, while a static camera only needs the bands where the
+// downscaled luma differs from the reference captured when the band was last matched.
+class FrameChangeDetector
+{
+public:
+	FrameChangeDetector();
+
+	void Reset();
+
+	// frameRight may be empty. Bands flagged in changedBands are assumed to be matched this frame.
+	EFrameChange Update(const cv::Mat& frameLeft, const cv::Mat& frameRight, const XrMatrix4x4f& cameraViewToWorld, float lumaThreshold, int bandHeight, std::vector<uint8_t>& changedBands);
+
+	// Largest number of frames since any band was last matched.
+	uint32_t GetMaxBandAge() const { return m_maxBandAge; }
+
+private:
+	void DownscaleLuma(const cv::Mat& frame, cv::Mat& luma);
+	bool HasPoseChanged(const XrMatrix4x4f& cameraViewToWorld) const;
+	void FindChangedBands(const cv::Mat& luma, const cv::Mat& reference, float lumaThreshold, int bandHeight, std::vector<uint8_t>& changedBands);
+
+	bool m_bHasReference;
+	XrMatrix4x4f m_referencePose;
+	cv::Mat m_referenceLeft;
+	cv::Mat m_referenceRight;
+	cv::Mat m_lumaLeft;
+	cv::Mat m_lumaRight;
+	cv::Mat m_grayScratch;
+
+	std::vector<uint32_t> m_bandAge;
+	uint32_t m_maxBandAge;
+};
@@ -220,6 +220,9 @@ namespace LAYER_NAMESPACE {
             ErrorLog("xrDestroyInstance failed with %d\n", result);
         }
 
+        // The layer may be unloaded after the instance is destroyed, so the log writer thread can't be left running.
+        FlushLog();
+
         return result;
     }
 
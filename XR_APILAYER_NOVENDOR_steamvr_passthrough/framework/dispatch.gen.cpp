@@ -23,6 +23,7 @@
 
 #include "pch.h"
 
+#include <atomic>
 #include <layer.h>
 
 #include "dispatch.h"
@@ -32,16 +33,43 @@
 #error Must define LAYER_NAMESPACE
 #endif
 
+// Tracing of the wrappers, chosen at compile time:
+// 0 - no tracing, 1 - trace all calls except the hot path ones, 2 - trace all calls.
+#ifndef DISPATCH_TRACE_LEVEL
+#if USE_TRACELOGGING
+#define DISPATCH_TRACE_LEVEL 1
+#else
+#define DISPATCH_TRACE_LEVEL 0
+#endif
+#endif
+
+#if DISPATCH_TRACE_LEVEL > 0 && !USE_TRACELOGGING
+#error DISPATCH_TRACE_LEVEL requires USE_TRACELOGGING
+#endif
+
 using namespace LAYER_NAMESPACE::log;
 
+namespace
+{
+	// Instance serving the hot path wrappers. Set when their functions are resolved, which can only happen after the instance is created.
+	// Published with release ordering, so the wrappers see the resolved functions through the acquire load.
+	std::atomic<LAYER_NAMESPACE::OpenXrApi*> g_hotPathInstance{ nullptr };
+} // namespace
+
 namespace LAYER_NAMESPACE
 {
+	OpenXrApi::~OpenXrApi()
+	{
+		OpenXrApi* expected = this;
+		g_hotPathInstance.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+	}
+
 
 	// Auto-generated wrappers for the requested APIs.
 
 	XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrGetSystem");
 #endif
 
@@ -50,15 +78,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrGetSystem(instance, getInfo, systemId);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrGetSystem_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrGetSystem: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrGetSystem_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -70,7 +98,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t environmentBlendModeCapacityInput, uint32_t* environmentBlendModeCountOutput, XrEnvironmentBlendMode* environmentBlendModes)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrEnumerateEnvironmentBlendModes");
 #endif
 
@@ -79,15 +107,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrEnumerateEnvironmentBlendModes(instance, systemId, viewConfigurationType, environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrEnumerateEnvironmentBlendModes_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrEnumerateEnvironmentBlendModes: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrEnumerateEnvironmentBlendModes_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -99,7 +127,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateSession");
 #endif
 
@@ -108,15 +136,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrCreateSession(instance, createInfo, session);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrCreateSession_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrCreateSession: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateSession_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -128,7 +156,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrDestroySession(XrSession session)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySession");
 #endif
 
@@ -137,15 +165,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrDestroySession(session);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrDestroySession_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrDestroySession: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySession_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -157,7 +185,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateReferenceSpace");
 #endif
 
@@ -166,15 +194,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrCreateReferenceSpace(session, createInfo, space);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrCreateReferenceSpace_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrCreateReferenceSpace: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateReferenceSpace_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -186,7 +214,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrDestroySpace(XrSpace space)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySpace");
 #endif
 
@@ -195,15 +223,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrDestroySpace(space);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrDestroySpace_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrDestroySpace: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySpace_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -215,7 +243,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain");
 #endif
 
@@ -224,15 +252,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrCreateSwapchain(session, createInfo, swapchain);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrCreateSwapchain: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -244,7 +272,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrDestroySwapchain(XrSwapchain swapchain)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySwapchain");
 #endif
 
@@ -253,15 +281,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrDestroySwapchain(swapchain);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrDestroySwapchain_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrDestroySwapchain: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrDestroySwapchain_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -273,24 +301,24 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage");
 #endif
 
 		XrResult result;
 		try
 		{
-			result = LAYER_NAMESPACE::GetInstance()->xrAcquireSwapchainImage(swapchain, acquireInfo, index);
+			result = g_hotPathInstance.load(std::memory_order_acquire)->xrAcquireSwapchainImage(swapchain, acquireInfo, index);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 			TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrAcquireSwapchainImage: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -302,24 +330,24 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrReleaseSwapchainImage");
 #endif
 
 		XrResult result;
 		try
 		{
-			result = LAYER_NAMESPACE::GetInstance()->xrReleaseSwapchainImage(swapchain, releaseInfo);
+			result = g_hotPathInstance.load(std::memory_order_acquire)->xrReleaseSwapchainImage(swapchain, releaseInfo);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 			TraceLoggingWrite(g_traceProvider, "xrReleaseSwapchainImage_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrReleaseSwapchainImage: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrReleaseSwapchainImage_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -331,24 +359,24 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrBeginFrame");
 #endif
 
 		XrResult result;
 		try
 		{
-			result = LAYER_NAMESPACE::GetInstance()->xrBeginFrame(session, frameBeginInfo);
+			result = g_hotPathInstance.load(std::memory_order_acquire)->xrBeginFrame(session, frameBeginInfo);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 			TraceLoggingWrite(g_traceProvider, "xrBeginFrame_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrBeginFrame: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrBeginFrame_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -360,24 +388,24 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrEndFrame");
 #endif
 
 		XrResult result;
 		try
 		{
-			result = LAYER_NAMESPACE::GetInstance()->xrEndFrame(session, frameEndInfo);
+			result = g_hotPathInstance.load(std::memory_order_acquire)->xrEndFrame(session, frameEndInfo);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 			TraceLoggingWrite(g_traceProvider, "xrEndFrame_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrEndFrame: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 2
 		TraceLoggingWrite(g_traceProvider, "xrEndFrame_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -389,7 +417,7 @@ namespace LAYER_NAMESPACE
 
 	XrResult xrSetEnvironmentDepthEstimationVARJO(XrSession session, XrBool32 enabled)
 	{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrSetEnvironmentDepthEstimationVARJO");
 #endif
 
@@ -398,15 +426,15 @@ namespace LAYER_NAMESPACE
 		{
 			result = LAYER_NAMESPACE::GetInstance()->xrSetEnvironmentDepthEstimationVARJO(session, enabled);
 		}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 			TraceLoggingWrite(g_traceProvider, "xrSetEnvironmentDepthEstimationVARJO_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("xrSetEnvironmentDepthEstimationVARJO: %s\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}
-#if USE_TRACELOGGING
+#if DISPATCH_TRACE_LEVEL >= 1
 		TraceLoggingWrite(g_traceProvider, "xrSetEnvironmentDepthEstimationVARJO_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {
@@ -473,21 +501,25 @@ namespace LAYER_NAMESPACE
 		{
 			m_xrAcquireSwapchainImage = reinterpret_cast<PFN_xrAcquireSwapchainImage>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrAcquireSwapchainImage);
+			g_hotPathInstance.store(this, std::memory_order_release);
 		}
 		else if (apiName == "xrReleaseSwapchainImage")
 		{
 			m_xrReleaseSwapchainImage = reinterpret_cast<PFN_xrReleaseSwapchainImage>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrReleaseSwapchainImage);
+			g_hotPathInstance.store(this, std::memory_order_release);
 		}
 		else if (apiName == "xrBeginFrame")
 		{
 			m_xrBeginFrame = reinterpret_cast<PFN_xrBeginFrame>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrBeginFrame);
+			g_hotPathInstance.store(this, std::memory_order_release);
 		}
 		else if (apiName == "xrEndFrame")
 		{
 			m_xrEndFrame = reinterpret_cast<PFN_xrEndFrame>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEndFrame);
+			g_hotPathInstance.store(this, std::memory_order_release);
 		}
 		else if (apiName == "xrSetEnvironmentDepthEstimationVARJO")
 		{
@@ -44,7 +44,7 @@ namespace LAYER_NAMESPACE
 		PFN_xrGetInstanceProcAddr m_xrGetInstanceProcAddr{ nullptr };
 
 	public:
-		virtual ~OpenXrApi() = default;
+		virtual ~OpenXrApi();
 
 		XrInstance GetXrInstance() const
 		{
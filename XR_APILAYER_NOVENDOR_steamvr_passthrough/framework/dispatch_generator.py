@@ -55,6 +55,10 @@ if 'xrGetInstanceProcAddr' in layer_apis.override_functions:
 if 'xrGetInstanceProcAddr' in layer_apis.requested_functions:
     raise Exception("xrGetInstanceProcAddr() cannot be specified in requested_functions. Use the m_xrGetInstanceProcAddr() class member.")
 
+for hot_path_function in layer_apis.hot_path_functions:
+    if hot_path_function not in layer_apis.override_functions:
+        raise Exception(f"{hot_path_function}() is specified in hot_path_functions but not in override_functions.")
+
 
 class DispatchGenOutputGenerator(AutomaticSourceOutputGenerator):
     '''Common generator utilities and formatting.'''
@@ -114,6 +118,7 @@ class DispatchGenCppOutputGenerator(DispatchGenOutputGenerator):
         DispatchGenOutputGenerator.beginFile(self, genOpts)
         preamble = '''#include "pch.h"
 
+#include <atomic>
 #include <layer.h>
 
 #include "dispatch.h"
@@ -123,10 +128,37 @@ class DispatchGenCppOutputGenerator(DispatchGenOutputGenerator):
 #error Must define LAYER_NAMESPACE
 #endif
 
+// Tracing of the wrappers, chosen at compile time:
+// 0 - no tracing, 1 - trace all calls except the hot path ones, 2 - trace all calls.
+#ifndef DISPATCH_TRACE_LEVEL
+#if USE_TRACELOGGING
+#define DISPATCH_TRACE_LEVEL 1
+#else
+#define DISPATCH_TRACE_LEVEL 0
+#endif
+#endif
+
+#if DISPATCH_TRACE_LEVEL > 0 && !USE_TRACELOGGING
+#error DISPATCH_TRACE_LEVEL requires USE_TRACELOGGING
+#endif
+
 using namespace LAYER_NAMESPACE::log;
 
+namespace
+{
+	// Instance serving the hot path wrappers. Set when their functions are resolved, which can only happen after the instance is created.
+	// Published with release ordering, so the wrappers see the resolved functions through the acquire load.
+	std::atomic<LAYER_NAMESPACE::OpenXrApi*> g_hotPathInstance{ nullptr };
+} // namespace
+
 namespace LAYER_NAMESPACE
-{'''
+{
+	OpenXrApi::~OpenXrApi()
+	{
+		OpenXrApi* expected = this;
+		g_hotPathInstance.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+	}
+'''
         write(preamble, file=self.outFile)
 
     def endFile(self):
@@ -157,31 +189,44 @@ namespace LAYER_NAMESPACE
 
         for cur_cmd in self.core_commands + self.ext_commands:
             if cur_cmd.name in layer_apis.override_functions:
-                parameters_list = self.makeParametersList(cur_cmd)
-                arguments_list = self.makeArgumentsList(cur_cmd)
+                generated += self.genWrapper(cur_cmd, cur_cmd.name in layer_apis.hot_path_functions)
+                
+        return generated
 
-                if cur_cmd.return_type is not None:
-                    generated += f'''
+    def genWrapper(self, cur_cmd, is_hot_path):
+        parameters_list = self.makeParametersList(cur_cmd)
+        arguments_list = self.makeArgumentsList(cur_cmd)
+
+        # Hot path wrappers skip the instance lookup and are only traced at the highest level.
+        if is_hot_path:
+            trace_condition = 'DISPATCH_TRACE_LEVEL >= 2'
+            instance = 'g_hotPathInstance.load(std::memory_order_acquire)'
+        else:
+            trace_condition = 'DISPATCH_TRACE_LEVEL >= 1'
+            instance = 'LAYER_NAMESPACE::GetInstance()'
+
+        if cur_cmd.return_type is not None:
+            return f'''
 	XrResult {cur_cmd.name}({parameters_list})
 	{{
-#if USE_TRACELOGGING
+#if {trace_condition}
 		TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}");
 #endif
 
 		XrResult result;
 		try
 		{{
-			result = LAYER_NAMESPACE::GetInstance()->{cur_cmd.name}({arguments_list});
+			result = {instance}->{cur_cmd.name}({arguments_list});
 		}}
-		catch (std::exception exc)
+		catch (const std::exception& exc)
 		{{
-#if USE_TRACELOGGING
+#if {trace_condition}
 			TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("{cur_cmd.name}: %s\\n", exc.what());
 			result = XR_ERROR_RUNTIME_FAILURE;
 		}}
-#if USE_TRACELOGGING
+#if {trace_condition}
 		TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}_Result", TLArg(xr::ToCString(result), "Result"));
 #endif
 		if (XR_FAILED(result)) {{
@@ -191,33 +236,31 @@ namespace LAYER_NAMESPACE
 		return result;
 	}}
 '''
-                else:
-                    generated += f'''
+        else:
+            return f'''
 	void {cur_cmd.name}({parameters_list})
 	{{
-#if USE_TRACELOGGING
+#if {trace_condition}
 		TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}");
 #endif
 
 		try
 		{{
-			LAYER_NAMESPACE::GetInstance()->{cur_cmd.name}({arguments_list});
+			{instance}->{cur_cmd.name}({arguments_list});
 		}}
-		catch (std::runtime_error exc)
+		catch (const std::exception& exc)
 		{{
-#if USE_TRACELOGGING
+#if {trace_condition}
 			TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}_Error", TLArg(exc.what(), "Error"));
 #endif
 			ErrorLog("{cur_cmd.name}: %s\\n", exc.what());
 		}}
 
-#if USE_TRACELOGGING
+#if {trace_condition}
 		TraceLoggingWrite(g_traceProvider, "{cur_cmd.name}_Complete");
 #endif
 	}}
 '''
-                
-        return generated
 
     def genCreateInstance(self):
         generated = '''	XrResult OpenXrApi::xrCreateInstance(const XrInstanceCreateInfo* createInfo)
@@ -264,7 +307,7 @@ namespace LAYER_NAMESPACE
 		{{
 			m_{cur_cmd.name} = reinterpret_cast<PFN_{cur_cmd.name}>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
-		}}
+{self.genCacheHotPathInstance(cur_cmd)}		}}
 '''
 
         # Always advertise extension functions.
@@ -275,7 +318,7 @@ namespace LAYER_NAMESPACE
 			m_{cur_cmd.name} = reinterpret_cast<PFN_{cur_cmd.name}>(*function);
 			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
 			result = XR_SUCCESS;
-		}}
+{self.genCacheHotPathInstance(cur_cmd)}		}}
 '''
 
         generated += '''
@@ -285,6 +328,12 @@ namespace LAYER_NAMESPACE
 
         return generated
 
+    def genCacheHotPathInstance(self, cur_cmd):
+        if cur_cmd.name in layer_apis.hot_path_functions:
+            return '''			g_hotPathInstance.store(this, std::memory_order_release);
+'''
+        return ''
+
 
 class DispatchGenHOutputGenerator(DispatchGenOutputGenerator):
     '''Generator for dispatch.gen.h.'''
@@ -313,7 +362,7 @@ namespace LAYER_NAMESPACE
 		PFN_xrGetInstanceProcAddr m_xrGetInstanceProcAddr{ nullptr };
 
 	public:
-		virtual ~OpenXrApi() = default;
+		virtual ~OpenXrApi();
 
 		XrInstance GetXrInstance() const
 		{
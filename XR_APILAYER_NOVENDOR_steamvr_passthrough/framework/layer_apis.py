@@ -15,6 +15,15 @@ override_functions = [
     "xrSetEnvironmentDepthEstimationVARJO"
 ]
 
+# Overridden functions called every frame. Their wrappers use the instance cached when the function
+# was resolved, and are only traced with DISPATCH_TRACE_LEVEL 2.
+hot_path_functions = [
+    "xrAcquireSwapchainImage",
+    "xrReleaseSwapchainImage",
+    "xrBeginFrame",
+    "xrEndFrame"
+]
+
 # The list of OpenXR functions our layer will use from the runtime.
 # Might repeat entries from override_functions above.
 requested_functions = [
@@ -22,12 +22,77 @@
 
 #include "pch.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <string_view>
+#include <vector>
+
 namespace {
     constexpr uint32_t k_maxLoggedErrors = 100;
-    uint32_t g_globalErrorCount = 0;
+    std::atomic_uint32_t g_globalErrorCount = 0;
     constexpr uint32_t k_maxBufferedLines = 200;
     std::deque<std::string> g_logBuffer;
     std::shared_timed_mutex g_logBufferMutex;
+
+    // Messages are formatted into fixed size records, longer ones are truncated.
+    constexpr size_t k_maxRecordLength = 512;
+
+    // Records per thread. Messages are dropped if a thread fills its ring before the writer thread drains it.
+    constexpr uint32_t k_recordsPerThread = 64;
+
+    // Repeats of the same error are reported as a count at most this often, in seconds.
+    constexpr std::time_t k_repeatReportInterval = 5;
+
+    struct LogRecord {
+        uint64_t sequence;
+        std::time_t time;
+        char text[k_maxRecordLength];
+    };
+
+    // Single producer, single consumer ring written by the owning thread and drained by the writer thread.
+    struct LogRing {
+        std::array<LogRecord, k_recordsPerThread> records;
+        std::atomic_uint32_t writeIndex{0};
+        std::atomic_uint32_t readIndex{0};
+
+        // Last error logged by the thread, used to collapse identical repeats. The hash is only used by the owning thread,
+        // the repeat count is also reported by the writer thread so it isn't lost if the thread stops logging.
+        bool bHasLastError = false;
+        size_t lastErrorHash = 0;
+        std::atomic_uint32_t errorRepeats{0};
+        std::atomic<std::time_t> lastRepeatReport{0};
+
+        // Set when the owning thread exits. The writer drains the ring and then removes it.
+        std::atomic_bool bThreadExited{false};
+    };
+
+    // Static destructors only run after the other threads have been terminated at process exit,
+    // so a writer thread that was never stopped is detached instead of joined.
+    struct WriterThread {
+        std::thread thread;
+
+        ~WriterThread() {
+            if (thread.joinable()) {
+                thread.detach();
+            }
+        }
+    };
+
+    std::mutex g_ringsMutex;
+    std::vector<std::shared_ptr<LogRing>> g_rings;
+    std::atomic_uint64_t g_sequence = 0;
+    std::atomic_uint64_t g_droppedRecords = 0;
+
+    std::mutex g_writerControlMutex;
+    std::mutex g_writerMutex;
+    WriterThread g_writerThread;
+    std::atomic_bool g_bRunWriterThread = false;
+
+    // The writer thread sleeps until a thread commits a record, or a repeat count is due.
+    std::mutex g_writerWakeMutex;
+    std::condition_variable g_writerWakeCondition;
+    std::atomic_bool g_bRecordsPending = false;
 } // namespace
 
 namespace LAYER_NAMESPACE::log {
@@ -46,12 +111,7 @@ namespace LAYER_NAMESPACE::log {
 
         void BufferLog(const char* buf)
         {
-            std::unique_lock writeLock(g_logBufferMutex, std::chrono::milliseconds(1));
-
-            if (!writeLock.owns_lock())
-            {
-                return;
-            }
+            std::unique_lock writeLock(g_logBufferMutex);
 
             g_logBuffer.emplace_back(buf);
 
@@ -61,20 +121,276 @@ namespace LAYER_NAMESPACE::log {
             }
         }
 
-        // Utility logging function.
-        void InternalLog(const char* fmt, va_list va) {
-            const std::time_t now = std::time(nullptr);
-
-            char buf[1024];
-            size_t offset = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %z: ", std::localtime(&now));
-            vsnprintf_s(buf + offset, sizeof(buf) - offset, _TRUNCATE, fmt, va);
+        void WriteLine(std::time_t time, const char* text)
+        {
+            char buf[k_maxRecordLength + 64];
+            size_t offset = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %z: ", std::localtime(&time));
+            strncpy_s(buf + offset, sizeof(buf) - offset, text, _TRUNCATE);
 
             BufferLog(buf);
             OutputDebugStringA(buf);
             if (logStream.is_open()) {
                 logStream << buf;
+            }
+        }
+
+        void WakeWriter()
+        {
+            // Only the first record after the writer starts draining needs to wake it.
+            if (!g_bRecordsPending.exchange(true, std::memory_order_acq_rel))
+            {
+                {
+                    std::lock_guard lock(g_writerWakeMutex);
+                }
+                g_writerWakeCondition.notify_one();
+            }
+        }
+
+        // Writes out the repeat count of the last error of a thread, if it is due. Returns true if a count is still pending.
+        bool WriteErrorRepeats(LogRing& ring, std::time_t now, bool bForce)
+        {
+            if (ring.errorRepeats.load(std::memory_order_relaxed) == 0)
+            {
+                return false;
+            }
+
+            if (!bForce && now - ring.lastRepeatReport.load(std::memory_order_relaxed) < k_repeatReportInterval)
+            {
+                return true;
+            }
+
+            uint32_t count = ring.errorRepeats.exchange(0, std::memory_order_relaxed);
+            if (count > 0)
+            {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "Last error repeated %u more times\n", count);
+                WriteLine(now, buf);
+                ring.lastRepeatReport.store(now, std::memory_order_relaxed);
+            }
+            return false;
+        }
+
+        // Writes out everything the threads have logged so far, ordered by when it was logged.
+        // Pending error repeat counts are written once they are due, or always if bFlushRepeats is set.
+        // Returns true if any repeat counts are still pending.
+        bool WriteRecords(bool bFlushRepeats)
+        {
+            std::lock_guard writerLock(g_writerMutex);
+
+            std::vector<std::shared_ptr<LogRing>> rings;
+            {
+                std::lock_guard ringsLock(g_ringsMutex);
+                rings = g_rings;
+            }
+
+            std::vector<const LogRecord*> records;
+            std::vector<uint32_t> writeIndices(rings.size());
+            std::vector<bool> threadExited(rings.size());
+
+            for (size_t i = 0; i < rings.size(); i++)
+            {
+                // Read before the write index, so all records of an exited thread are seen.
+                threadExited[i] = rings[i]->bThreadExited.load(std::memory_order_acquire);
+
+                uint32_t read = rings[i]->readIndex.load(std::memory_order_relaxed);
+                uint32_t write = rings[i]->writeIndex.load(std::memory_order_acquire);
+                writeIndices[i] = write;
+
+                for (uint32_t index = read; index != write; index++)
+                {
+                    records.push_back(&rings[i]->records[index % k_recordsPerThread]);
+                }
+            }
+
+            std::sort(records.begin(), records.end(), [](const LogRecord* a, const LogRecord* b) { return a->sequence < b->sequence; });
+
+            for (const LogRecord* record : records)
+            {
+                WriteLine(record->time, record->text);
+            }
+
+            uint64_t dropped = g_droppedRecords.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+            {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "%llu log messages dropped\n", dropped);
+                WriteLine(std::time(nullptr), buf);
+            }
+
+            // The records can only be reused once they have been written.
+            for (size_t i = 0; i < rings.size(); i++)
+            {
+                rings[i]->readIndex.store(writeIndices[i], std::memory_order_release);
+            }
+
+            const std::time_t now = std::time(nullptr);
+            bool bRepeatsPending = false;
+            bool bHasExitedRings = false;
+
+            for (size_t i = 0; i < rings.size(); i++)
+            {
+                bRepeatsPending |= WriteErrorRepeats(*rings[i], now, bFlushRepeats || threadExited[i]);
+                bHasExitedRings |= threadExited[i];
+            }
+
+            // The rings of exited threads are empty now.
+            if (bHasExitedRings)
+            {
+                std::lock_guard ringsLock(g_ringsMutex);
+
+                for (size_t i = 0; i < rings.size(); i++)
+                {
+                    if (threadExited[i])
+                    {
+                        g_rings.erase(std::find(g_rings.begin(), g_rings.end(), rings[i]));
+                    }
+                }
+            }
+
+            if (logStream.is_open()) {
                 logStream.flush();
             }
+
+            return bRepeatsPending;
+        }
+
+        void RunWriterThread()
+        {
+            bool bRepeatsPending = false;
+
+            while (g_bRunWriterThread.load(std::memory_order_acquire))
+            {
+                {
+                    std::unique_lock lock(g_writerWakeMutex);
+
+                    auto wakeCondition = [] { return g_bRecordsPending.load(std::memory_order_acquire) || !g_bRunWriterThread.load(std::memory_order_acquire); };
+
+                    if (bRepeatsPending)
+                    {
+                        g_writerWakeCondition.wait_for(lock, std::chrono::seconds(k_repeatReportInterval), wakeCondition);
+                    }
+                    else
+                    {
+                        g_writerWakeCondition.wait(lock, wakeCondition);
+                    }
+
+                    g_bRecordsPending.store(false, std::memory_order_relaxed);
+                }
+
+                bRepeatsPending = WriteRecords(false);
+            }
+        }
+
+        void StartWriterThread()
+        {
+            std::lock_guard lock(g_writerControlMutex);
+
+            if (g_bRunWriterThread)
+            {
+                return;
+            }
+
+            if (g_writerThread.thread.joinable())
+            {
+                g_writerThread.thread.join();
+            }
+
+            g_bRunWriterThread = true;
+            g_writerThread.thread = std::thread(RunWriterThread);
+        }
+
+        // Flags the ring of the thread when it exits. The registry keeps the ring alive until the writer
+        // has written the remaining lines, and then drops it.
+        struct ThreadRingOwner {
+            std::shared_ptr<LogRing> ring;
+
+            ~ThreadRingOwner() {
+                if (ring) {
+                    ring->bThreadExited.store(true, std::memory_order_release);
+                    WakeWriter();
+                }
+            }
+        };
+
+        LogRing* GetThreadRing()
+        {
+            thread_local ThreadRingOwner threadRing;
+
+            if (!threadRing.ring)
+            {
+                threadRing.ring = std::make_shared<LogRing>();
+
+                std::lock_guard lock(g_ringsMutex);
+                g_rings.push_back(threadRing.ring);
+            }
+
+            return threadRing.ring.get();
+        }
+
+        // Reserves the next record of the calling thread, or returns nullptr if its ring is full.
+        LogRecord* BeginRecord(LogRing*& ring)
+        {
+            if (!g_bRunWriterThread.load(std::memory_order_acquire))
+            {
+                StartWriterThread();
+            }
+
+            ring = GetThreadRing();
+
+            uint32_t write = ring->writeIndex.load(std::memory_order_relaxed);
+            uint32_t read = ring->readIndex.load(std::memory_order_acquire);
+
+            if (write - read >= k_recordsPerThread)
+            {
+                g_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            LogRecord& record = ring->records[write % k_recordsPerThread];
+            record.sequence = g_sequence.fetch_add(1, std::memory_order_relaxed);
+            record.time = std::time(nullptr);
+            return &record;
+        }
+
+        void CommitRecord(LogRing* ring)
+        {
+            ring->writeIndex.store(ring->writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            WakeWriter();
+        }
+
+        // Utility logging function. Only formats the message on the calling thread, the output is done by the writer thread.
+        void InternalLog(const char* fmt, va_list va) {
+            LogRing* ring;
+            LogRecord* record = BeginRecord(ring);
+
+            if (!record) {
+                return;
+            }
+
+            vsnprintf_s(record->text, sizeof(record->text), _TRUNCATE, fmt, va);
+            CommitRecord(ring);
+        }
+
+        void InternalLogText(const char* text) {
+            LogRing* ring;
+            LogRecord* record = BeginRecord(ring);
+
+            if (!record) {
+                return;
+            }
+
+            strncpy_s(record->text, sizeof(record->text), text, _TRUNCATE);
+            CommitRecord(ring);
+        }
+
+        void ReportErrorRepeats(LogRing& ring, std::time_t now) {
+            uint32_t count = ring.errorRepeats.exchange(0, std::memory_order_relaxed);
+            if (count > 0) {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "Last error repeated %u more times\n", count);
+                InternalLogText(buf);
+            }
+            ring.lastRepeatReport.store(now, std::memory_order_relaxed);
         }
     } // namespace
 
@@ -86,13 +402,41 @@ namespace LAYER_NAMESPACE::log {
     }
 
     void ErrorLog(const char* fmt, ...) {
-        if (g_globalErrorCount++ < k_maxLoggedErrors) {
-            va_list va;
-            va_start(va, fmt);
-            InternalLog(fmt, va);
-            va_end(va);
-            if (g_globalErrorCount == k_maxLoggedErrors) {
-                Log("Maximum number of errors logged. Going silent.");
+        if (g_globalErrorCount.load(std::memory_order_relaxed) >= k_maxLoggedErrors) {
+            return;
+        }
+
+        char text[k_maxRecordLength];
+        va_list va;
+        va_start(va, fmt);
+        vsnprintf_s(text, sizeof(text), _TRUNCATE, fmt, va);
+        va_end(va);
+
+        // Identical consecutive errors from a thread are collapsed into a periodic repeat count.
+        // The writer thread reports a pending count once it is due, even if the thread doesn't log again.
+        LogRing& ring = *GetThreadRing();
+        const size_t hash = std::hash<std::string_view>()(text);
+        const std::time_t now = std::time(nullptr);
+
+        if (ring.bHasLastError && hash == ring.lastErrorHash) {
+            if (now - ring.lastRepeatReport.load(std::memory_order_relaxed) >= k_repeatReportInterval) {
+                ring.errorRepeats.fetch_add(1, std::memory_order_relaxed);
+                ReportErrorRepeats(ring, now);
+            } else if (ring.errorRepeats.fetch_add(1, std::memory_order_relaxed) == 0) {
+                WakeWriter();
+            }
+            return;
+        }
+
+        ReportErrorRepeats(ring, now);
+        ring.bHasLastError = true;
+        ring.lastErrorHash = hash;
+
+        const uint32_t errorCount = g_globalErrorCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (errorCount <= k_maxLoggedErrors) {
+            InternalLogText(text);
+            if (errorCount == k_maxLoggedErrors) {
+                InternalLogText("Maximum number of errors logged. Going silent.\n");
             }
         }
     }
@@ -106,6 +450,24 @@ namespace LAYER_NAMESPACE::log {
 #endif
     }
 
+    void FlushLog() {
+        {
+            std::lock_guard lock(g_writerControlMutex);
+
+            {
+                std::lock_guard wakeLock(g_writerWakeMutex);
+                g_bRunWriterThread = false;
+            }
+            g_writerWakeCondition.notify_all();
+
+            if (g_writerThread.thread.joinable()) {
+                g_writerThread.thread.join();
+            }
+        }
+
+        WriteRecords(true);
+    }
+
     void ReadLogBuffer(void (*printFunc)(std::deque<std::string>& logBuffer))
     {
         std::shared_lock readLock(g_logBufferMutex, std::chrono::milliseconds(1));
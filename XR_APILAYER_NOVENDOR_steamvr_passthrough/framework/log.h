@@ -46,9 +46,13 @@ namespace LAYER_NAMESPACE::log {
     // Debug logging function. Can make things very slow (only enabled on Debug builds).
     void DebugLog(const char* fmt, ...);
 
-    // Error logging function. Goes silent after too many errors.
+    // Error logging function. Identical repeated errors are collapsed into a count, and it goes silent after too many errors.
     void ErrorLog(const char* fmt, ...);
 
+    // The logging functions only format the message into a per-thread buffer, which is written out by a background thread.
+    // Writes out all buffered messages and stops the background thread until the next message is logged.
+    void FlushLog();
+
     // Read buffer of log lines through passed function for display.
     void ReadLogBuffer(void (*printFunc)(std::deque<std::string>& logBuffer));
 
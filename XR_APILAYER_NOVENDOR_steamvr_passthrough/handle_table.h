@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+// Map from OpenXR handles to small values, using open addressing with linear probing.
+// The slots are stored inline until the table grows past InlineCapacity / 2 entries, after which they move to the heap.
+// Clearing or erasing never frees memory, so tables sized for the live handles don't allocate on per-frame paths.
+template<typename THandle, typename TValue, size_t InlineCapacity = 32>
+class HandleTable
+{
+	static_assert((InlineCapacity & (InlineCapacity - 1)) == 0, "InlineCapacity must be a power of two");
+
+public:
+	HandleTable()
+		: m_slots(m_inlineSlots.data())
+		, m_capacity(InlineCapacity)
+		, m_size(0)
+	{
+	}
+
+	HandleTable(const HandleTable&) = delete;
+	HandleTable& operator=(const HandleTable&) = delete;
+
+	size_t Size() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+
+	TValue* Find(THandle handle)
+	{
+		if (handle == THandle{})
+		{
+			return nullptr;
+		}
+
+		for (size_t index = GetHomeSlot(handle); ; index = (index + 1) & (m_capacity - 1))
+		{
+			if (m_slots[index].handle == handle)
+			{
+				return &m_slots[index].value;
+			}
+			else if (m_slots[index].handle == THandle{})
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	const TValue* Find(THandle handle) const
+	{
+		return const_cast<HandleTable*>(this)->Find(handle);
+	}
+
+	// Inserts the value, or replaces it if the handle is already present.
+	void Insert(THandle handle, const TValue& value)
+	{
+		if (handle == THandle{})
+		{
+			return;
+		}
+
+		if ((m_size + 1) * 2 > m_capacity)
+		{
+			Grow();
+		}
+
+		size_t index = GetHomeSlot(handle);
+
+		while (m_slots[index].handle != THandle{} && m_slots[index].handle != handle)
+		{
+			index = (index + 1) & (m_capacity - 1);
+		}
+
+		if (m_slots[index].handle == THandle{})
+		{
+			m_slots[index].handle = handle;
+			m_size++;
+		}
+
+		m_slots[index].value = value;
+	}
+
+	bool Erase(THandle handle)
+	{
+		if (handle == THandle{})
+		{
+			return false;
+		}
+
+		size_t index = GetHomeSlot(handle);
+
+		while (m_slots[index].handle != handle)
+		{
+			if (m_slots[index].handle == THandle{})
+			{
+				return false;
+			}
+			index = (index + 1) & (m_capacity - 1);
+		}
+
+		// Shift the following entries of the probe sequence back, so lookups never need tombstones.
+		size_t hole = index;
+
+		for (size_t next = (hole + 1) & (m_capacity - 1); m_slots[next].handle != THandle{}; next = (next + 1) & (m_capacity - 1))
+		{
+			size_t home = GetHomeSlot(m_slots[next].handle);
+
+			// The entry can fill the hole if its home slot is not cyclically between the hole and its current slot.
+			if (((next - home) & (m_capacity - 1)) >= ((next - hole) & (m_capacity - 1)))
+			{
+				m_slots[hole] = m_slots[next];
+				hole = next;
+			}
+		}
+
+		m_slots[hole] = Slot();
+		m_size--;
+		return true;
+	}
+
+	void Clear()
+	{
+		if (m_size == 0)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < m_capacity; i++)
+		{
+			m_slots[i] = Slot();
+		}
+		m_size = 0;
+	}
+
+	// Calls function(handle, value) for every entry. The table must not be modified during the iteration.
+	template<typename TFunction>
+	void ForEach(TFunction function) const
+	{
+		for (size_t i = 0; i < m_capacity; i++)
+		{
+			if (m_slots[i].handle != THandle{})
+			{
+				function(m_slots[i].handle, m_slots[i].value);
+			}
+		}
+	}
+
+private:
+	struct Slot
+	{
+		THandle handle{};
+		TValue value{};
+	};
+
+	size_t GetHomeSlot(THandle handle) const
+	{
+		uint64_t bits = 0;
+		memcpy(&bits, &handle, sizeof(handle) < sizeof(bits) ? sizeof(handle) : sizeof(bits));
+
+		// Fibonacci hashing, since runtimes often hand out sequential or aligned handle values.
+		return (size_t)((bits * 0x9E3779B97F4A7C15ull) >> 32) & (m_capacity - 1);
+	}
+
+	void Grow()
+	{
+		std::vector<Slot> oldSlots(m_slots, m_slots + m_capacity);
+
+		m_heapSlots.assign(m_capacity * 2, Slot());
+		m_slots = m_heapSlots.data();
+		m_capacity *= 2;
+		m_size = 0;
+
+		for (const Slot& slot : oldSlots)
+		{
+			if (slot.handle != THandle{})
+			{
+				Insert(slot.handle, slot.value);
+			}
+		}
+	}
+
+	std::array<Slot, InlineCapacity> m_inlineSlots;
+	std::vector<Slot> m_heapSlots;
+	Slot* m_slots;
+	size_t m_capacity;
+	size_t m_size;
+};
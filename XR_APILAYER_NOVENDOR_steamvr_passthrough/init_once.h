@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "metrics.h"
+#include "profiled_mutex.h"
+
+
+// Value that is initialized on first use from any thread, and published to all threads once the
+// initialization succeeds. Failed initializations are retried at most once per retry interval.
+// Once published, Get() is a single acquire load and the lock is never taken again.
+template<typename T>
+class InitOnce
+{
+public:
+	InitOnce(const char* mutexName, uint64_t retryIntervalNs)
+		: m_mutex(mutexName)
+		, m_retryIntervalNs(retryIntervalNs)
+		, m_lastAttemptTime(0)
+		, m_published(nullptr)
+	{}
+
+	// Returns the value, or nullptr if it isn't initialized and can't be initialized yet.
+	// The init function fills in the value and returns true on success. It is called with the lock held.
+	template<typename TInit>
+	const T* Get(TInit init)
+	{
+		const T* value = m_published.load(std::memory_order_acquire);
+		return value ? value : InitLocked(init, false);
+	}
+
+	// Attempts the initialization regardless of the retry interval, unless the value is already published.
+	template<typename TInit>
+	const T* Init(TInit init)
+	{
+		return InitLocked(init, true);
+	}
+
+	// Calls the shutdown function with the lock held if the value was published. The value can't be used afterwards.
+	template<typename TShutdown>
+	void Shutdown(TShutdown shutdown)
+	{
+		std::lock_guard<ProfiledMutex> lock(m_mutex);
+		if (m_published.load(std::memory_order_relaxed))
+		{
+			shutdown(m_value);
+		}
+	}
+
+private:
+	template<typename TInit>
+	const T* InitLocked(TInit& init, bool bForce)
+	{
+		std::lock_guard<ProfiledMutex> lock(m_mutex);
+
+		// Another thread may have finished the initialization while this one was waiting.
+		const T* value = m_published.load(std::memory_order_relaxed);
+		if (value)
+		{
+			return value;
+		}
+
+		uint64_t currentTime = GetMonotonicTimeNs();
+		if (!bForce && currentTime - m_lastAttemptTime < m_retryIntervalNs)
+		{
+			return nullptr;
+		}
+		m_lastAttemptTime = currentTime;
+
+		if (!init(m_value))
+		{
+			return nullptr;
+		}
+
+		m_published.store(&m_value, std::memory_order_release);
+		return &m_value;
+	}
+
+	ProfiledMutex m_mutex;
+	uint64_t m_retryIntervalNs;
+	uint64_t m_lastAttemptTime;
+
+	// Points to m_value once it has been filled in, and is never cleared.
+	std::atomic<const T*> m_published;
+	T m_value;
+};
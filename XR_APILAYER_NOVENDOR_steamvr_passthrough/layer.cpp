@@ -30,6 +30,9 @@
 #include "dashboard_menu.h"
 #include "openvr_manager.h"
 #include "depth_reconstruction.h"
+#include "trace.h"
+#include "perf_timeline.h"
+#include "handle_table.h"
 #include <log.h>
 #include <util.h>
 #include <map>
@@ -156,7 +159,7 @@ namespace
 
 
 			// Check that the SteamVR OpenXR runtime is being used.
-			if (m_configManager->GetConfig_Main().RequireSteamVRRuntime)
+			if (m_configManager->GetConfigSnapshot()->Main.RequireSteamVRRuntime)
 			{
 				XrInstanceProperties instanceProperties = { XR_TYPE_INSTANCE_PROPERTIES };
 				OpenXrApi::xrGetInstanceProperties(GetXrInstance(), &instanceProperties);
@@ -172,14 +175,14 @@ namespace
 			m_dashboardMenu = std::make_unique<DashboardMenu>(g_dllModule, m_configManager, m_openVRManager);
 
 
-			if (bEnableVarjoDepthExtension && m_configManager->GetConfig_Extensions().ExtVarjoDepthEstimation)
+			if (bEnableVarjoDepthExtension && m_configManager->GetConfigSnapshot()->Extensions.ExtVarjoDepthEstimation)
 			{
 				m_bVarjoDepthExtensionEnabled = true;
 				m_dashboardMenu->GetDisplayValues().bVarjoDepthEstimationExtensionActive = true;
 				Log("Extension XR_VARJO_environment_depth_estimation enabled\n");
 			}
 
-			if (bEnableVarjoCompositionExtension && m_configManager->GetConfig_Extensions().ExtVarjoDepthComposition)
+			if (bEnableVarjoCompositionExtension && m_configManager->GetConfigSnapshot()->Extensions.ExtVarjoDepthComposition)
 			{
 				m_bVarjoCompositionExtensionEnabled = true;
 				m_dashboardMenu->GetDisplayValues().bVarjoDepthCompositionExtensionActive = true;
@@ -270,8 +273,6 @@ namespace
 						return false;
 					}
 
-					m_depthReconstruction = std::make_shared<DepthReconstruction>(m_configManager, m_openVRManager, m_cameraManager);
-
 					m_dashboardMenu->GetDisplayValues().bSessionActive = true;
 					m_dashboardMenu->GetDisplayValues().renderAPI = DirectX11;
 					m_bDepthSupportedByRenderer = true;
@@ -288,7 +289,7 @@ namespace
 
 					ERenderAPI usedAPI = DirectX11;
 
-					if (m_configManager->GetConfig_Main().UseLegacyD3D12Renderer)
+					if (m_configManager->GetConfigSnapshot()->Main.UseLegacyD3D12Renderer)
 					{
 						m_Renderer = std::make_unique<PassthroughRendererDX12>(dx12bindings->device, dx12bindings->queue, g_dllModule, m_configManager);
 						usedAPI = DirectX12;
@@ -315,8 +316,6 @@ namespace
 						return false;
 					}
 					
-					m_depthReconstruction = std::make_shared<DepthReconstruction>(m_configManager, m_openVRManager, m_cameraManager);
-
 					m_dashboardMenu->GetDisplayValues().bSessionActive = true;
 					m_dashboardMenu->GetDisplayValues().renderAPI = DirectX12;
 					m_bDepthSupportedByRenderer = true;
@@ -348,8 +347,6 @@ namespace
 						return false;
 					}
 
-					m_depthReconstruction = std::make_shared<DepthReconstruction>(m_configManager, m_openVRManager, m_cameraManager);
-
 					m_dashboardMenu->GetDisplayValues().bSessionActive = true;
 					m_dashboardMenu->GetDisplayValues().renderAPI = Vulkan;
 					m_bDepthSupportedByRenderer = false;
@@ -400,7 +397,7 @@ namespace
 					{
 						Log("Passthrough API layer enabled for session\n");
 						m_bPassthroughAvailable = true;
-						m_bUsePassthrough = m_configManager->GetConfig_Main().EnablePassthrough;
+						m_bUsePassthrough = m_configManager->GetConfigSnapshot()->Main.EnablePassthrough;
 						m_dashboardMenu->GetDisplayValues().currentApplication = GetApplicationName();
 					}
 					else
@@ -423,6 +420,7 @@ namespace
 			if (isCurrentSession(session))
 			{
 				Log("Passthrough session ending...\n");
+				m_depthReconstruction.reset();
 				m_Renderer.reset();
 
 				if (m_cameraManager.get())
@@ -440,9 +438,6 @@ namespace
 				m_dashboardMenu->GetDisplayValues().depthBufferFormat = 0;
 				m_dashboardMenu->GetDisplayValues().frameBufferWidth = 0;
 				m_dashboardMenu->GetDisplayValues().frameBufferHeight = 0;
-				m_dashboardMenu->GetDisplayValues().frameToPhotonsLatencyMS = 0;
-				m_dashboardMenu->GetDisplayValues().frameToRenderLatencyMS = 0;
-				m_dashboardMenu->GetDisplayValues().renderTimeMS = 0;
 
 				m_dashboardMenu->GetDisplayValues().bCorePassthroughActive = false;
 				m_dashboardMenu->GetDisplayValues().CoreCurrentMode = 0;
@@ -477,13 +472,13 @@ namespace
 			bool additiveEnabled = false;
 			bool alphaEnabled = false;
 			unsigned numBlendModes = 1;
-			if (m_configManager->GetConfig_Core().CoreAdditive) 
+			if (m_configManager->GetConfigSnapshot()->Core.CoreAdditive) 
 			{ 
 				additiveEnabled = true;
 				numBlendModes++;
 			}
 
-			if (m_configManager->GetConfig_Core().CoreAlphaBlend)
+			if (m_configManager->GetConfigSnapshot()->Core.CoreAlphaBlend)
 			{
 				alphaEnabled = true;
 				numBlendModes++;
@@ -502,7 +497,7 @@ namespace
 				return XR_ERROR_SIZE_INSUFFICIENT;
 			}
 
-			int pref = m_configManager->GetConfig_Core().CorePreferredMode;
+			int pref = m_configManager->GetConfigSnapshot()->Core.CorePreferredMode;
 
 			if (pref == 3 && alphaEnabled)
 			{
@@ -562,7 +557,7 @@ namespace
 			XrResult result = OpenXrApi::xrCreateReferenceSpace(session, createInfo, space);
 			if (XR_SUCCEEDED(result))
 			{
-				m_refSpaces[*space] = *createInfo;
+				m_refSpaces.Insert(*space, *createInfo);
 			}
 
 			return result;
@@ -571,7 +566,7 @@ namespace
 
 		XrResult xrDestroySpace(XrSpace space)
 		{
-			m_refSpaces.erase(space);
+			m_refSpaces.Erase(space);
 
 			return OpenXrApi::xrDestroySpace(space);
 		}
@@ -582,7 +577,7 @@ namespace
 			XrResult result = OpenXrApi::xrCreateSwapchain(session, createInfo, swapchain);
 			if (XR_SUCCEEDED(result))
 			{
-				m_swapchainProperties[*swapchain] = *createInfo;
+				m_swapchainProperties.Insert(*swapchain, *createInfo);
 			}
 			return result;
 		}
@@ -590,6 +585,10 @@ namespace
 
 		XrResult xrDestroySwapchain(XrSwapchain swapchain)
 		{
+			m_swapchainProperties.Erase(swapchain);
+			m_acquiredSwapchains.Erase(swapchain);
+			m_heldSwapchains.Erase(swapchain);
+
 			return OpenXrApi::xrDestroySwapchain(swapchain);
 		}
 
@@ -602,18 +601,19 @@ namespace
 			}
 
 			// If the swapchain is held just act like it was reaquired.
-			auto It = m_heldSwapchains.find(swapchain);
-			if (It != m_heldSwapchains.end())
+			const uint32_t* heldIndex = m_heldSwapchains.Find(swapchain);
+			if (heldIndex)
 			{
-				m_heldSwapchains.erase(swapchain);
-				m_acquiredSwapchains[swapchain] = *index;
+				*index = *heldIndex;
+				m_acquiredSwapchains.Insert(swapchain, *heldIndex);
+				m_heldSwapchains.Erase(swapchain);
 				return XR_SUCCESS;
 			}
 
 			 XrResult result = OpenXrApi::xrAcquireSwapchainImage(swapchain, acquireInfo, index);
 			 if (XR_SUCCEEDED(result))
 			 {
-				 m_acquiredSwapchains[swapchain] = *index;
+				 m_acquiredSwapchains.Insert(swapchain, *index);
 				 //Log("Acquired: %i, %i\n", swapchain, *index);
 			 }
 			 else
@@ -633,13 +633,13 @@ namespace
 			}
 
 			// Delay releasing the swapchains until we can render the passthrough.
-			auto It = m_acquiredSwapchains.find(swapchain);
+			const uint32_t* acquiredIndex = m_acquiredSwapchains.Find(swapchain);
 
-			if (It != m_acquiredSwapchains.end())
+			if (acquiredIndex)
 			{
-				//Log("Held: %i, %i\n", swapchain, It->second);
-				m_heldSwapchains[swapchain] = It->second;
-				m_acquiredSwapchains.erase(It);
+				//Log("Held: %i, %i\n", swapchain, *acquiredIndex);
+				m_heldSwapchains.Insert(swapchain, *acquiredIndex);
+				m_acquiredSwapchains.Erase(swapchain);
 				return XR_SUCCESS;
 			}
 			else
@@ -654,7 +654,7 @@ namespace
 		{
 			if (isCurrentSession(session))
 			{
-				m_bUsePassthrough = m_bPassthroughAvailable && m_configManager->GetConfig_Main().EnablePassthrough;
+				m_bUsePassthrough = m_bPassthroughAvailable && m_configManager->GetConfigSnapshot()->Main.EnablePassthrough;
 			}
 
 			return OpenXrApi::xrBeginFrame(session, frameBeginInfo);
@@ -668,35 +668,35 @@ namespace
 
 			const XrSwapchain newSwapchain = layer->views[viewIndex].subImage.swapchain;
 
-			auto props = m_swapchainProperties.find(newSwapchain);
+			const XrSwapchainCreateInfo* props = m_swapchainProperties.Find(newSwapchain);
 
-			if (props == m_swapchainProperties.end())
+			if (!props)
 			{
 				return -1;
 			}
 
-			int64_t imageFormat = props->second.format;
+			int64_t imageFormat = props->format;
 
-			auto held = m_heldSwapchains.find(newSwapchain);
+			const uint32_t* held = m_heldSwapchains.Find(newSwapchain);
 
-			if (held == m_heldSwapchains.end())
+			if (!held)
 			{
 				return -1;
 			}
 
 			if (eye == LEFT_EYE)
 			{
-				m_dashboardMenu->GetDisplayValues().frameBufferFormat = props->second.format;
+				m_dashboardMenu->GetDisplayValues().frameBufferFormat = props->format;
 			}
 
-			int imageIndex = held->second;
+			int imageIndex = *held;
 
 			if (newSwapchain == *storedSwapchain)
 			{
 				return imageIndex;
 			}
 
-			Log("Updating swapchain %u to %u with eye %u, index %u, arraySize %u\n", *storedSwapchain, newSwapchain, eye, imageIndex, props->second.arraySize);
+			Log("Updating swapchain %u to %u with eye %u, index %u, arraySize %u\n", *storedSwapchain, newSwapchain, eye, imageIndex, props->arraySize);
 
 			XrSwapchainImageD3D12KHR swapchainImages[3];
 			uint32_t numImages = 0;
@@ -706,7 +706,7 @@ namespace
 			{
 				for (uint32_t i = 0; i < numImages; i++)
 				{
-					m_Renderer->InitRenderTarget(eye, swapchainImages[i].texture, i, props->second);
+					m_Renderer->InitRenderTarget(eye, swapchainImages[i].texture, i, *props);
 				}
 				*storedSwapchain = newSwapchain;
 			}
@@ -716,7 +716,7 @@ namespace
 				return -1;
 			}
 
-			if (!m_configManager->GetConfig_Depth().DepthReadFromApplication)
+			if (!m_configManager->GetConfigSnapshot()->Depth.DepthReadFromApplication)
 			{
 				return imageIndex;
 			}
@@ -735,16 +735,16 @@ namespace
 
 			if (depthInfo != nullptr)
 			{
-				auto depthProps = m_swapchainProperties.find(depthInfo->subImage.swapchain);
+				const XrSwapchainCreateInfo* depthProps = m_swapchainProperties.Find(depthInfo->subImage.swapchain);
 
-				if (depthProps != m_swapchainProperties.end())
+				if (depthProps)
 				{
 					if (eye == LEFT_EYE)
 					{
-						m_dashboardMenu->GetDisplayValues().depthBufferFormat = depthProps->second.format;
+						m_dashboardMenu->GetDisplayValues().depthBufferFormat = depthProps->format;
 					}
 
-					Log("Found depth swapchain %u for color swapchain %u, arraySize %u, depth range [%f:%f], Z-range[%g:%g]\n", depthInfo->subImage.swapchain, newSwapchain, depthProps->second.arraySize, depthInfo->minDepth, depthInfo->maxDepth, depthInfo->nearZ, depthInfo->farZ);
+					Log("Found depth swapchain %u for color swapchain %u, arraySize %u, depth range [%f:%f], Z-range[%g:%g]\n", depthInfo->subImage.swapchain, newSwapchain, depthProps->arraySize, depthInfo->minDepth, depthInfo->maxDepth, depthInfo->nearZ, depthInfo->farZ);
 
 					XrSwapchainImageD3D12KHR depthImages[3];
 					numImages = 0;
@@ -754,7 +754,7 @@ namespace
 					{
 						for (uint32_t i = 0; i < numImages; i++)
 						{
-							m_Renderer->InitDepthBuffer(eye, depthImages[i].texture, i, depthProps->second);
+							m_Renderer->InitDepthBuffer(eye, depthImages[i].texture, i, *depthProps);
 						}
 					}
 					else
@@ -770,7 +770,8 @@ namespace
 
 		bool IsBlendModeEnabled(XrEnvironmentBlendMode blendMode, const XrCompositionLayerProjection* layer)
 		{
-			Config_Core& conf = m_configManager->GetConfig_Core();
+			std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+			const Config_Core& conf = config->Core;
 			if (conf.CorePassthroughEnable)
 			{
 				if (conf.CoreForcePassthrough) { return true; }
@@ -798,7 +799,7 @@ namespace
 			std::string pathStr = path;
 			std::string imgPath = pathStr.substr(0, pathStr.find_last_of("/\\")) + "\\testpattern.png";
 
-			std::lock_guard<std::mutex> writelock(texture.RWMutex);
+			std::lock_guard<ProfiledMutex> writelock(texture.RWMutex);
 			
 			if (texture.CurrentTexture != DebugTexture_TestImage)
 			{
@@ -827,6 +828,8 @@ namespace
 
 		void RenderPassthroughOnAppLayer(const XrFrameEndInfo* frameEndInfo, uint32_t layerNum)
 		{
+			TraceSpan span("RenderPassthroughOnAppLayer");
+
 			XrCompositionLayerProjection* layer = (XrCompositionLayerProjection*)frameEndInfo->layers[layerNum];
 			std::shared_ptr<CameraFrame> frame;
 
@@ -834,30 +837,40 @@ namespace
 			m_dashboardMenu->GetDisplayValues().frameBufferWidth = layer->views[0].subImage.imageRect.extent.width;
 			m_dashboardMenu->GetDisplayValues().frameBufferFlags = layer->layerFlags;
 
-			if (!m_cameraManager->GetCameraFrame(frame))
+			// Created on the first passthrough frame, so sessions that never show passthrough don't start the reconstruction thread.
+			// The camera projections are then built in the background.
+			if (!m_depthReconstruction)
+			{
+				m_depthReconstruction = std::make_shared<DepthReconstruction>(m_configManager, m_openVRManager, m_cameraManager);
+			}
+
+			if (!m_depthReconstruction->IsDistortionReady() || !m_cameraManager->GetCameraFrame(frame))
 			{
 				return;
 			}
 
 			std::shared_lock readLock(frame->readWriteMutex);
 
+			span.SetFrame(frame->header.nFrameSequence);
+
+			uint64_t preRenderTime = GetMonotonicTimeNs();
+			uint64_t exposureTime = PerfCounterToNs(frame->header.ulFrameExposureTime);
 
-			LARGE_INTEGER preRenderTime = StartPerfTimer();
+			m_frameToRenderTimer.RecordSince(exposureTime);
 
-			float frameToRenderTime = GetPerfTimerDiff(frame->header.ulFrameExposureTime, preRenderTime.QuadPart);
-			m_dashboardMenu->GetDisplayValues().frameToRenderLatencyMS = UpdateAveragePerfTime(m_frameToRenderTimes, frameToRenderTime, 20);
+			LARGE_INTEGER displayTimeQPC;
 
-			LARGE_INTEGER displayTime;
+			OpenXrApi::xrConvertTimeToWin32PerformanceCounterKHR(m_currentInstance, frameEndInfo->displayTime, &displayTimeQPC);
 
-			OpenXrApi::xrConvertTimeToWin32PerformanceCounterKHR(m_currentInstance, frameEndInfo->displayTime, &displayTime);
+			uint64_t displayTime = PerfCounterToNs(displayTimeQPC.QuadPart);
 
-			float frameToPhotonsTime = GetPerfTimerDiff(frame->header.ulFrameExposureTime, displayTime.QuadPart);
-			m_dashboardMenu->GetDisplayValues().frameToPhotonsLatencyMS = UpdateAveragePerfTime(m_frameToPhotonTimes, frameToPhotonsTime, 20);
+			m_frameToPhotonsTimer.Record(displayTime > exposureTime ? displayTime - exposureTime : 0);
 
 
-			float timeToPhotons = GetPerfTimerDiff(preRenderTime.QuadPart, displayTime.QuadPart);
+			float timeToPhotons = (float)((double)(int64_t)(displayTime - preRenderTime) / 1000000.0);
 			
-			m_cameraManager->CalculateFrameProjection(frame, *layer, timeToPhotons, m_refSpaces[layer->space], m_depthReconstruction->GetDistortionParameters());
+			const XrReferenceSpaceCreateInfo* refSpaceInfo = m_refSpaces.Find(layer->space);
+			m_cameraManager->CalculateFrameProjection(frame, *layer, timeToPhotons, refSpaceInfo ? *refSpaceInfo : XrReferenceSpaceCreateInfo{}, m_depthReconstruction->GetDistortionParameters());
 	
 
 			int leftIndex = UpdateSwapchains(LEFT_EYE, layer);
@@ -865,9 +878,11 @@ namespace
 
 			EPassthroughBlendMode blendMode = (EPassthroughBlendMode)frameEndInfo->environmentBlendMode;
 
-			if (m_configManager->GetConfig_Core().CoreForcePassthrough && m_configManager->GetConfig_Core().CoreForceMode >= 0)
+			std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+
+			if (config->Core.CoreForcePassthrough && config->Core.CoreForceMode >= 0)
 			{
-				blendMode = (EPassthroughBlendMode)m_configManager->GetConfig_Core().CoreForceMode;
+				blendMode = (EPassthroughBlendMode)config->Core.CoreForceMode;
 			}
 
 			if (blendMode == AlphaBlendPremultiplied && layer->layerFlags & XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT)
@@ -875,13 +890,13 @@ namespace
 				blendMode = AlphaBlendUnpremultiplied;
 			}
 
-			if (m_configManager->GetConfig_Main().DebugTexture == DebugTexture_TestImage &&
+			if (config->Main.DebugTexture == DebugTexture_TestImage &&
 				m_configManager->GetDebugTexture().CurrentTexture != DebugTexture_TestImage)
 			{
 				GetTestPattern(m_configManager->GetDebugTexture());
 			}
 			
-			Config_Depth& depthConf = m_configManager->GetConfig_Depth();
+			const Config_Depth& depthConf = config->Depth;
 
 			std::shared_ptr<DepthFrame> depthFrame = m_depthReconstruction->GetDepthFrame();
 
@@ -936,11 +951,10 @@ namespace
 			m_Renderer->RenderPassthroughFrame(layer, frame.get(), blendMode, leftIndex, rightIndex, depthFrame, m_depthReconstruction->GetDistortionParameters(), renderParams);
 
 
-			float renderTime = EndPerfTimer(preRenderTime.QuadPart);
-			m_dashboardMenu->GetDisplayValues().renderTimeMS = UpdateAveragePerfTime(m_passthroughRenderTimes, renderTime, 20);
-
-			m_dashboardMenu->GetDisplayValues().stereoReconstructionTimeMS = m_depthReconstruction->GetReconstructionPerfTime();
-			m_dashboardMenu->GetDisplayValues().frameRetrievalTimeMS = m_cameraManager->GetFrameRetrievalPerfTime();
+			uint64_t postRenderTime = GetMonotonicTimeNs();
+			m_passthroughRenderTimer.Record(postRenderTime - preRenderTime);
+			PerfTimeline::Get().Record(PerfTimeline_PassthroughRender, postRenderTime, postRenderTime - preRenderTime);
+			m_renderedFramesCounter.Add();
 		}
 
 
@@ -951,6 +965,14 @@ namespace
 				return OpenXrApi::xrEndFrame(session, frameEndInfo);
 			}
 
+			TraceSpan span("xrEndFrame");
+			uint64_t startTime = GetMonotonicTimeNs();
+
+			if (m_lastEndFrameTime != 0)
+			{
+				PerfTimeline::Get().Record(PerfTimeline_AppFramePeriod, startTime, startTime - m_lastEndFrameTime);
+			}
+			m_lastEndFrameTime = startTime;
 
 			XrResult result;
 
@@ -973,22 +995,27 @@ namespace
 					}
 				}
 
-				for (const auto& It : m_heldSwapchains)
+				m_heldSwapchains.ForEach([this](XrSwapchain swapchain, uint32_t imageIndex)
 				{
-					result = OpenXrApi::xrReleaseSwapchainImage(It.first, nullptr);
-					if (XR_FAILED(result))
+					XrResult releaseResult = OpenXrApi::xrReleaseSwapchainImage(swapchain, nullptr);
+					if (XR_FAILED(releaseResult))
 					{
-						ErrorLog("Error in xrReleaseSwapchainImage: %i\n", result);
+						ErrorLog("Error in xrReleaseSwapchainImage: %i\n", releaseResult);
 					}
-					//Log("Released: %i, %i\n", It.first, It.second);
-				}
+					//Log("Released: %i, %i\n", swapchain, imageIndex);
+				});
 
-				m_heldSwapchains.clear();
+				m_heldSwapchains.Clear();
 			}
 
 			XrFrameEndInfo modifiedFrameEndInfo = *frameEndInfo;
 			modifiedFrameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
 
+			// Time the layer adds to the frame submission, excluding the runtime xrEndFrame call.
+			uint64_t overheadEndTime = GetMonotonicTimeNs();
+			m_endFrameOverheadTimer.Record(overheadEndTime - startTime);
+			PerfTimeline::Get().Record(PerfTimeline_LayerEndFrameOverhead, overheadEndTime, overheadEndTime - startTime);
+
 			result = OpenXrApi::xrEndFrame(session, &modifiedFrameEndInfo);
 			return result;
 		}
@@ -1002,12 +1029,12 @@ namespace
 				return XR_ERROR_RUNTIME_FAILURE;
 			}
 
-			if (m_bDepthSupportedByRenderer && m_configManager->GetConfig_Extensions().ExtVarjoDepthEstimation && enabled)
+			if (m_bDepthSupportedByRenderer && m_configManager->GetConfigSnapshot()->Extensions.ExtVarjoDepthEstimation && enabled)
 			{
 				m_bVarjoDepthEnabled = true;
 				return XR_SUCCESS;
 			}
-			else if ((!m_bDepthSupportedByRenderer || !m_configManager->GetConfig_Extensions().ExtVarjoDepthEstimation) && enabled)
+			else if ((!m_bDepthSupportedByRenderer || !m_configManager->GetConfigSnapshot()->Extensions.ExtVarjoDepthEstimation) && enabled)
 			{
 				if (!m_bDepthSupportedByRenderer)
 				{
@@ -1049,14 +1076,18 @@ namespace
 		XrSwapchain m_swapChainLeft{XR_NULL_HANDLE};
 		XrSwapchain m_swapChainRight{XR_NULL_HANDLE};
 
-		std::map<XrSpace, XrReferenceSpaceCreateInfo> m_refSpaces{};
-		std::map<XrSwapchain, XrSwapchainCreateInfo> m_swapchainProperties{};
-		std::map<XrSwapchain, uint32_t> m_acquiredSwapchains{};
-		std::map<XrSwapchain, uint32_t> m_heldSwapchains{};
-
-		std::deque<float> m_frameToRenderTimes;
-		std::deque<float> m_frameToPhotonTimes;
-		std::deque<float> m_passthroughRenderTimes;
+		// Looked up on every frame, so kept in tables that don't allocate once they have grown to fit the live handles.
+		HandleTable<XrSpace, XrReferenceSpaceCreateInfo> m_refSpaces;
+		HandleTable<XrSwapchain, XrSwapchainCreateInfo> m_swapchainProperties;
+		HandleTable<XrSwapchain, uint32_t> m_acquiredSwapchains;
+		HandleTable<XrSwapchain, uint32_t> m_heldSwapchains;
+
+		MetricTimer& m_frameToRenderTimer = MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_TO_RENDER);
+		MetricTimer& m_frameToPhotonsTimer = MetricsRegistry::Get().GetTimer(METRIC_TIMER_FRAME_TO_PHOTONS);
+		MetricTimer& m_passthroughRenderTimer = MetricsRegistry::Get().GetTimer(METRIC_TIMER_PASSTHROUGH_RENDER);
+		MetricCounter& m_renderedFramesCounter = MetricsRegistry::Get().GetCounter(METRIC_COUNTER_RENDERED_FRAMES);
+		MetricTimer& m_endFrameOverheadTimer = MetricsRegistry::Get().GetTimer(METRIC_TIMER_END_FRAME_OVERHEAD);
+		uint64_t m_lastEndFrameTime = 0;
 
     };
 
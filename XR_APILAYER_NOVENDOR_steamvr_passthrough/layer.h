@@ -24,6 +24,8 @@
 
 #include "framework/dispatch.gen.h"
 #include "mesh.h"
+#include "metrics.h"
+#include "profiled_mutex.h"
 
 namespace steamvr_passthrough
 {
@@ -78,7 +80,7 @@ struct RenderModel
 	{
 	}
 
-	RenderModel(uint32_t id, std::string name, Mesh<VertexFormatBasic> inMesh)
+	RenderModel(uint32_t id, std::string name, std::shared_ptr<const Mesh<VertexFormatBasic>> inMesh)
 		: deviceId(id)
 		, modelName(name)
 		, mesh(inMesh)
@@ -88,14 +90,14 @@ struct RenderModel
 
 	uint32_t deviceId;
 	std::string modelName;
-	Mesh<VertexFormatBasic> mesh;
+	std::shared_ptr<const Mesh<VertexFormatBasic>> mesh; // Shared with the render model cache, never modified.
 	XrMatrix4x4f meshToWorldTransform;
 };
 
 struct CameraFrame
 {
 	CameraFrame()
-		: readWriteMutex()
+		: readWriteMutex("CameraFrame")
 		, header()
 		, frameTextureResource(nullptr)
 		, cameraViewToWorldLeft()
@@ -122,7 +124,7 @@ struct CameraFrame
 	{
 	}
 
-	std::shared_mutex readWriteMutex;
+	ProfiledSharedMutex readWriteMutex;
 	vr::CameraVideoStreamFrameHeader_t header;
 	void* frameTextureResource;
 	std::shared_ptr<std::vector<uint8_t>> frameBuffer;
@@ -157,22 +159,26 @@ struct CameraFrame
 struct DepthFrame
 {
 	DepthFrame()
-		: readWriteMutex()
+		: readWriteMutex("DepthFrame")
 		, disparityViewToWorldLeft()
 		, disparityViewToWorldRight()
 		, disparityToDepth()
+		, generation(0)
 		, bIsValid(false)
 	{
 		disparityMap = std::make_shared<std::vector<uint16_t>>();
 	}
 
-	std::shared_mutex readWriteMutex;
+	ProfiledSharedMutex readWriteMutex;
 	std::shared_ptr<std::vector<uint16_t>> disparityMap;
 	XrMatrix4x4f disparityViewToWorldLeft;
 	XrMatrix4x4f disparityViewToWorldRight;
 	XrMatrix4x4f disparityToDepth;
 	uint32_t disparityTextureSize[2];
 	float disparityDownscaleFactor;
+
+	// Incremented for every reconstructed frame, so renderers can tell whether the contents have changed.
+	uint64_t generation;
 	bool bIsValid;
 };
 
@@ -187,7 +193,7 @@ struct FrameRenderParameters
 struct UVDistortionParameters
 {
 	UVDistortionParameters()
-		: readWriteMutex()
+		: readWriteMutex("UVDistortion")
 		, cameraProjectionLeft()
 		, cameraProjectionRight()
 		, rectifiedRotationLeft()
@@ -196,7 +202,7 @@ struct UVDistortionParameters
 	{
 	}
 
-	std::shared_mutex readWriteMutex;
+	ProfiledSharedMutex readWriteMutex;
 	std::shared_ptr<std::vector<float>> uvDistortionMap;
 	XrMatrix4x4f cameraProjectionLeft;
 	XrMatrix4x4f cameraProjectionRight;
@@ -254,67 +260,18 @@ struct DeviceDebugProperties
 #define NEAR_PROJECTION_DISTANCE 0.05f
 
 
-// Profiling functions
-
-inline LARGE_INTEGER StartPerfTimer()
-{
-	LARGE_INTEGER startTime;	
-	QueryPerformanceCounter(&startTime);
-	return startTime;
-}
-
-inline float EndPerfTimer(LARGE_INTEGER startTime)
-{
-	LARGE_INTEGER endTime, perfFrequency;
-
-	QueryPerformanceCounter(&endTime);
-	QueryPerformanceFrequency(&perfFrequency);
-
-	float perfTime = (float)(endTime.QuadPart - startTime.QuadPart);
-	perfTime *= 1000.0f;
-	perfTime /= perfFrequency.QuadPart;
-	return perfTime;
-}
-
-inline float EndPerfTimer(uint64_t startTimeQuadPart)
-{
-	LARGE_INTEGER endTime, perfFrequency;
-
-	QueryPerformanceCounter(&endTime);
-	QueryPerformanceFrequency(&perfFrequency);
-
-	float perfTime = (float)(endTime.QuadPart - startTimeQuadPart);
-	perfTime *= 1000.0f;
-	perfTime /= perfFrequency.QuadPart;
-	return perfTime;
-}
-
-inline float GetPerfTimerDiff(uint64_t startTimeQuadPart, uint64_t endTimeQuadPart)
-{
-	LARGE_INTEGER perfFrequency;
-
-	QueryPerformanceFrequency(&perfFrequency);
-
-	float perfTime = (float)(endTimeQuadPart - startTimeQuadPart);
-	perfTime *= 1000.0f;
-	perfTime /= perfFrequency.QuadPart;
-	return perfTime;
-}
-
-inline float UpdateAveragePerfTime(std::deque<float>& times, float newTime, int numAverages)
+// Converts a QueryPerformanceCounter timestamp, as used by OpenVR frame headers, to the metrics clock.
+// The MSVC steady_clock is based on the performance counter, so the timelines match.
+inline uint64_t PerfCounterToNs(uint64_t perfCounter)
 {
-	if (times.size() >= numAverages)
+	static const uint64_t perfFrequency = []()
 	{
-		times.pop_front();
-	}
-
-	times.push_back(newTime);
-
-	float average = 0;
-
-	for (const float& val : times)
-	{
-		average += val;
-	}
-	return average / times.size();
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		return (uint64_t)freq.QuadPart;
+	}();
+
+	uint64_t whole = (perfCounter / perfFrequency) * 1000000000ull;
+	uint64_t part = (perfCounter % perfFrequency) * 1000000000ull / perfFrequency;
+	return whole + part;
 }
\ No newline at end of file
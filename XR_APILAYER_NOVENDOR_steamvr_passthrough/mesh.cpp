@@ -1,10 +1,21 @@
 
 #include "pch.h"
 #include "mesh.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <log.h>
+#include "metrics.h"
+
+using namespace steamvr_passthrough::log;
 
 
 #define BORDER_SIZE 3
 
+// Cells per strip in the grid triangle order, sized so two rows of strip vertices fit the cache.
+#define MESH_GRID_STRIP_WIDTH (MESH_VERTEX_CACHE_SIZE / 2 - 1)
+
+#define MESH_GRID_CACHE_SIZE 4
+
 // Generate a cylinder with radius and height 1.
 void MeshCreateCylinder(Mesh<VertexFormatBasic>& mesh, int numBoundaryVertices)
 {
@@ -41,6 +52,53 @@ void MeshCreateCylinder(Mesh<VertexFormatBasic>& mesh, int numBoundaryVertices)
 }
 
 
+// Weight of the grid vertices within BORDER_SIZE of the edge, ramping up to 1 at the edge.
+static float GridBorderWeight(int x, int y, int width, int height)
+{
+	if (x < BORDER_SIZE || x >= (width - BORDER_SIZE) || y < BORDER_SIZE || y >= (height - BORDER_SIZE))
+	{
+		float size = (float)BORDER_SIZE;
+
+		float low = fmaxf((size - x) / size, (size - y) / size);
+		float high = -fmin(0.0f, fminf((width - size - x - 1) / size, (height - size - y - 1) / size));
+
+		return fmaxf(low, high);
+	}
+
+	return 0.0f;
+}
+
+
+// Adds the grid triangles in vertical strips of cells. The strips are narrow enough that the vertices
+// shared with the previous row are still in the post-transform cache, and only vertices on strip edges are shaded twice.
+static void MeshAddGridTriangles(Mesh<VertexFormatBasic>& mesh, int width, int height, bool bHexagon)
+{
+	for (int stripStart = 0; stripStart < width - 1; stripStart += MESH_GRID_STRIP_WIDTH)
+	{
+		int stripEnd = std::min(stripStart + MESH_GRID_STRIP_WIDTH, width - 1);
+
+		for (int y = 0; y < height - 1; y++)
+		{
+			for (int x = stripStart; x < stripEnd; x++)
+			{
+				uint32_t index = y * width + x;
+
+				if (bHexagon && y % 2 == 0)
+				{
+					mesh.triangles.emplace_back(index, index + 1, index + width);
+					mesh.triangles.emplace_back(index + 1, index + width + 1, index + width);
+				}
+				else
+				{
+					mesh.triangles.emplace_back(index, index + 1, index + width + 1);
+					mesh.triangles.emplace_back(index, index + width + 1, index + width);
+				}
+			}
+		}
+	}
+}
+
+
 void MeshCreateGrid(Mesh<VertexFormatBasic>& mesh, int width, int height)
 {
 	mesh.vertices.resize(0);
@@ -51,38 +109,18 @@ void MeshCreateGrid(Mesh<VertexFormatBasic>& mesh, int width, int height)
 	float stepX = 1.0f / (float)width;
 	float stepY = 1.0f / (float)height;
 
-	uint32_t index = 0;
-
 	for (int y = 0; y < height; y++)
 	{
 		for (int x = 0; x < width; x++)
 		{
 			// Mark border vertices
-			float z = 0.0f;
-				
-			if (x < BORDER_SIZE || x >= (width - BORDER_SIZE) || y < BORDER_SIZE || y >= (height - BORDER_SIZE))
-			{
-				float size = (float)BORDER_SIZE;
-
-				float low = fmaxf((size - x) / size, (size - y) / size);
-				float high = -fmin(0.0f, fminf((width - size - x - 1) / size, (height - size - y - 1) / size));
-
-				z = fmaxf(low, high);
-			}
-
-			//float z = (x < BORDER_SIZE || x >= (width - BORDER_SIZE) || y < BORDER_SIZE || y >= (height - BORDER_SIZE)) ? 1.0f : 0.0f;
+			float z = GridBorderWeight(x, y, width, height);
 
 			mesh.vertices.emplace_back(x * stepX, y * stepY, z);
-
-			if (x < width - 1 && y < height -1 )
-			{
-				mesh.triangles.emplace_back(index, index + 1, index + width + 1);
-				mesh.triangles.emplace_back(index, index + width + 1, index + width);
-			}
-
-			index++;
 		}
 	}
+
+	MeshAddGridTriangles(mesh, width, height, false);
 }
 
 
@@ -96,49 +134,25 @@ void MeshCreateHexGrid(Mesh<VertexFormatBasic>& mesh, int width, int height)
 	float stepX = 1.0f / (float)width;
 	float stepY = 1.0f / (float)height;
 
-	uint32_t index = 0;
-
 	for (int y = 0; y < height; y++)
 	{
 		for (int x = 0; x < width; x++)
 		{
 			// Mark border vertices
-			float z = 0.0f;
-
-			if (x < BORDER_SIZE || x >= (width - BORDER_SIZE) || y < BORDER_SIZE || y >= (height - BORDER_SIZE))
-			{
-				float size = (float)BORDER_SIZE;
-
-				float low = fmaxf((size - x) / size, (size - y) / size);
-				float high = -fmin(0.0f, fminf((width - size - x - 1) / size, (height - size - y - 1) / size));
-
-				z = fmaxf(low, high);
-			}
+			float z = GridBorderWeight(x, y, width, height);
 
 			if (y % 2 == 0)
 			{
 				mesh.vertices.emplace_back(x * stepX, y * stepY, z);
-
-				if (x < width - 1 && y < height - 1)
-				{
-					mesh.triangles.emplace_back(index, index + 1, index + width);
-					mesh.triangles.emplace_back(index + 1, index + width + 1, index + width);
-				}
 			}
 			else
 			{
 				mesh.vertices.emplace_back(x * stepX + 0.5 * stepX, y * stepY, z);
-
-				if (x < width - 1 && y < height - 1)
-				{
-					mesh.triangles.emplace_back(index, index + 1, index + width + 1);
-					mesh.triangles.emplace_back(index, index + width + 1, index + width);
-				}
 			}
-
-			index++;
 		}
 	}
+
+	MeshAddGridTriangles(mesh, width, height, true);
 }
 
 void MeshCreateRenderModel(Mesh<VertexFormatBasic>& mesh, vr::RenderModel_t* renderModel)
@@ -146,17 +160,425 @@ void MeshCreateRenderModel(Mesh<VertexFormatBasic>& mesh, vr::RenderModel_t* ren
 	mesh.vertices.resize(renderModel->unVertexCount);
 	mesh.triangles.resize(renderModel->unTriangleCount);
 
-	for (int i = 0; i < renderModel->unVertexCount; i++)
+	for (uint32_t i = 0; i < renderModel->unVertexCount; i++)
 	{
 		mesh.vertices[i].position[0] = renderModel->rVertexData[i].vPosition.v[0];
 		mesh.vertices[i].position[1] = renderModel->rVertexData[i].vPosition.v[1];
 		mesh.vertices[i].position[2] = renderModel->rVertexData[i].vPosition.v[2];
 	}
 
-	for (int i = 0; i < renderModel->unTriangleCount; i++)
+	for (uint32_t i = 0; i < renderModel->unTriangleCount; i++)
 	{
 		mesh.triangles[i].a = renderModel->rIndexData[i * 3];
 		mesh.triangles[i].b = renderModel->rIndexData[i * 3 + 1];
 		mesh.triangles[i].c = renderModel->rIndexData[i * 3 + 2];
 	}
-}
\ No newline at end of file
+}
+
+
+// Simplifies the mesh to at most maxTriangles by merging the vertices in each cell of a uniform grid.
+// The grid is coarsened until the result fits the budget.
+void MeshDecimate(Mesh<VertexFormatBasic>& mesh, uint32_t maxTriangles)
+{
+	if (maxTriangles == 0 || mesh.triangles.size() <= maxTriangles || mesh.vertices.empty())
+	{
+		return;
+	}
+
+	float boundsMin[3] = { mesh.vertices[0].position[0], mesh.vertices[0].position[1], mesh.vertices[0].position[2] };
+	float boundsMax[3] = { boundsMin[0], boundsMin[1], boundsMin[2] };
+
+	for (const VertexFormatBasic& vertex : mesh.vertices)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+			boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+		}
+	}
+
+	float extent = std::max(boundsMax[0] - boundsMin[0], std::max(boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]));
+
+	if (extent <= 0.0f)
+	{
+		return;
+	}
+
+	Mesh<VertexFormatBasic> output;
+	std::unordered_map<uint64_t, uint32_t> cellToCluster;
+	std::unordered_set<uint64_t> usedTriangles;
+	std::vector<uint32_t> vertexToCluster(mesh.vertices.size());
+	std::vector<uint32_t> clusterSize;
+
+	// A closed surface on an N^3 grid has roughly N^2 triangles per side, so start near the budget.
+	int resolution = std::max((int)sqrtf((float)maxTriangles), 2);
+
+	while (true)
+	{
+		float cellScale = (float)resolution / extent;
+
+		output.vertices.clear();
+		output.triangles.clear();
+		cellToCluster.clear();
+		usedTriangles.clear();
+		clusterSize.clear();
+
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			const float* position = mesh.vertices[i].position;
+			uint64_t cellX = (uint64_t)std::min((int)((position[0] - boundsMin[0]) * cellScale), resolution);
+			uint64_t cellY = (uint64_t)std::min((int)((position[1] - boundsMin[1]) * cellScale), resolution);
+			uint64_t cellZ = (uint64_t)std::min((int)((position[2] - boundsMin[2]) * cellScale), resolution);
+			uint64_t cell = cellX | (cellY << 21) | (cellZ << 42);
+
+			auto result = cellToCluster.try_emplace(cell, (uint32_t)output.vertices.size());
+			uint32_t cluster = result.first->second;
+
+			if (result.second)
+			{
+				output.vertices.emplace_back(0.0f, 0.0f, 0.0f);
+				clusterSize.push_back(0);
+			}
+
+			output.vertices[cluster].position[0] += position[0];
+			output.vertices[cluster].position[1] += position[1];
+			output.vertices[cluster].position[2] += position[2];
+			clusterSize[cluster]++;
+			vertexToCluster[i] = cluster;
+		}
+
+		for (size_t i = 0; i < output.vertices.size(); i++)
+		{
+			float scale = 1.0f / (float)clusterSize[i];
+			output.vertices[i].position[0] *= scale;
+			output.vertices[i].position[1] *= scale;
+			output.vertices[i].position[2] *= scale;
+		}
+
+		for (const MeshTriangle& triangle : mesh.triangles)
+		{
+			uint32_t a = vertexToCluster[triangle.a];
+			uint32_t b = vertexToCluster[triangle.b];
+			uint32_t c = vertexToCluster[triangle.c];
+
+			if (a == b || b == c || a == c)
+			{
+				continue;
+			}
+
+			// Drop duplicates of the same winding, rotated so the smallest index is first.
+			uint64_t first = std::min(a, std::min(b, c));
+			uint64_t key = (first == a) ? ((uint64_t)a << 42 | (uint64_t)b << 21 | c) :
+				(first == b) ? ((uint64_t)b << 42 | (uint64_t)c << 21 | a) :
+				((uint64_t)c << 42 | (uint64_t)a << 21 | b);
+
+			if (usedTriangles.insert(key).second)
+			{
+				output.triangles.emplace_back(a, b, c);
+			}
+		}
+
+		if (output.triangles.size() <= maxTriangles || resolution <= 1)
+		{
+			break;
+		}
+
+		resolution = std::min(resolution * 3 / 4, resolution - 1);
+	}
+
+	mesh = std::move(output);
+}
+
+
+// Simulates a FIFO post-transform vertex cache over the triangle list.
+MeshCacheStats MeshCalculateCacheStats(const Mesh<VertexFormatBasic>& mesh, uint32_t cacheSize)
+{
+	MeshCacheStats stats{};
+
+	if (mesh.triangles.empty() || mesh.vertices.empty() || cacheSize == 0)
+	{
+		return stats;
+	}
+
+	std::vector<uint32_t> cache(cacheSize, UINT32_MAX);
+	std::vector<bool> usedVertices(mesh.vertices.size(), false);
+	uint32_t cachePosition = 0;
+	uint32_t numTransforms = 0;
+	uint32_t numUsedVertices = 0;
+
+	auto accessVertex = [&](uint32_t vertex)
+	{
+		if (std::find(cache.begin(), cache.end(), vertex) != cache.end())
+		{
+			return;
+		}
+
+		cache[cachePosition] = vertex;
+		cachePosition = (cachePosition + 1) % cacheSize;
+		numTransforms++;
+
+		if (!usedVertices[vertex])
+		{
+			usedVertices[vertex] = true;
+			numUsedVertices++;
+		}
+	};
+
+	for (const MeshTriangle& triangle : mesh.triangles)
+	{
+		accessVertex(triangle.a);
+		accessVertex(triangle.b);
+		accessVertex(triangle.c);
+	}
+
+	stats.acmr = (float)numTransforms / (float)mesh.triangles.size();
+	stats.atvr = (float)numTransforms / (float)numUsedVertices;
+
+	return stats;
+}
+
+
+static std::shared_ptr<const GridMesh> MeshBuildGrid(int width, int height, bool bHexagon)
+{
+	uint64_t startTime = GetMonotonicTimeNs();
+
+	Mesh<VertexFormatBasic> mesh;
+	bHexagon ? MeshCreateHexGrid(mesh, width, height) : MeshCreateGrid(mesh, width, height);
+
+	std::shared_ptr<GridMesh> gridMesh = std::make_shared<GridMesh>();
+	gridMesh->width = width;
+	gridMesh->height = height;
+	gridMesh->bHexagon = bHexagon;
+	gridMesh->numIndices = (uint32_t)mesh.triangles.size() * 3;
+
+	if (mesh.vertices.size() <= UINT16_MAX)
+	{
+		gridMesh->indices16.reserve(gridMesh->numIndices);
+
+		for (const MeshTriangle& triangle : mesh.triangles)
+		{
+			gridMesh->indices16.push_back((uint16_t)triangle.a);
+			gridMesh->indices16.push_back((uint16_t)triangle.b);
+			gridMesh->indices16.push_back((uint16_t)triangle.c);
+		}
+	}
+	else
+	{
+		gridMesh->indices32.resize(gridMesh->numIndices);
+		memcpy(gridMesh->indices32.data(), mesh.triangles.data(), gridMesh->numIndices * sizeof(uint32_t));
+	}
+
+	gridMesh->cacheStats = MeshCalculateCacheStats(mesh, MESH_VERTEX_CACHE_SIZE);
+	gridMesh->vertices = std::move(mesh.vertices);
+
+	uint64_t buildTime = GetMonotonicTimeNs() - startTime;
+	MetricsRegistry::Get().GetTimer(METRIC_TIMER_GRID_MESH_BUILD).Record(buildTime);
+
+	Log("Built %s grid mesh %ix%i: %u triangles, %s indices, ACMR %.3f, ATVR %.3f, %.2f ms\n", bHexagon ? "hexagon" : "square", width, height,
+		gridMesh->numIndices / 3, gridMesh->Uses16BitIndices() ? "16-bit" : "32-bit", gridMesh->cacheStats.acmr, gridMesh->cacheStats.atvr, NsToMS(buildTime));
+
+	return gridMesh;
+}
+
+
+std::shared_ptr<const GridMesh> MeshGetGrid(int width, int height, bool bHexagon)
+{
+	// Recently used grids are kept so switching settings back and forth, or between renderers, does not rebuild them.
+	static std::mutex cacheMutex;
+	static std::deque<std::shared_ptr<const GridMesh>> cache;
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	for (auto it = cache.begin(); it != cache.end(); it++)
+	{
+		if ((*it)->width == width && (*it)->height == height && (*it)->bHexagon == bHexagon)
+		{
+			std::shared_ptr<const GridMesh> gridMesh = *it;
+			cache.erase(it);
+			cache.push_front(gridMesh);
+			return gridMesh;
+		}
+	}
+
+	std::shared_ptr<const GridMesh> gridMesh = MeshBuildGrid(width, height, bHexagon);
+
+	cache.push_front(gridMesh);
+	if (cache.size() > MESH_GRID_CACHE_SIZE)
+	{
+		cache.pop_back();
+	}
+
+	return gridMesh;
+}
+
+
+// Builds a quadtree simplified version of the MeshCreateGrid mesh over one eye of the disparity map.
+// Square nodes are split while the disparity inside deviates more than maxError pixels from the bilinear
+// interpolation of the node corners, or when they contain both valid and invalid disparities. Nodes in the
+// border ramp are always split fully. Leaves with extra vertices on their edges from smaller neighbors are
+// fanned from their center, so there are no T-junctions between levels.
+void MeshCreateAdaptiveGrid(Mesh<VertexFormatBasic>& mesh, const int16_t* disparity, int rowStride, int width, int height, bool bNegativeDisparity, float maxError, MeshSimplificationStats& stats)
+{
+	mesh.vertices.clear();
+	mesh.triangles.clear();
+	stats = MeshSimplificationStats{};
+
+	if (width < 2 || height < 2)
+	{
+		return;
+	}
+
+	struct Node
+	{
+		int x, y, size;
+	};
+
+	// Disparities are 16-bit fixed point with 4 fractional bits.
+	float disparityScale = bNegativeDisparity ? -1.0f / 16.0f : 1.0f / 16.0f;
+
+	auto sampleDisparity = [&](int x, int y)
+	{
+		return disparity[y * rowStride + x * 2] * disparityScale;
+	};
+
+	auto nodeError = [&](const Node& node)
+	{
+		if (node.x < BORDER_SIZE || node.y < BORDER_SIZE || node.x + node.size >= width - BORDER_SIZE || node.y + node.size >= height - BORDER_SIZE)
+		{
+			return (std::numeric_limits<float>::max)();
+		}
+
+		float d00 = sampleDisparity(node.x, node.y);
+		float d10 = sampleDisparity(node.x + node.size, node.y);
+		float d01 = sampleDisparity(node.x, node.y + node.size);
+		float d11 = sampleDisparity(node.x + node.size, node.y + node.size);
+
+		bool bAnyValid = false;
+		bool bAnyInvalid = false;
+		float error = 0.0f;
+		float invSize = 1.0f / (float)node.size;
+
+		for (int y = 0; y <= node.size; y++)
+		{
+			float fy = y * invSize;
+			float left = d00 + (d01 - d00) * fy;
+			float right = d10 + (d11 - d10) * fy;
+
+			for (int x = 0; x <= node.size; x++)
+			{
+				float value = sampleDisparity(node.x + x, node.y + y);
+
+				if (value <= 0.0f)
+				{
+					bAnyInvalid = true;
+					continue;
+				}
+
+				bAnyValid = true;
+				error = fmaxf(error, fabsf(value - (left + (right - left) * x * invSize)));
+			}
+
+			if (bAnyValid && bAnyInvalid)
+			{
+				return (std::numeric_limits<float>::max)();
+			}
+		}
+
+		// Fully invalid areas are replaced by the default depth in the shader, so they need no detail.
+		return bAnyValid ? error : 0.0f;
+	};
+
+	int rootSize = 1;
+	while (rootSize < width - 1 || rootSize < height - 1)
+	{
+		rootSize *= 2;
+	}
+
+	std::vector<Node> leaves;
+	std::vector<Node> stack;
+	std::vector<bool> usedVertices(width * height, false);
+	stack.push_back({ 0, 0, rootSize });
+
+	double errorSum = 0.0;
+
+	while (!stack.empty())
+	{
+		Node node = stack.back();
+		stack.pop_back();
+
+		if (node.x >= width - 1 || node.y >= height - 1)
+		{
+			continue;
+		}
+
+		bool bOutside = node.x + node.size > width - 1 || node.y + node.size > height - 1;
+		float error = (node.size == 1) ? 0.0f : (bOutside ? (std::numeric_limits<float>::max)() : nodeError(node));
+
+		if (error > maxError)
+		{
+			int half = node.size / 2;
+			stack.push_back({ node.x, node.y, half });
+			stack.push_back({ node.x + half, node.y, half });
+			stack.push_back({ node.x, node.y + half, half });
+			stack.push_back({ node.x + half, node.y + half, half });
+			continue;
+		}
+
+		leaves.push_back(node);
+		usedVertices[node.y * width + node.x] = true;
+		usedVertices[node.y * width + node.x + node.size] = true;
+		usedVertices[(node.y + node.size) * width + node.x] = true;
+		usedVertices[(node.y + node.size) * width + node.x + node.size] = true;
+
+		stats.maxError = fmaxf(stats.maxError, error);
+		errorSum += error;
+	}
+
+	std::vector<uint32_t> vertexIndices(width * height, UINT32_MAX);
+	float stepX = 1.0f / (float)width;
+	float stepY = 1.0f / (float)height;
+
+	auto getVertex = [&](int x, int y)
+	{
+		uint32_t& index = vertexIndices[y * width + x];
+		if (index == UINT32_MAX)
+		{
+			index = (uint32_t)mesh.vertices.size();
+			mesh.vertices.emplace_back(x * stepX, y * stepY, GridBorderWeight(x, y, width, height));
+		}
+		return index;
+	};
+
+	std::vector<uint32_t> boundary;
+
+	for (const Node& node : leaves)
+	{
+		int x0 = node.x, y0 = node.y, x1 = node.x + node.size, y1 = node.y + node.size;
+
+		// Walk the edges in the same winding as the grid triangles.
+		boundary.clear();
+		for (int x = x0; x < x1; x++) { if (x == x0 || usedVertices[y0 * width + x]) { boundary.push_back(getVertex(x, y0)); } }
+		for (int y = y0; y < y1; y++) { if (y == y0 || usedVertices[y * width + x1]) { boundary.push_back(getVertex(x1, y)); } }
+		for (int x = x1; x > x0; x--) { if (x == x1 || usedVertices[y1 * width + x]) { boundary.push_back(getVertex(x, y1)); } }
+		for (int y = y1; y > y0; y--) { if (y == y1 || usedVertices[y * width + x0]) { boundary.push_back(getVertex(x0, y)); } }
+
+		if (boundary.size() == 4)
+		{
+			mesh.triangles.emplace_back(boundary[0], boundary[1], boundary[2]);
+			mesh.triangles.emplace_back(boundary[0], boundary[2], boundary[3]);
+		}
+		else
+		{
+			uint32_t center = getVertex(x0 + node.size / 2, y0 + node.size / 2);
+
+			for (size_t i = 0; i < boundary.size(); i++)
+			{
+				mesh.triangles.emplace_back(center, boundary[i], boundary[(i + 1) % boundary.size()]);
+			}
+		}
+	}
+
+	stats.numVertices = (uint32_t)mesh.vertices.size();
+	stats.numTriangles = (uint32_t)mesh.triangles.size();
+	stats.meanError = leaves.empty() ? 0.0f : (float)(errorSum / leaves.size());
+}
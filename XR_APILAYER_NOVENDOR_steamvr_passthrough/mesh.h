@@ -44,8 +44,51 @@ struct Mesh
 	std::vector<MeshTriangle> triangles;
 };
 
+// Post-transform vertex cache size the grid triangle order is tuned for.
+#define MESH_VERTEX_CACHE_SIZE 24
+
+struct MeshCacheStats
+{
+	float acmr; // Average cache miss ratio, vertex shader invocations per triangle.
+	float atvr; // Average transform to vertex ratio, vertex shader invocations per vertex.
+};
+
+struct MeshSimplificationStats
+{
+	uint32_t numVertices;
+	uint32_t numTriangles;
+	float maxError; // Largest disparity deviation in pixels accepted in a leaf.
+	float meanError;
+};
+
+// Disparity grid mesh with the index buffer ready for upload. Shared between renderers and not modified after creation.
+struct GridMesh
+{
+	int width = 0;
+	int height = 0;
+	bool bHexagon = false;
+
+	std::vector<VertexFormatBasic> vertices;
+	std::vector<uint16_t> indices16;
+	std::vector<uint32_t> indices32;
+	uint32_t numIndices = 0;
+	MeshCacheStats cacheStats{};
+
+	bool Uses16BitIndices() const { return !indices16.empty(); }
+	const void* GetIndexData() const { return Uses16BitIndices() ? (const void*)indices16.data() : (const void*)indices32.data(); }
+	uint32_t GetIndexDataSize() const { return numIndices * (Uses16BitIndices() ? sizeof(uint16_t) : sizeof(uint32_t)); }
+};
+
 
 void MeshCreateCylinder(Mesh<VertexFormatBasic>& mesh, int numBoundaryVertices);
 void MeshCreateGrid(Mesh<VertexFormatBasic>& mesh, int width, int height);
 void MeshCreateHexGrid(Mesh<VertexFormatBasic>& mesh, int width, int height);
-void MeshCreateRenderModel(Mesh<VertexFormatBasic>& mesh, vr::RenderModel_t* renderModel);
\ No newline at end of file
+void MeshCreateRenderModel(Mesh<VertexFormatBasic>& mesh, vr::RenderModel_t* renderModel);
+void MeshDecimate(Mesh<VertexFormatBasic>& mesh, uint32_t maxTriangles);
+MeshCacheStats MeshCalculateCacheStats(const Mesh<VertexFormatBasic>& mesh, uint32_t cacheSize);
+
+// Returns a cached grid mesh, building it if needed.
+std::shared_ptr<const GridMesh> MeshGetGrid(int width, int height, bool bHexagon);
+
+// The disparity data is the two channel 16-bit disparity and confidence map of one eye.
+void MeshCreateAdaptiveGrid(Mesh<VertexFormatBasic>& mesh, const int16_t* disparity, int rowStride, int width, int height, bool bNegativeDisparity, float maxError, MeshSimplificationStats& stats);
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "metrics.h"
+#include <log.h>
+#include <bit>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+static std::atomic_uint32_t g_nextThreadSlot = 0;
+
+uint32_t GetMetricsThreadSlot()
+{
+    thread_local uint32_t slot = g_nextThreadSlot.fetch_add(1, std::memory_order_relaxed) % METRICS_MAX_THREAD_SLOTS;
+    return slot;
+}
+
+
+uint64_t MetricCounter::Read() const
+{
+    uint64_t total = 0;
+    for (const Slot& slot : m_slots)
+    {
+        total += slot.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+
+void MetricTimer::Record(uint64_t durationNs)
+{
+    Slot& slot = m_slots[GetMetricsThreadSlot()];
+
+    uint32_t bucket = std::min((uint32_t)std::bit_width(durationNs >> m_bucketShift), (uint32_t)METRICS_NUM_TIMER_BUCKETS - 1);
+
+    slot.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    slot.totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+
+    uint64_t currentMax = slot.maxNs.load(std::memory_order_relaxed);
+    while (durationNs > currentMax && !slot.maxNs.compare_exchange_weak(currentMax, durationNs, std::memory_order_relaxed)) {}
+
+    // Count is published last so that readers see totals at least as new as the count.
+    slot.count.fetch_add(1, std::memory_order_release);
+}
+
+
+void MetricTimer::Read(MetricTimerStats& stats) const
+{
+    stats = MetricTimerStats();
+
+    for (const Slot& slot : m_slots)
+    {
+        stats.count += slot.count.load(std::memory_order_acquire);
+        stats.totalNs += slot.totalNs.load(std::memory_order_relaxed);
+        stats.maxNs = std::max(stats.maxNs, slot.maxNs.load(std::memory_order_relaxed));
+
+        for (uint32_t i = 0; i < METRICS_NUM_TIMER_BUCKETS; i++)
+        {
+            stats.buckets[i] += slot.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+uint64_t MetricTimer::GetBucketUpperBoundNs(uint32_t bucket) const
+{
+    if (bucket >= METRICS_NUM_TIMER_BUCKETS - 1)
+    {
+        return UINT64_MAX;
+    }
+    return 1ull << (m_bucketShift + bucket);
+}
+
+
+float MetricTimerWindow::GetAverageMS(uint64_t currentTimeNs)
+{
+    if (currentTimeNs - m_windowStartNs < m_windowNs)
+    {
+        return m_lastAverage;
+    }
+
+    MetricTimerStats stats;
+    m_timer.Read(stats);
+
+    uint64_t count = stats.count - m_lastCount;
+    uint64_t total = stats.totalNs - m_lastTotalNs;
+
+    m_lastAverage = count > 0 ? NsToMS(total / count) : 0.0f;
+
+    m_lastCount = stats.count;
+    m_lastTotalNs = stats.totalNs;
+    m_windowStartNs = currentTimeNs;
+
+    return m_lastAverage;
+}
+
+
+MetricsRegistry& MetricsRegistry::Get()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+
+MetricCounter& MetricsRegistry::GetCounter(const char* name)
+{
+    return *static_cast<MetricCounter*>(FindOrCreate(name, MetricType_Counter));
+}
+
+MetricGauge& MetricsRegistry::GetGauge(const char* name)
+{
+    return *static_cast<MetricGauge*>(FindOrCreate(name, MetricType_Gauge));
+}
+
+MetricTimer& MetricsRegistry::GetTimer(const char* name)
+{
+    return *static_cast<MetricTimer*>(FindOrCreate(name, MetricType_Timer));
+}
+
+
+IMetric* MetricsRegistry::FindOrCreate(const char* name, EMetricType type)
+{
+    std::lock_guard<std::mutex> lock(m_registrationMutex);
+
+    for (std::unique_ptr<IMetric>& metric : m_storage)
+    {
+        if (metric->GetName() == name)
+        {
+            if (metric->GetType() != type)
+            {
+                ErrorLog("Metric %s registered with conflicting types\n", name);
+                break;
+            }
+            return metric.get();
+        }
+    }
+
+    IMetric* metric = nullptr;
+
+    switch (type)
+    {
+    case MetricType_Counter:
+        metric = m_storage.emplace_back(std::make_unique<MetricCounter>(name)).get();
+        break;
+    case MetricType_Gauge:
+        metric = m_storage.emplace_back(std::make_unique<MetricGauge>(name)).get();
+        break;
+    default:
+        metric = m_storage.emplace_back(std::make_unique<MetricTimer>(name)).get();
+        break;
+    }
+
+    uint32_t index = m_numMetrics.load(std::memory_order_relaxed);
+
+    if (index < METRICS_MAX_METRICS)
+    {
+        m_metrics[index] = metric;
+        m_numMetrics.store(index + 1, std::memory_order_release);
+    }
+    else
+    {
+        ErrorLog("Metrics registry full, %s will not be listed\n", name);
+    }
+
+    return metric;
+}
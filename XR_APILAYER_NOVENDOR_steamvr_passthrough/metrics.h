@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <deque>
+#include <memory>
+
+
+// Number of per-thread slots per metric. Threads beyond this share slots, which is still correct since all updates are atomic.
+#define METRICS_MAX_THREAD_SLOTS 16
+#define METRICS_MAX_METRICS 64
+#define METRICS_NUM_TIMER_BUCKETS 10
+
+// By default the first timer bucket holds durations below 2^18 ns (~0.26 ms), each following bucket doubles the bound.
+// Timers of shorter events can start their buckets lower.
+#define METRICS_TIMER_BUCKET_SHIFT 18
+
+#define METRICS_CACHE_LINE_SIZE 64
+
+
+// Monotonic nanosecond clock used for all metrics and timestamps.
+inline uint64_t GetMonotonicTimeNs()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline float NsToMS(uint64_t timeNs)
+{
+	return (float)((double)timeNs / 1000000.0);
+}
+
+uint32_t GetMetricsThreadSlot();
+
+
+enum EMetricType
+{
+	MetricType_Counter,
+	MetricType_Gauge,
+	MetricType_Timer
+};
+
+class IMetric
+{
+public:
+	IMetric(const char* name, EMetricType type) : m_name(name), m_type(type) {}
+	virtual ~IMetric() {}
+
+	const std::string& GetName() const { return m_name; }
+	EMetricType GetType() const { return m_type; }
+
+private:
+	std::string m_name;
+	EMetricType m_type;
+};
+
+
+// Monotonically increasing event count.
+class MetricCounter : public IMetric
+{
+public:
+	MetricCounter(const char* name) : IMetric(name, MetricType_Counter) {}
+
+	void Add(uint64_t value = 1)
+	{
+		m_slots[GetMetricsThreadSlot()].value.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	uint64_t Read() const;
+
+private:
+	struct alignas(METRICS_CACHE_LINE_SIZE) Slot
+	{
+		std::atomic_uint64_t value{ 0 };
+	};
+
+	std::array<Slot, METRICS_MAX_THREAD_SLOTS> m_slots;
+};
+
+
+// Last written value.
+class MetricGauge : public IMetric
+{
+public:
+	MetricGauge(const char* name) : IMetric(name, MetricType_Gauge) {}
+
+	void Set(double value)
+	{
+		m_value.store(value, std::memory_order_relaxed);
+	}
+
+	double Read() const
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+private:
+	alignas(METRICS_CACHE_LINE_SIZE) std::atomic<double> m_value{ 0.0 };
+};
+
+
+struct MetricTimerStats
+{
+	uint64_t count = 0;
+	uint64_t totalNs = 0;
+	uint64_t maxNs = 0;
+	uint64_t buckets[METRICS_NUM_TIMER_BUCKETS] = {};
+
+	float GetAverageMS() const { return count > 0 ? NsToMS(totalNs / count) : 0.0f; }
+};
+
+// Duration histogram with fixed power of two buckets. The first bucket holds durations below 2^bucketShift ns.
+class MetricTimer : public IMetric
+{
+public:
+	MetricTimer(const char* name, uint32_t bucketShift = METRICS_TIMER_BUCKET_SHIFT)
+		: IMetric(name, MetricType_Timer)
+		, m_bucketShift(bucketShift)
+	{}
+
+	void Record(uint64_t durationNs);
+
+	void RecordSince(uint64_t startTimeNs)
+	{
+		uint64_t now = GetMonotonicTimeNs();
+		Record(now > startTimeNs ? now - startTimeNs : 0);
+	}
+
+	void Read(MetricTimerStats& stats) const;
+
+	uint64_t GetBucketUpperBoundNs(uint32_t bucket) const;
+
+private:
+	struct alignas(METRICS_CACHE_LINE_SIZE) Slot
+	{
+		std::atomic_uint64_t count{ 0 };
+		std::atomic_uint64_t totalNs{ 0 };
+		std::atomic_uint64_t maxNs{ 0 };
+		std::atomic_uint64_t buckets[METRICS_NUM_TIMER_BUCKETS] = {};
+	};
+
+	uint32_t m_bucketShift;
+	std::array<Slot, METRICS_MAX_THREAD_SLOTS> m_slots;
+};
+
+
+// Records the lifetime of the object into a timer.
+class MetricScopedTimer
+{
+public:
+	MetricScopedTimer(MetricTimer& timer)
+		: m_timer(timer)
+		, m_startTime(GetMonotonicTimeNs())
+	{}
+
+	~MetricScopedTimer()
+	{
+		m_timer.RecordSince(m_startTime);
+	}
+
+private:
+	MetricTimer& m_timer;
+	uint64_t m_startTime;
+};
+
+
+// Reader side average over a time window, computed from the difference between two timer reads.
+class MetricTimerWindow
+{
+public:
+	MetricTimerWindow(MetricTimer& timer, uint64_t windowNs = 500000000)
+		: m_timer(timer)
+		, m_windowNs(windowNs)
+	{}
+
+	// Returns the average duration of the last completed window, or zero if there were no samples.
+	float GetAverageMS(uint64_t currentTimeNs);
+
+private:
+	MetricTimer& m_timer;
+	uint64_t m_windowNs;
+	uint64_t m_windowStartNs = 0;
+	uint64_t m_lastCount = 0;
+	uint64_t m_lastTotalNs = 0;
+	float m_lastAverage = 0.0f;
+};
+
+
+// Global registry of named metrics. Registration is locked, updates and reads are lock-free.
+// Metrics are never removed, so references stay valid for the lifetime of the process.
+class MetricsRegistry
+{
+public:
+	static MetricsRegistry& Get();
+
+	MetricCounter& GetCounter(const char* name);
+	MetricGauge& GetGauge(const char* name);
+	MetricTimer& GetTimer(const char* name);
+
+	uint32_t GetNumMetrics() const { return m_numMetrics.load(std::memory_order_acquire); }
+	const IMetric* GetMetric(uint32_t index) const { return index < GetNumMetrics() ? m_metrics[index] : nullptr; }
+
+private:
+	MetricsRegistry() {}
+
+	IMetric* FindOrCreate(const char* name, EMetricType type);
+
+	std::mutex m_registrationMutex;
+	std::deque<std::unique_ptr<IMetric>> m_storage;
+	std::array<IMetric*, METRICS_MAX_METRICS> m_metrics = {};
+	std::atomic_uint32_t m_numMetrics{ 0 };
+};
+
+
+// Metric names used by the layer
+#define METRIC_TIMER_FRAME_RETRIEVAL "FrameRetrieval"
+#define METRIC_TIMER_RECONSTRUCTION "StereoReconstruction"
+#define METRIC_TIMER_PASSTHROUGH_RENDER "PassthroughRender"
+#define METRIC_TIMER_FRAME_TO_RENDER "FrameToRenderLatency"
+#define METRIC_TIMER_FRAME_TO_PHOTONS "FrameToPhotonsLatency"
+#define METRIC_TIMER_GRID_MESH_BUILD "GridMeshBuild"
+#define METRIC_TIMER_ROOM_CACHE_UPDATE "RoomCacheUpdate"
+#define METRIC_TIMER_CONFIG_WRITE "ConfigWrite"
+#define METRIC_TIMER_END_FRAME_OVERHEAD "LayerEndFrameOverhead"
+#define METRIC_TIMER_STEREO_RECTIFICATION "StereoRectification"
+#define METRIC_TIMER_DASHBOARD_CPU_VISIBLE "DashboardThreadCPUVisible"
+#define METRIC_TIMER_DASHBOARD_CPU_HIDDEN "DashboardThreadCPUHidden"
+#define METRIC_COUNTER_CAMERA_FRAMES "CameraFramesServed"
+#define METRIC_COUNTER_RECONSTRUCTED_FRAMES "ReconstructedFrames"
+#define METRIC_COUNTER_RECONSTRUCTION_SKIPPED "ReconstructionFramesSkipped"
+#define METRIC_COUNTER_RENDERED_FRAMES "PassthroughFramesRendered"
+#define METRIC_COUNTER_CONFIG_WRITES "ConfigWrites"
+#define METRIC_COUNTER_UPLOADED_BYTES "TextureUploadBytes"
+#define METRIC_COUNTER_SKIPPED_UPLOADS "TextureUploadsSkipped"
+#define METRIC_COUNTER_STAGING_STALLS "StagingRingStalls"
+#define METRIC_COUNTER_DASHBOARD_REDRAWS "DashboardRedraws"
+#define METRIC_COUNTER_DASHBOARD_IDLE_WAKEUPS "DashboardIdleWakeups"
+#define METRIC_COUNTER_DASHBOARD_HIDDEN_WAKEUPS "DashboardHiddenWakeups"
+#define METRIC_GAUGE_CAMERA_FRAME_SEQUENCE "CameraFrameSequence"
+#define METRIC_GAUGE_ROOM_CACHE_MEMORY "RoomCacheMemoryBytes"
+#define METRIC_GAUGE_ROOM_CACHE_SKIPPED "RoomCacheSkippedMatching"
+#define METRIC_GAUGE_RECONSTRUCTION_REUSED "ReconstructionBandsReused"
+#define METRIC_GAUGE_DEPTH_STALENESS "DepthMaxBandAgeFrames"
+#define METRIC_GAUGE_RECONSTRUCTION_THREADS "ReconstructionThreads"
@@ -2,32 +2,47 @@
 #include "openvr_manager.h"
 #include <log.h>
 #include "layer.h"
+#include "trace.h"
 
 
 using namespace steamvr_passthrough;
 using namespace steamvr_passthrough::log;
 
 
+// Minimum time between initialization attempts while the runtime is unavailable.
+// VR_Init is slow when the runtime isn't running, so the per frame callers don't retry it every time.
+#define OPENVR_INIT_RETRY_INTERVAL 1000000000ull
+
+
 OpenVRManager::OpenVRManager()
-    : m_bRuntimeInitialized(false)
-    , m_hmdDeviceId(-1)
+    : m_hmdDeviceId(-1)
+    , m_interfaces("OpenVRRuntime", OPENVR_INIT_RETRY_INTERVAL)
+    , m_bDeviceDebugThreadStarted(false)
+    , m_bRunDeviceDebugThread(false)
+    , m_bDeviceDebugRefreshPending(false)
 {
-    InitRuntime();
+    m_interfaces.Init([this](OpenVRInterfaces& interfaces) { return InitRuntime(interfaces); });
 }
 
 OpenVRManager::~OpenVRManager()
 {
-    std::lock_guard<std::mutex> lock(m_runtimeMutex);
-    if (m_bRuntimeInitialized)
+    // The thread may be waiting for the runtime mutex, so it is stopped before taking it.
     {
-        vr::VR_Shutdown();
+        std::lock_guard<std::mutex> lock(m_deviceDebugMutex);
+        m_bRunDeviceDebugThread = false;
     }
+    m_deviceDebugCondition.notify_all();
+
+    if (m_deviceDebugThread.joinable())
+    {
+        m_deviceDebugThread.join();
+    }
+
+    m_interfaces.Shutdown([](OpenVRInterfaces&) { vr::VR_Shutdown(); });
 }
 
-bool OpenVRManager::InitRuntime()
+bool OpenVRManager::InitRuntime(OpenVRInterfaces& interfaces)
 {
-    if (m_bRuntimeInitialized) { return true; }
-
     if (!vr::VR_IsRuntimeInstalled())
     {
         ErrorLog("SteamVR installation not detected!\n");
@@ -66,17 +81,108 @@ bool OpenVRManager::InitRuntime()
         return false;
     }
 
-    m_bRuntimeInitialized = true;
-    m_vrSystem = system;
-    m_vrCompositor = vr::VRCompositor();
-    m_vrTrackedCamera = vr::VRTrackedCamera();
-    m_vrOverlay = vr::VROverlay();
-    m_vrRenderModels = vr::VRRenderModels();
+    interfaces.system = system;
+    interfaces.compositor = vr::VRCompositor();
+    interfaces.trackedCamera = vr::VRTrackedCamera();
+    interfaces.overlay = vr::VROverlay();
+    interfaces.renderModels = vr::VRRenderModels();
 
     return true;
 }
 
-void OpenVRManager::GetCameraDebugProperties(std::vector<DeviceDebugProperties>& properties)
+std::shared_ptr<const DeviceDebugSnapshot> OpenVRManager::GetDeviceDebugSnapshot()
+{
+    if (!m_bDeviceDebugThreadStarted.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(m_deviceDebugMutex);
+
+        if (!m_bDeviceDebugThreadStarted.load(std::memory_order_relaxed))
+        {
+            m_bRunDeviceDebugThread = true;
+            m_bDeviceDebugRefreshPending = true;
+            m_deviceDebugThread = std::thread(&OpenVRManager::RunDeviceDebugThread, this);
+            m_bDeviceDebugThreadStarted.store(true, std::memory_order_release);
+        }
+    }
+
+    return m_deviceDebugSnapshot.load(std::memory_order_acquire);
+}
+
+void OpenVRManager::RequestDeviceDebugRefresh()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_deviceDebugMutex);
+        m_bDeviceDebugRefreshPending = true;
+    }
+    m_deviceDebugCondition.notify_all();
+}
+
+static bool IsDeviceChangeEvent(uint32_t eventType)
+{
+    switch (eventType)
+    {
+    case vr::VREvent_TrackedDeviceActivated:
+    case vr::VREvent_TrackedDeviceDeactivated:
+    case vr::VREvent_TrackedDeviceUpdated:
+    case vr::VREvent_TrackedDeviceRoleChanged:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void OpenVRManager::RunDeviceDebugThread()
+{
+    Tracer::Get().SetThreadName("Device properties");
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_deviceDebugMutex);
+            m_deviceDebugCondition.wait_for(lock, DEVICE_EVENT_POLL_INTERVAL, [this] { return m_bDeviceDebugRefreshPending || !m_bRunDeviceDebugThread; });
+
+            if (!m_bRunDeviceDebugThread) { return; }
+        }
+
+        vr::IVRSystem* vrSystem = GetVRSystem();
+
+        if (!vrSystem || !GetVRTrackedCamera())
+        {
+            // Keep any pending refresh until the runtime is available.
+            std::unique_lock<std::mutex> lock(m_deviceDebugMutex);
+            m_deviceDebugCondition.wait_for(lock, DEVICE_EVENT_POLL_INTERVAL, [this] { return !m_bRunDeviceDebugThread; });
+            continue;
+        }
+
+        bool bRefresh = false;
+        {
+            std::lock_guard<std::mutex> lock(m_deviceDebugMutex);
+            bRefresh = m_bDeviceDebugRefreshPending;
+            m_bDeviceDebugRefreshPending = false;
+        }
+
+        // Nothing else in the layer uses the system events, so they can all be consumed here.
+        vr::VREvent_t event;
+        while (vrSystem->PollNextEvent(&event, sizeof(event)))
+        {
+            bRefresh = bRefresh || IsDeviceChangeEvent(event.eventType);
+        }
+
+        if (!bRefresh)
+        {
+            continue;
+        }
+
+        std::shared_ptr<DeviceDebugSnapshot> snapshot = std::make_shared<DeviceDebugSnapshot>();
+        QueryDeviceDebugProperties(snapshot->Devices);
+        snapshot->QueryTime = GetMonotonicTimeNs();
+
+        m_deviceDebugSnapshot.store(snapshot, std::memory_order_release);
+    }
+}
+
+void OpenVRManager::QueryDeviceDebugProperties(std::vector<DeviceDebugProperties>& properties)
 {
     properties.clear();
 
@@ -100,7 +206,7 @@ void OpenVRManager::GetCameraDebugProperties(std::vector<DeviceDebugProperties>&
 
 
         deviceProps.bHasCamera = vrSystem->GetBoolTrackedDeviceProperty(deviceId, vr::Prop_HasCamera_Bool);
-        deviceProps.NumCameras = vrSystem->GetInt32TrackedDeviceProperty(deviceId, vr::Prop_NumCameras_Int32);
+        deviceProps.NumCameras = std::min(vrSystem->GetInt32TrackedDeviceProperty(deviceId, vr::Prop_NumCameras_Int32), 4);
 
         memset(stringPropBuffer, 0, sizeof(stringPropBuffer));
         uint32_t numChars = vrSystem->GetStringTrackedDeviceProperty(deviceId, vr::Prop_ManufacturerName_String, stringPropBuffer, sizeof(stringPropBuffer));
@@ -1,9 +1,36 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 #include "layer.h"
+#include "init_once.h"
+
+
+// Interval at which the runtime is polled for device change events while the device properties are in use.
+#define DEVICE_EVENT_POLL_INTERVAL std::chrono::milliseconds(1000)
+
+
+// Runtime interface pointers, published together once the runtime is initialized.
+struct OpenVRInterfaces
+{
+	vr::IVRSystem* system = nullptr;
+	vr::IVRCompositor* compositor = nullptr;
+	vr::IVRTrackedCamera* trackedCamera = nullptr;
+	vr::IVROverlay* overlay = nullptr;
+	vr::IVRRenderModels* renderModels = nullptr;
+};
+
+
+// Debug properties of all tracked devices at one point in time. Never modified after it has been published.
+struct DeviceDebugSnapshot
+{
+	uint64_t QueryTime = 0;
+	std::vector<DeviceDebugProperties> Devices;
+};
 
 
 class OpenVRManager
@@ -15,32 +42,32 @@ public:
 
 	inline vr::IVRSystem* GetVRSystem()
 	{
-		if (!CheckRuntimeIntialized()) { return nullptr; }
-		return m_vrSystem;
+		const OpenVRInterfaces* interfaces = GetInterfaces();
+		return interfaces ? interfaces->system : nullptr;
 	}
 
 	inline vr::IVRCompositor* GetVRCompositor()
 	{
-		if (!CheckRuntimeIntialized()) { return nullptr; }
-		return m_vrCompositor;
+		const OpenVRInterfaces* interfaces = GetInterfaces();
+		return interfaces ? interfaces->compositor : nullptr;
 	}
 
 	inline vr::IVRTrackedCamera* GetVRTrackedCamera()
 	{
-		if (!CheckRuntimeIntialized()) { return nullptr; }
-		return m_vrTrackedCamera;
+		const OpenVRInterfaces* interfaces = GetInterfaces();
+		return interfaces ? interfaces->trackedCamera : nullptr;
 	}
 
 	inline vr::IVROverlay* GetVROverlay()
 	{
-		if (!CheckRuntimeIntialized()) { return nullptr; }
-		return m_vrOverlay;
+		const OpenVRInterfaces* interfaces = GetInterfaces();
+		return interfaces ? interfaces->overlay : nullptr;
 	}
 
 	inline vr::IVRRenderModels* GetVRRenderModels()
 	{
-		if (!CheckRuntimeIntialized()) { return nullptr; }
-		return m_vrRenderModels;
+		const OpenVRInterfaces* interfaces = GetInterfaces();
+		return interfaces ? interfaces->renderModels : nullptr;
 	}
 
 	int GetHMDDeviceId() const
@@ -48,32 +75,36 @@ public:
 		return m_hmdDeviceId;
 	}
 
-	void GetCameraDebugProperties(std::vector<DeviceDebugProperties>& properties);
+	// Latest device property snapshot, or null until the first query has finished. Never calls into the runtime,
+	// the properties are queried on a background thread that is started by the first call.
+	std::shared_ptr<const DeviceDebugSnapshot> GetDeviceDebugSnapshot();
+
+	// Queries the device properties again in the background. They are also refreshed when devices are added, removed or updated.
+	void RequestDeviceDebugRefresh();
 
 private:
-	bool InitRuntime();
+	bool InitRuntime(OpenVRInterfaces& interfaces);
+
+	void RunDeviceDebugThread();
+	void QueryDeviceDebugProperties(std::vector<DeviceDebugProperties>& properties);
 
-	inline bool CheckRuntimeIntialized()
+	// The accessors are called every frame from several threads, so once the runtime is initialized
+	// they only need a single acquire load. The lock is only taken while the runtime is unavailable.
+	inline const OpenVRInterfaces* GetInterfaces()
 	{
-		{
-			std::lock_guard<std::mutex> lock(m_runtimeMutex);
-			if (!m_bRuntimeInitialized)
-			{
-				return InitRuntime();
-			}
-		}
-		return true;
+		return m_interfaces.Get([this](OpenVRInterfaces& interfaces) { return InitRuntime(interfaces); });
 	}
 
-	bool m_bRuntimeInitialized;
 	int m_hmdDeviceId;
 
-	std::mutex m_runtimeMutex;
+	InitOnce<OpenVRInterfaces> m_interfaces;
 
-	vr::IVRSystem* m_vrSystem;
-	vr::IVRCompositor* m_vrCompositor;
-	vr::IVRTrackedCamera* m_vrTrackedCamera;
-	vr::IVROverlay* m_vrOverlay;
-	vr::IVRRenderModels* m_vrRenderModels;
+	std::atomic<std::shared_ptr<const DeviceDebugSnapshot>> m_deviceDebugSnapshot;
+	std::atomic_bool m_bDeviceDebugThreadStarted;
+	std::thread m_deviceDebugThread;
+	std::mutex m_deviceDebugMutex;
+	std::condition_variable m_deviceDebugCondition;
+	bool m_bRunDeviceDebugThread;
+	bool m_bDeviceDebugRefreshPending;
 };
 
@@ -9,6 +9,8 @@
 #include "config_manager.h"
 #include "layer.h"
 #include "mesh.h"
+#include "upload_tracker.h"
+#include "staging_ring.h"
 #include "d3d11on12.h"
 
 using Microsoft::WRL::ComPtr;
@@ -73,14 +75,13 @@ struct DX11RenderModel
 {
 	DX11RenderModel()
 		: deviceId(0)
-		, meshPtr(nullptr)
 		, numIndices(0)
 		, meshToWorldTransform()
 	{
 	}
 
 	uint32_t deviceId;
-	Mesh<VertexFormatBasic>* meshPtr; // Only for checking equality. May be invalid.
+	std::shared_ptr<const Mesh<VertexFormatBasic>> mesh; // Kept to detect when the device model changes.
 	ComPtr<ID3D11Buffer> vertexBuffer;
 	ComPtr<ID3D11Buffer> indexBuffer;
 	uint32_t numIndices;
@@ -181,6 +182,8 @@ protected:
 	int m_frameIndex = 0;
 	int m_prevFrameIndex = 0;
 
+	UploadTracker m_uploadTracker;
+
 	ComPtr<ID3D11Device> m_d3dDevice;
 	ComPtr<ID3D11DeviceContext> m_deviceContext;
 	ComPtr<ID3D11DeviceContext> m_renderContext;
@@ -223,8 +226,10 @@ protected:
 	ComPtr<ID3D11ShaderResourceView> m_debugTextureSRV;
 	ESelectedDebugTexture m_selectedDebugTexture;
 
-	ComPtr<ID3D11Texture2D> m_cameraFrameUploadTexture;
-	ComPtr<ID3D11Texture2D> m_disparityMapUploadTexture;
+	// Staging textures are rotated every frame, so that mapping one never waits for the GPU to finish copying from it.
+	ComPtr<ID3D11Texture2D> m_cameraFrameUploadTextures[NUM_SWAPCHAINS];
+	ComPtr<ID3D11Texture2D> m_disparityMapUploadTextures[NUM_SWAPCHAINS];
+	uint32_t m_uploadTextureIndex = 0;
 	uint32_t m_disparityMapWidth;
 
 	ComPtr<ID3D11Texture2D> m_uvDistortionMap;
@@ -241,7 +246,7 @@ protected:
 	ComPtr<ID3D11Buffer> m_cylinderMeshVertexBuffer;
 	ComPtr<ID3D11Buffer> m_cylinderMeshIndexBuffer;
 
-	Mesh<VertexFormatBasic> m_gridMesh;
+	std::shared_ptr<const GridMesh> m_gridMesh = std::make_shared<GridMesh>();
 	ComPtr<ID3D11Buffer> m_gridMeshVertexBuffer;
 	ComPtr<ID3D11Buffer> m_gridMeshIndexBuffer;
 	bool m_bUseHexagonGridMesh;
@@ -279,7 +284,7 @@ class PassthroughRendererDX12 : public IPassthroughRenderer
 {
 public:
 	PassthroughRendererDX12(ID3D12Device* device, ID3D12CommandQueue* commandQueue, HMODULE dllModule, std::shared_ptr<ConfigManager> configManager);
-	~PassthroughRendererDX12() {};
+	~PassthroughRendererDX12();
 
 	bool InitRenderer();	
 	void InitRenderTarget(const ERenderEye eye, void* rendertarget, const uint32_t imageIndex, const XrSwapchainCreateInfo& swapchainInfo);
@@ -294,6 +299,10 @@ private:
 	void SetupFrameResource();
 	void SetupDisparityMap(uint32_t width, uint32_t height);
 	void SetupUVDistortionMap(std::shared_ptr<std::vector<float>> uvDistortionMap);
+	void SetupStagingRing();
+	void SignalUploadFence();
+	void WaitForUploadFence(uint64_t fenceValue);
+	bool UploadTextureStaged(ID3D12Resource* texture, const uint8_t* image, uint32_t textureWidth, uint32_t textureHeight, DXGI_FORMAT format, uint32_t pixelSize);
 	bool CreateRootSignature();
 	bool InitPipeline();
 	void SetupIntermediateRenderTarget(uint32_t index, uint32_t width, uint32_t height);
@@ -309,6 +318,21 @@ private:
 
 	int m_frameIndex = 0;
 
+	UploadTracker m_uploadTracker;
+
+	// Persistently mapped upload buffer for the per-frame camera and disparity uploads.
+	ComPtr<ID3D12Resource> m_stagingBuffer;
+	uint8_t* m_stagingBufferCPUData = nullptr;
+	StagingRing m_stagingRing;
+	size_t m_stagingCameraFrameSize = 0;
+	size_t m_stagingDisparityMapSize = 0;
+	MetricCounter& m_stagingStallCounter;
+
+	// Signaled after each submission, tells when the staging memory used by the submission can be reused.
+	ComPtr<ID3D12Fence> m_uploadFence;
+	uint64_t m_uploadFenceValue = 0;
+	HANDLE m_uploadFenceEvent = nullptr;
+
 	ComPtr<ID3D12Device> m_d3dDevice;
 	ComPtr<ID3D12CommandQueue> m_d3dCommandQueue;
 
@@ -360,13 +384,11 @@ private:
 	ESelectedDebugTexture m_selectedDebugTexture;
 
 	ComPtr<ID3D12Resource> m_cameraFrameRes[NUM_SWAPCHAINS];
-	ComPtr<ID3D12Resource> m_frameResUploadHeap;
 
 	ComPtr<ID3D12Resource> m_intermediateRenderTargets[NUM_SWAPCHAINS * 2];
 	ComPtr<ID3D12DescriptorHeap> m_intermediateRTVHeap;
 
 	ComPtr<ID3D12Resource> m_disparityMap[NUM_SWAPCHAINS * 2];
-	ComPtr<ID3D12Resource> m_disparityMapUploadHeap;
 	uint32_t m_disparityMapWidth;
 
 	ComPtr<ID3D12Resource> m_uvDistortionMap;
@@ -379,7 +401,7 @@ private:
 	ComPtr<ID3D12Resource> m_cylinderMeshVertexBufferUpload;
 	ComPtr<ID3D12Resource> m_cylinderMeshIndexBufferUpload;
 
-	Mesh<VertexFormatBasic> m_gridMesh;
+	std::shared_ptr<const GridMesh> m_gridMesh = std::make_shared<GridMesh>();
 	ComPtr<ID3D12Resource> m_gridMeshVertexBuffer;
 	ComPtr<ID3D12Resource> m_gridMeshIndexBuffer;
 	ComPtr<ID3D12Resource> m_gridMeshVertexBufferUpload;
@@ -413,6 +435,10 @@ private:
 	bool GenerateMesh(VkCommandBuffer commandBuffer);
 	void SetupIntermediateRenderTarget(uint32_t index, uint32_t width, uint32_t height);
 	void SetupUVDistortionMap(std::shared_ptr<std::vector<float>> uvDistortionMap);
+	void SetupStagingRing(size_t capacity);
+	uint64_t GetCompletedFenceValue();
+	void WaitForFrameFence(uint64_t fenceValue);
+	bool UploadImageStaged(VkCommandBuffer commandBuffer, VkImage image, const uint8_t* data, uint32_t width, uint32_t height, uint32_t pixelSize, VkImageLayout oldLayout, VkImageLayout newLayout);
 	bool UpdateCameraFrameResource(VkCommandBuffer commandBuffer, int frameIndex, void* frameResource);
 	void UpdateDescriptorSets(VkCommandBuffer commandBuffer, int swapchainIndex, const XrCompositionLayerProjection* layer, EPassthroughBlendMode blendMode);
 
@@ -508,10 +534,20 @@ private:
 	VkImage m_uvDistortionMap;
 	VkImageView m_uvDistortionMapView;
 	VkDeviceMemory m_uvDistortionMapMem;
-	VkBuffer m_uvDistortionMapBuffer;
-	VkDeviceMemory m_uvDistortionMapBufferMem;
 	float m_fovScale;
 
+	// Persistently mapped upload buffer for the UV distortion map uploads.
+	VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_stagingBufferMem = VK_NULL_HANDLE;
+	uint8_t* m_stagingBufferCPUData = nullptr;
+	StagingRing m_stagingRing;
+	MetricCounter& m_stagingStallCounter;
+
+	// Signaled by the submission of each command buffer. Tells when the command buffer and the staging memory it used can be reused.
+	VkFence m_frameFences[NUM_SWAPCHAINS] = {};
+	uint64_t m_frameFenceValues[NUM_SWAPCHAINS] = {};
+	uint64_t m_submittedFenceValue = 0;
+
 	Mesh<VertexFormatBasic> m_cylinderMesh;
 	VkDeviceMemory m_cylinderMeshVertexBufferMem;
 	VkBuffer m_cylinderMeshVertexBuffer;
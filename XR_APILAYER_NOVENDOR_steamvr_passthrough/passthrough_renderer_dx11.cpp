@@ -105,19 +105,16 @@ inline uint32_t Align(const uint32_t value, const uint32_t alignment)
 	return (value + alignment - 1) & ~(alignment - 1);
 }
 
-void UploadTexture(ComPtr<ID3D11DeviceContext> deviceContext, ComPtr<ID3D11Texture2D> uploadTexture, uint8_t* inputBuffer, int height, int width)
+bool UploadTexture(ComPtr<ID3D11DeviceContext> deviceContext, ComPtr<ID3D11Texture2D> uploadTexture, uint8_t* inputBuffer, int height, int width)
 {
 	D3D11_MAPPED_SUBRESOURCE resource = {};
-	deviceContext->Map(uploadTexture.Get(), 0, D3D11_MAP_WRITE, 0, &resource);
-	uint8_t* writePtr = (uint8_t*)resource.pData;
-	uint8_t* readPtr = inputBuffer;
-	for (int i = 0; i < height; i++)
+	if (FAILED(deviceContext->Map(uploadTexture.Get(), 0, D3D11_MAP_WRITE, 0, &resource)))
 	{
-		memcpy(writePtr, readPtr, width);
-		writePtr += resource.RowPitch;
-		readPtr += width;
+		return false;
 	}
+	CopyRows((uint8_t*)resource.pData, resource.RowPitch, inputBuffer, width, width, height);
 	deviceContext->Unmap(uploadTexture.Get(), 0);
+	return true;
 }
 
 
@@ -134,7 +131,7 @@ PassthroughRendererDX11::PassthroughRendererDX11(ID3D11Device* device, HMODULE d
 	, m_selectedDebugTexture(DebugTexture_None)
 {
 	
-	m_bUseHexagonGridMesh = m_configManager->GetConfig_Stereo().StereoUseHexagonGridMesh;
+	m_bUseHexagonGridMesh = m_configManager->GetConfigSnapshot()->Stereo.StereoUseHexagonGridMesh;
 }
 
 
@@ -475,25 +472,25 @@ void PassthroughRendererDX11::SetupCameraFrameResource(const uint32_t imageIndex
 	srvDesc.Format = textureDesc.Format;
 	srvDesc.Texture2D.MipLevels = 1;
 
-	if (!m_cameraFrameUploadTexture)
+	if (!m_cameraFrameUploadTextures[0])
 	{
 		D3D11_TEXTURE2D_DESC uploadTextureDesc = textureDesc;
 		uploadTextureDesc.BindFlags = 0;
 		uploadTextureDesc.Usage = D3D11_USAGE_STAGING;
 		uploadTextureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-		if (FAILED(m_d3dDevice->CreateTexture2D(&uploadTextureDesc, nullptr, &m_cameraFrameUploadTexture)))
-		{
-			ErrorLog("Frame Resource CreateTexture2D error!\n");
-			return;
-		}
-
 		std::vector<uint8_t> image(m_cameraFrameBufferSize);
 
-		D3D11_MAPPED_SUBRESOURCE res = {};
-		m_deviceContext->Map(m_cameraFrameUploadTexture.Get(), 0, D3D11_MAP_WRITE, 0, &res);
-		memcpy(res.pData, image.data(), image.size());
-		m_deviceContext->Unmap(m_cameraFrameUploadTexture.Get(), 0);
+		for (int i = 0; i < NUM_SWAPCHAINS; i++)
+		{
+			if (FAILED(m_d3dDevice->CreateTexture2D(&uploadTextureDesc, nullptr, &m_cameraFrameUploadTextures[i])))
+			{
+				ErrorLog("Frame Resource CreateTexture2D error!\n");
+				return;
+			}
+
+			UploadTexture(m_deviceContext, m_cameraFrameUploadTextures[i], image.data(), m_cameraTextureHeight, m_cameraTextureWidth * 4);
+		}
 	}
 
 	DX11FrameData& frameData = m_frameData[imageIndex];
@@ -509,7 +506,9 @@ void PassthroughRendererDX11::SetupCameraFrameResource(const uint32_t imageIndex
 		return;
 	}
 
-	m_deviceContext->CopyResource(frameData.cameraFrameTexture.Get(), m_cameraFrameUploadTexture.Get());
+	m_deviceContext->CopyResource(frameData.cameraFrameTexture.Get(), m_cameraFrameUploadTextures[0].Get());
+
+	m_uploadTracker.Invalidate(UploadResource_CameraFrame, imageIndex);
 }
 
 
@@ -553,10 +552,13 @@ void PassthroughRendererDX11::SetupDisparityMap(uint32_t width, uint32_t height)
 	uploadTextureDesc.Usage = D3D11_USAGE_STAGING;
 	uploadTextureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-	if (FAILED(m_d3dDevice->CreateTexture2D(&uploadTextureDesc, nullptr, &m_disparityMapUploadTexture)))
+	for (int i = 0; i < NUM_SWAPCHAINS; i++)
 	{
-		ErrorLog("Disparity Map CreateTexture2D error!\n");
-		return;
+		if (FAILED(m_d3dDevice->CreateTexture2D(&uploadTextureDesc, nullptr, &m_disparityMapUploadTextures[i])))
+		{
+			ErrorLog("Disparity Map CreateTexture2D error!\n");
+			return;
+		}
 	}
 
 
@@ -575,7 +577,7 @@ void PassthroughRendererDX11::SetupDisparityMap(uint32_t width, uint32_t height)
 			return;
 		}
 
-		if (m_configManager->GetConfig_Stereo().StereoUseDisparityTemporalFiltering)
+		if (m_configManager->GetConfigSnapshot()->Stereo.StereoUseDisparityTemporalFiltering)
 		{
 
 			if (FAILED(m_d3dDevice->CreateTexture2D(&uavTextureDesc, nullptr, &frameData.disparityMapUAVTexture)))
@@ -754,7 +756,7 @@ void PassthroughRendererDX11::InitRenderTarget(const ERenderEye eye, void* rende
 		return;
 	}
 
-	if (m_configManager->GetConfig_Main().EnableTemporalFiltering)
+	if (m_configManager->GetConfigSnapshot()->Main.EnableTemporalFiltering)
 	{
 		SetupTemporalUAV(eye, (ID3D11Resource*)rendertarget, imageIndex);
 	}
@@ -954,12 +956,12 @@ void PassthroughRendererDX11::GenerateMesh()
 
 void PassthroughRendererDX11::GenerateDepthMesh(uint32_t width, uint32_t height)
 {
-	m_bUseHexagonGridMesh ? MeshCreateHexGrid(m_gridMesh, width, height) : MeshCreateGrid(m_gridMesh, width, height);
+	m_gridMesh = MeshGetGrid(width, height, m_bUseHexagonGridMesh);
 
 	D3D11_SUBRESOURCE_DATA vertexBufferData{};
-	vertexBufferData.pSysMem = m_gridMesh.vertices.data();
+	vertexBufferData.pSysMem = m_gridMesh->vertices.data();
 
-	CD3D11_BUFFER_DESC vertexBufferDesc((UINT)m_gridMesh.vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
+	CD3D11_BUFFER_DESC vertexBufferDesc((UINT)m_gridMesh->vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
 	if (FAILED(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &m_gridMeshVertexBuffer)))
 	{
 		ErrorLog("Depth mesh vertex buffer creation error!\n");
@@ -967,9 +969,9 @@ void PassthroughRendererDX11::GenerateDepthMesh(uint32_t width, uint32_t height)
 	}
 
 	D3D11_SUBRESOURCE_DATA indexBufferData{};
-	indexBufferData.pSysMem = m_gridMesh.triangles.data();
+	indexBufferData.pSysMem = m_gridMesh->GetIndexData();
 
-	CD3D11_BUFFER_DESC indexBufferDesc((UINT)m_gridMesh.triangles.size() * sizeof(MeshTriangle), D3D11_BIND_INDEX_BUFFER);
+	CD3D11_BUFFER_DESC indexBufferDesc(m_gridMesh->GetIndexDataSize(), D3D11_BIND_INDEX_BUFFER);
 	if (FAILED(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexBufferData, &m_gridMeshIndexBuffer)))
 	{
 		ErrorLog("Depth mesh index buffer creation error!\n");
@@ -988,29 +990,29 @@ void PassthroughRendererDX11::UpdateRenderModels(CameraFrame* frame)
 			if (model.deviceId == dxModel.deviceId)
 			{
 				bFound = true;
-				if (!dxModel.meshPtr || &model.mesh != dxModel.meshPtr)
+				if (!dxModel.mesh || model.mesh != dxModel.mesh)
 				{
-					dxModel.meshPtr = &model.mesh;
+					dxModel.mesh = model.mesh;
 
 					D3D11_SUBRESOURCE_DATA vertexBufferData{};
-					vertexBufferData.pSysMem = model.mesh.vertices.data();
+					vertexBufferData.pSysMem = model.mesh->vertices.data();
 
-					CD3D11_BUFFER_DESC vertexBufferDesc((UINT)model.mesh.vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
+					CD3D11_BUFFER_DESC vertexBufferDesc((UINT)model.mesh->vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
 					if (FAILED(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &dxModel.vertexBuffer)))
 					{
 						ErrorLog("Render model vertex buffer creation error!\n");
 					}
 
 					D3D11_SUBRESOURCE_DATA indexBufferData{};
-					indexBufferData.pSysMem = model.mesh.triangles.data();
+					indexBufferData.pSysMem = model.mesh->triangles.data();
 
-					CD3D11_BUFFER_DESC indexBufferDesc((UINT)model.mesh.triangles.size() * sizeof(MeshTriangle), D3D11_BIND_INDEX_BUFFER);
+					CD3D11_BUFFER_DESC indexBufferDesc((UINT)model.mesh->triangles.size() * sizeof(MeshTriangle), D3D11_BIND_INDEX_BUFFER);
 					if (FAILED(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexBufferData, &dxModel.indexBuffer)))
 					{
 						ErrorLog("Render model index buffer creation error!\n");
 					}
 
-					dxModel.numIndices = (uint32_t)(model.mesh.triangles.size() * 3);
+					dxModel.numIndices = (uint32_t)(model.mesh->triangles.size() * 3);
 				}
 
 				dxModel.meshToWorldTransform = model.meshToWorldTransform;
@@ -1024,27 +1026,27 @@ void PassthroughRendererDX11::UpdateRenderModels(CameraFrame* frame)
 			DX11RenderModel dxModel;
 
 			dxModel.deviceId = model.deviceId;
-			dxModel.meshPtr = &model.mesh;
+			dxModel.mesh = model.mesh;
 
 			D3D11_SUBRESOURCE_DATA vertexBufferData{};
-			vertexBufferData.pSysMem = model.mesh.vertices.data();
+			vertexBufferData.pSysMem = model.mesh->vertices.data();
 
-			CD3D11_BUFFER_DESC vertexBufferDesc((UINT)model.mesh.vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
+			CD3D11_BUFFER_DESC vertexBufferDesc((UINT)model.mesh->vertices.size() * sizeof(VertexFormatBasic), D3D11_BIND_VERTEX_BUFFER);
 			if (FAILED(m_d3dDevice->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &dxModel.vertexBuffer)))
 			{
 				ErrorLog("Render model vertex buffer creation error!\n");
 			}
 
 			D3D11_SUBRESOURCE_DATA indexBufferData{};
-			indexBufferData.pSysMem = model.mesh.triangles.data();
+			indexBufferData.pSysMem = model.mesh->triangles.data();
 
-			CD3D11_BUFFER_DESC indexBufferDesc((UINT)model.mesh.triangles.size() * sizeof(MeshTriangle), D3D11_BIND_INDEX_BUFFER);
+			CD3D11_BUFFER_DESC indexBufferDesc((UINT)model.mesh->triangles.size() * sizeof(MeshTriangle), D3D11_BIND_INDEX_BUFFER);
 			if (FAILED(m_d3dDevice->CreateBuffer(&indexBufferDesc, &indexBufferData, &dxModel.indexBuffer)))
 			{
 				ErrorLog("Render model index buffer creation error!\n");
 			}
 
-			dxModel.numIndices = (uint32_t)(model.mesh.triangles.size() * 3);
+			dxModel.numIndices = (uint32_t)(model.mesh->triangles.size() * 3);
 			dxModel.meshToWorldTransform = model.meshToWorldTransform;
 
 			m_renderModels.push_back(dxModel);
@@ -1067,13 +1069,15 @@ void PassthroughRendererDX11::RenderPassthroughFrame(const XrCompositionLayerPro
 	assert(leftSwapchainIndex == rightSwapchainIndex);
 	m_prevFrameIndex = m_frameIndex;
 	m_frameIndex = leftSwapchainIndex;
+	m_uploadTextureIndex = (m_uploadTextureIndex + 1) % NUM_SWAPCHAINS;
 
 	DX11FrameData& frameData = m_frameData[m_frameIndex];
 	DX11FrameData& prevFrameData = m_frameData[m_prevFrameIndex];
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Core& coreConf = m_configManager->GetConfig_Core();
-	Config_Stereo& stereoConf = m_configManager->GetConfig_Stereo();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
+	const Config_Core& coreConf = config->Core;
+	const Config_Stereo& stereoConf = config->Stereo;
 
 	if (SUCCEEDED(m_d3dDevice->CreateDeferredContext(0, &m_renderContext)))
 	{
@@ -1123,11 +1127,23 @@ void PassthroughRendererDX11::RenderPassthroughFrame(const XrCompositionLayerPro
 			m_bUseHexagonGridMesh = stereoConf.StereoUseHexagonGridMesh;
 			SetupDisparityMap(depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1]);
 			GenerateDepthMesh(depthFrame->disparityTextureSize[0] / 2, depthFrame->disparityTextureSize[1]);
+			m_uploadTracker.Invalidate(UploadResource_DisparityMap);
 		}
 
-		UploadTexture(m_deviceContext, m_disparityMapUploadTexture, (uint8_t*)depthFrame->disparityMap->data(), depthFrame->disparityTextureSize[1], depthFrame->disparityTextureSize[0] * sizeof(uint16_t) * 2);
+		size_t disparityMapSize = depthFrame->disparityTextureSize[0] * depthFrame->disparityTextureSize[1] * sizeof(uint16_t) * 2;
 
-		m_deviceContext->CopyResource(frameData.disparityMap.Get(), m_disparityMapUploadTexture.Get());
+		m_uploadTracker.Upload(UploadResource_DisparityMap, m_frameIndex, depthFrame->generation, disparityMapSize, [&]()
+		{
+			ComPtr<ID3D11Texture2D>& uploadTexture = m_disparityMapUploadTextures[m_uploadTextureIndex];
+
+			if (!UploadTexture(m_deviceContext, uploadTexture, (uint8_t*)depthFrame->disparityMap->data(), depthFrame->disparityTextureSize[1], depthFrame->disparityTextureSize[0] * sizeof(uint16_t) * 2))
+			{
+				return false;
+			}
+
+			m_deviceContext->CopyResource(frameData.disparityMap.Get(), uploadTexture.Get());
+			return true;
+		});
 
 		if (stereoConf.StereoUseDisparityTemporalFiltering)
 		{
@@ -1166,7 +1182,7 @@ void PassthroughRendererDX11::RenderPassthroughFrame(const XrCompositionLayerPro
 	if (mainConf.DebugTexture != DebugTexture_None)
 	{
 		DebugTexture& texture = m_configManager->GetDebugTexture();
-		std::lock_guard<std::mutex> readlock(texture.RWMutex);
+		std::lock_guard<ProfiledMutex> readlock(texture.RWMutex);
 
 		if (texture.CurrentTexture == mainConf.DebugTexture)
 		{
@@ -1197,10 +1213,19 @@ void PassthroughRendererDX11::RenderPassthroughFrame(const XrCompositionLayerPro
 	}
 	else if(!bGotDebugTexture)
 	{
-		// Upload camera frame from CPU
-		UploadTexture(m_deviceContext, m_cameraFrameUploadTexture, (uint8_t*)frame->frameBuffer->data(), m_cameraTextureHeight, m_cameraTextureWidth * 4);
+		// Upload camera frame from CPU, unless this slot already holds it.
+		m_uploadTracker.Upload(UploadResource_CameraFrame, m_frameIndex, frame->header.nFrameSequence, m_cameraTextureHeight * m_cameraTextureWidth * 4, [&]()
+		{
+			ComPtr<ID3D11Texture2D>& uploadTexture = m_cameraFrameUploadTextures[m_uploadTextureIndex];
+
+			if (!UploadTexture(m_deviceContext, uploadTexture, (uint8_t*)frame->frameBuffer->data(), m_cameraTextureHeight, m_cameraTextureWidth * 4))
+			{
+				return false;
+			}
 
-		m_deviceContext->CopyResource(frameData.cameraFrameTexture.Get(), m_cameraFrameUploadTexture.Get());
+			m_deviceContext->CopyResource(frameData.cameraFrameTexture.Get(), uploadTexture.Get());
+			return true;
+		});
 
 		psSRVs[0] = frameData.cameraFrameSRV.Get();
 	}
@@ -1220,9 +1245,9 @@ void PassthroughRendererDX11::RenderPassthroughFrame(const XrCompositionLayerPro
 
 	if (mainConf.ProjectionMode == Projection_StereoReconstruction)
 	{
-		numIndices = (UINT)m_gridMesh.triangles.size() * 3;
+		numIndices = m_gridMesh->numIndices;
 		m_renderContext->IASetVertexBuffers(0, 1, m_gridMeshVertexBuffer.GetAddressOf(), strides, offsets);
-		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), m_gridMesh->Uses16BitIndices() ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 		m_renderContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		
 		if (stereoConf.StereoUseDisparityTemporalFiltering && m_bIsTemporalSupported)
@@ -1303,7 +1328,8 @@ void PassthroughRendererDX11::RenderPassthroughView(const ERenderEye eye, const
 
 	if (!rendertarget) { return; }
 
-	Config_Depth& depthConfig = m_configManager->GetConfig_Depth();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Depth& depthConfig = config->Depth;
 	bool bCompositeDepth = renderParams.bEnableDepthBlending && depthStencil != nullptr;
 	bool bWriteDepth = depthConfig.DepthWriteOutput && depthConfig.DepthReadFromApplication;
 
@@ -1320,8 +1346,8 @@ void PassthroughRendererDX11::RenderPassthroughView(const ERenderEye eye, const
 	m_renderContext->RSSetViewports(1, &viewport);
 	m_renderContext->RSSetScissorRects(1, &scissor);
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Stereo& stereoConf = m_configManager->GetConfig_Stereo();
+	const Config_Main& mainConf = config->Main;
+	const Config_Stereo& stereoConf = config->Stereo;
 
 	VSViewConstantBuffer vsViewBuffer = {};
 	vsViewBuffer.cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1424,7 +1450,7 @@ void PassthroughRendererDX11::RenderPassthroughView(const ERenderEye eye, const
 
 		m_renderContext->VSSetShader(m_meshRigidVertexShader.Get(), nullptr, 0);
 
-		for (DX11RenderModel model : m_renderModels)
+		for (const DX11RenderModel& model : m_renderModels)
 		{
 			VSMeshConstantBuffer vsMeshBuffer;
 			vsMeshBuffer.meshToWorldTransform = model.meshToWorldTransform;
@@ -1451,9 +1477,9 @@ void PassthroughRendererDX11::RenderPassthroughView(const ERenderEye eye, const
 
 	if (mainConf.ProjectionMode == Projection_StereoReconstruction)
 	{	
-		numIndices = (UINT)m_gridMesh.triangles.size() * 3;
+		numIndices = m_gridMesh->numIndices;
 		m_renderContext->IASetVertexBuffers(0, 1, m_gridMeshVertexBuffer.GetAddressOf(), strides, offsets);
-		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), m_gridMesh->Uses16BitIndices() ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 
 		if (stereoConf.StereoUseDisparityTemporalFiltering && m_bIsTemporalSupported)
 		{
@@ -1533,7 +1559,7 @@ void PassthroughRendererDX11::RenderPassthroughView(const ERenderEye eye, const
 
 
 		m_renderContext->IASetVertexBuffers(0, 1, m_gridMeshVertexBuffer.GetAddressOf(), strides, offsets);
-		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		m_renderContext->IASetIndexBuffer(m_gridMeshIndexBuffer.Get(), m_gridMesh->Uses16BitIndices() ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 		if (stereoConf.StereoUseDisparityTemporalFiltering && m_bIsTemporalSupported)
 		{
 			m_renderContext->VSSetShader(m_stereoTemporalVertexShader.Get(), nullptr, 0);
@@ -1559,7 +1585,8 @@ void PassthroughRendererDX11::RenderMaskedPrepassView(const ERenderEye eye, cons
 
 	if (!rendertarget) { return; }
 
-	Config_Depth& depthConfig = m_configManager->GetConfig_Depth();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Depth& depthConfig = config->Depth;
 	bool bCompositeDepth = renderParams.bEnableDepthBlending && depthStencil != nullptr;
 	bool bWriteDepth = depthConfig.DepthWriteOutput && depthConfig.DepthReadFromApplication;
 
@@ -1571,8 +1598,8 @@ void PassthroughRendererDX11::RenderMaskedPrepassView(const ERenderEye eye, cons
 	m_renderContext->RSSetViewports(1, &viewport);
 	m_renderContext->RSSetScissorRects(1, &scissor);
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Stereo& stereoConf = m_configManager->GetConfig_Stereo();
+	const Config_Main& mainConf = config->Main;
+	const Config_Stereo& stereoConf = config->Stereo;
 
 	VSViewConstantBuffer vsViewBuffer = {};
 	vsViewBuffer.cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1616,13 +1643,13 @@ void PassthroughRendererDX11::RenderMaskedPrepassView(const ERenderEye eye, cons
 
 	if (eye == LEFT_EYE || !bSingleStereoRenderTarget)
 	{
-		float clearColor[4] = { m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage ? 1.0f : 0, 0, 0, 0 };
+		float clearColor[4] = { config->Core.CoreForceMaskedUseCameraImage ? 1.0f : 0, 0, 0, 0 };
 		m_renderContext->ClearRenderTargetView(tempTarget.RTV.Get(), clearColor);
 	}
 
 	m_renderContext->OMSetRenderTargets(1, tempTarget.RTV.GetAddressOf(), depthStencil);
 	m_renderContext->OMSetBlendState(nullptr, nullptr, UINT_MAX);
-	m_renderContext->OMSetDepthStencilState(GET_DEPTH_STENCIL_STATE(bCompositeDepth, m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage == frame->bHasReversedDepth, bWriteDepth), 1);
+	m_renderContext->OMSetDepthStencilState(GET_DEPTH_STENCIL_STATE(bCompositeDepth, config->Core.CoreForceMaskedUseCameraImage == frame->bHasReversedDepth, bWriteDepth), 1);
 
 	ID3D11ShaderResourceView* cameraFrameSRV;
 
@@ -1641,7 +1668,7 @@ void PassthroughRendererDX11::RenderMaskedPrepassView(const ERenderEye eye, cons
 
 	ID3D11ShaderResourceView* prepassSourceTexture;
 
-	if (m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage)
+	if (config->Core.CoreForceMaskedUseCameraImage)
 	{
 		prepassSourceTexture = cameraFrameSRV;
 	}
@@ -1666,7 +1693,7 @@ void PassthroughRendererDX11::RenderMaskedPrepassView(const ERenderEye eye, cons
 	m_renderContext->PSSetShader(m_maskedPrepassShader.Get(), nullptr, 0);
 
 	// Draw with simple vertex shader if we don't need to sample camera
-	if (!bCompositeDepth && !m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage)
+	if (!bCompositeDepth && !config->Core.CoreForceMaskedUseCameraImage)
 	{
 		m_renderContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 		m_renderContext->VSSetShader(m_fullscreenQuadShader.Get(), nullptr, 0);
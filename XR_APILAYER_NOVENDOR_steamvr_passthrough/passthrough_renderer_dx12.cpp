@@ -217,31 +217,19 @@ inline void TransitionResource(ID3D12GraphicsCommandList* commandList, ID3D12Res
 }
 
 
-void UploadTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, ID3D12Resource* uploadHeap, size_t heapOffset, uint8_t* image, uint32_t textureWidth, uint32_t textureHeight, DXGI_FORMAT format, uint32_t pixelSize, uint32_t subResource)
+void CopyUploadHeapToTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, ID3D12Resource* uploadHeap, size_t heapOffset, uint32_t textureWidth, uint32_t textureHeight, DXGI_FORMAT format, uint32_t rowPitch, uint32_t subResource)
 {
 	D3D12_SUBRESOURCE_FOOTPRINT pitchedDesc = {};
 	pitchedDesc.Format = format;
 	pitchedDesc.Width = textureWidth;
 	pitchedDesc.Height = textureHeight;
 	pitchedDesc.Depth = 1;
-	pitchedDesc.RowPitch = Align(textureWidth * pixelSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	pitchedDesc.RowPitch = rowPitch;
 
 	D3D12_PLACED_SUBRESOURCE_FOOTPRINT placedTexture2D = {};
 	placedTexture2D.Offset = heapOffset;
 	placedTexture2D.Footprint = pitchedDesc;
 
-	uint8_t* dataPtr;
-	uploadHeap->Map(0, nullptr, reinterpret_cast<void**>(&dataPtr));
-
-	for (uint32_t i = 0; i < textureHeight; i++)
-	{
-		size_t inOffset = textureWidth * pixelSize * i;
-		size_t outOffset = pitchedDesc.RowPitch * i;
-		memcpy(dataPtr + heapOffset + outOffset, image + inOffset, textureWidth * pixelSize);
-	}
-
-	uploadHeap->Unmap(0, nullptr);
-
 	D3D12_TEXTURE_COPY_LOCATION copyDest = {};
 	copyDest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
 	copyDest.pResource = texture;
@@ -256,6 +244,28 @@ void UploadTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* textu
 }
 
 
+void UploadTexture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, ID3D12Resource* uploadHeap, size_t heapOffset, uint8_t* image, uint32_t textureWidth, uint32_t textureHeight, DXGI_FORMAT format, uint32_t pixelSize, uint32_t subResource)
+{
+	uint32_t rowPitch = Align(textureWidth * pixelSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+	uint8_t* dataPtr;
+	uploadHeap->Map(0, nullptr, reinterpret_cast<void**>(&dataPtr));
+
+	CopyRows(dataPtr + heapOffset, rowPitch, image, textureWidth * pixelSize, textureWidth * pixelSize, textureHeight);
+
+	uploadHeap->Unmap(0, nullptr);
+
+	CopyUploadHeapToTexture(commandList, texture, uploadHeap, heapOffset, textureWidth, textureHeight, format, rowPitch, subResource);
+}
+
+
+// Upload size of a texture in the staging ring, with the rows padded to the required pitch.
+inline size_t GetStagedTextureSize(uint32_t textureWidth, uint32_t textureHeight, uint32_t pixelSize)
+{
+	return (size_t)Align(textureWidth * pixelSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * textureHeight;
+}
+
+
 
 
 
@@ -269,6 +279,7 @@ PassthroughRendererDX12::PassthroughRendererDX12(ID3D12Device* device, ID3D12Com
 	, m_cameraFrameBufferSize(0)
 	, m_selectedDebugTexture(DebugTexture_None)
 	, m_bUsingDepth(false)
+	, m_stagingStallCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_STAGING_STALLS))
 {
 	memset(m_vsPassConstantBufferCPUData, 0, sizeof(m_vsPassConstantBufferCPUData));
 	memset(m_vsViewConstantBufferCPUData, 0, sizeof(m_vsViewConstantBufferCPUData));
@@ -276,7 +287,21 @@ PassthroughRendererDX12::PassthroughRendererDX12(ID3D12Device* device, ID3D12Com
 	memset(m_psViewConstantBufferCPUData, 0, sizeof(m_psViewConstantBufferCPUData));
 	memset(m_psMaskedConstantBufferCPUData, 0, sizeof(m_psMaskedConstantBufferCPUData));
 
-	m_bUseHexagonGridMesh = m_configManager->GetConfig_Stereo().StereoUseHexagonGridMesh;
+	m_bUseHexagonGridMesh = m_configManager->GetConfigSnapshot()->Stereo.StereoUseHexagonGridMesh;
+}
+
+
+PassthroughRendererDX12::~PassthroughRendererDX12()
+{
+	if (m_uploadFence.Get())
+	{
+		WaitForUploadFence(m_uploadFenceValue);
+	}
+
+	if (m_uploadFenceEvent)
+	{
+		CloseHandle(m_uploadFenceEvent);
+	}
 }
 
 
@@ -344,6 +369,14 @@ bool PassthroughRendererDX12::InitRenderer()
 		return false;
 	}
 
+	m_uploadFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	if (FAILED(m_d3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_uploadFence))) || !m_uploadFenceEvent)
+	{
+		ErrorLog("Failed to create D3D12 upload fence.\n");
+		return false;
+	}
+
 	SetupFrameResource();
 	GenerateMesh();
 
@@ -351,6 +384,8 @@ bool PassthroughRendererDX12::InitRenderer()
 	ID3D12CommandList* commandLists[] = { m_commandList.Get() };
 	m_d3dCommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
 
+	SignalUploadFence();
+
 	return true;
 }
 
@@ -468,12 +503,15 @@ void PassthroughRendererDX12::SetupFrameResource()
 		m_d3dDevice->CreateShaderResourceView(m_cameraFrameRes[i].Get(), nullptr, srvHandle);
 	}
 
-	m_frameResUploadHeap = CreateBuffer(m_d3dDevice.Get(), m_cameraFrameBufferSize * NUM_SWAPCHAINS, D3D12_HEAP_TYPE_UPLOAD);
+	m_stagingCameraFrameSize = GetStagedTextureSize(m_cameraTextureWidth, m_cameraTextureHeight, 4);
+	SetupStagingRing();
 
 	for (int i = 0; i < NUM_SWAPCHAINS; i++)
 	{
-		UploadTexture(m_commandList.Get(), m_cameraFrameRes[i].Get(), m_frameResUploadHeap.Get(), m_cameraFrameBufferSize * i, image.data(), m_cameraTextureWidth, m_cameraTextureHeight, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4, 0);
+		UploadTextureStaged(m_cameraFrameRes[i].Get(), image.data(), m_cameraTextureWidth, m_cameraTextureHeight, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4);
 	}
+
+	m_uploadTracker.Invalidate(UploadResource_CameraFrame);
 }
 
 
@@ -502,11 +540,94 @@ void PassthroughRendererDX12::SetupDisparityMap(uint32_t width, uint32_t height)
 
 		m_d3dDevice->CreateShaderResourceView(m_disparityMap[i].Get(), nullptr, srvHandle);
 	}
+}
+
+
+// Grows the staging ring to hold the camera and disparity uploads of every frame in flight.
+// This waits for the GPU and replaces the staging buffer, so it must be called before the command list is reset for a frame.
+void PassthroughRendererDX12::SetupStagingRing()
+{
+	size_t capacity = (m_stagingCameraFrameSize + m_stagingDisparityMapSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT * 2) * NUM_SWAPCHAINS;
+
+	if (capacity <= m_stagingRing.GetCapacity())
+	{
+		return;
+	}
+
+	WaitForUploadFence(m_uploadFenceValue);
+
+	if (m_stagingBuffer.Get())
+	{
+		m_stagingBuffer->Unmap(0, nullptr);
+	}
 
-	int rowPitch = Align(width * sizeof(uint16_t) * 2, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-	int heapSize = Align(rowPitch * height, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * NUM_SWAPCHAINS;
+	m_stagingBuffer = CreateBuffer(m_d3dDevice.Get(), (uint32_t)capacity, D3D12_HEAP_TYPE_UPLOAD);
+	m_stagingBufferCPUData = nullptr;
 
-	m_disparityMapUploadHeap = CreateBuffer(m_d3dDevice.Get(), heapSize, D3D12_HEAP_TYPE_UPLOAD);
+	if (!m_stagingBuffer.Get() || FAILED(m_stagingBuffer->Map(0, nullptr, reinterpret_cast<void**>(&m_stagingBufferCPUData))))
+	{
+		ErrorLog("Failed to create D3D12 staging buffer.\n");
+		m_stagingBuffer.Reset();
+		m_stagingBufferCPUData = nullptr;
+		m_stagingRing.Reset(0);
+		return;
+	}
+
+	m_stagingRing.Reset(capacity);
+}
+
+
+void PassthroughRendererDX12::SignalUploadFence()
+{
+	m_uploadFenceValue++;
+	m_d3dCommandQueue->Signal(m_uploadFence.Get(), m_uploadFenceValue);
+	m_stagingRing.EndFrame(m_uploadFenceValue);
+}
+
+
+void PassthroughRendererDX12::WaitForUploadFence(uint64_t fenceValue)
+{
+	if (m_uploadFence->GetCompletedValue() >= fenceValue)
+	{
+		return;
+	}
+
+	m_uploadFence->SetEventOnCompletion(fenceValue, m_uploadFenceEvent);
+	WaitForSingleObject(m_uploadFenceEvent, INFINITE);
+}
+
+
+bool PassthroughRendererDX12::UploadTextureStaged(ID3D12Resource* texture, const uint8_t* image, uint32_t textureWidth, uint32_t textureHeight, DXGI_FORMAT format, uint32_t pixelSize)
+{
+	if (!m_stagingBufferCPUData)
+	{
+		return false;
+	}
+
+	uint32_t rowPitch = Align(textureWidth * pixelSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	size_t offset = 0;
+
+	// If the ring is full, wait for the oldest submission still using it.
+	while (!m_stagingRing.Allocate((size_t)rowPitch * textureHeight, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, offset))
+	{
+		uint64_t oldestFenceValue = m_stagingRing.GetOldestFenceValue();
+
+		if (oldestFenceValue == 0)
+		{
+			ErrorLog("Staging ring too small for texture upload.\n");
+			return false;
+		}
+
+		m_stagingStallCounter.Add();
+		WaitForUploadFence(oldestFenceValue);
+		m_stagingRing.Retire(m_uploadFence->GetCompletedValue());
+	}
+
+	CopyRows(m_stagingBufferCPUData + offset, rowPitch, image, textureWidth * pixelSize, textureWidth * pixelSize, textureHeight);
+
+	CopyUploadHeapToTexture(m_commandList.Get(), texture, m_stagingBuffer.Get(), offset, textureWidth, textureHeight, format, rowPitch, 0);
+
+	return true;
 }
 
 
@@ -811,7 +932,7 @@ bool PassthroughRendererDX12::InitPipeline()
 
 	D3D12_DEPTH_STENCIL_DESC depthStencilPrepass{};
 	depthStencilPrepass.DepthEnable = m_bUsingDepth;
-	depthStencilPrepass.DepthFunc = ((m_blendMode == Masked) ? (m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage == m_bUsingReversedDepth) : m_bUsingReversedDepth) ? D3D12_COMPARISON_FUNC_GREATER_EQUAL :
+	depthStencilPrepass.DepthFunc = ((m_blendMode == Masked) ? (m_configManager->GetConfigSnapshot()->Core.CoreForceMaskedUseCameraImage == m_bUsingReversedDepth) : m_bUsingReversedDepth) ? D3D12_COMPARISON_FUNC_GREATER_EQUAL :
 			D3D12_COMPARISON_FUNC_LESS_EQUAL;
 	depthStencilPrepass.DepthWriteMask = m_bWriteDepth ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
 
@@ -1045,9 +1166,9 @@ void PassthroughRendererDX12::GenerateMesh()
 
 void PassthroughRendererDX12::GenerateDepthMesh(uint32_t width, uint32_t height)
 {
-	m_bUseHexagonGridMesh ? MeshCreateHexGrid(m_gridMesh, width, height) : MeshCreateGrid(m_gridMesh, width, height);
+	m_gridMesh = MeshGetGrid(width, height, m_bUseHexagonGridMesh);
 
-	uint32_t bufferSize = (uint32_t)(m_gridMesh.vertices.size() * sizeof(VertexFormatBasic));
+	uint32_t bufferSize = (uint32_t)(m_gridMesh->vertices.size() * sizeof(VertexFormatBasic));
 
 	m_gridMeshVertexBuffer = CreateBuffer(m_d3dDevice.Get(), bufferSize, D3D12_HEAP_TYPE_DEFAULT);
 	m_gridMeshVertexBufferUpload = CreateBuffer(m_d3dDevice.Get(), bufferSize, D3D12_HEAP_TYPE_UPLOAD);
@@ -1056,19 +1177,19 @@ void PassthroughRendererDX12::GenerateDepthMesh(uint32_t width, uint32_t height)
 	const D3D12_RANGE readRange{ 0, 0 };
 
 	m_gridMeshVertexBufferUpload->Map(0, &readRange, &mappedData);
-	memcpy(mappedData, m_gridMesh.vertices.data(), bufferSize);
+	memcpy(mappedData, m_gridMesh->vertices.data(), bufferSize);
 	m_gridMeshVertexBufferUpload->Unmap(0, nullptr);
 
 	m_commandList->CopyBufferRegion(m_gridMeshVertexBuffer.Get(), 0, m_gridMeshVertexBufferUpload.Get(), 0, bufferSize);
 	TransitionResource(m_commandList.Get(), m_gridMeshVertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 
-	bufferSize = (uint32_t)(m_gridMesh.triangles.size() * sizeof(MeshTriangle));
+	bufferSize = m_gridMesh->GetIndexDataSize();
 
 	m_gridMeshIndexBuffer = CreateBuffer(m_d3dDevice.Get(), bufferSize, D3D12_HEAP_TYPE_DEFAULT);
 	m_gridMeshIndexBufferUpload = CreateBuffer(m_d3dDevice.Get(), bufferSize, D3D12_HEAP_TYPE_UPLOAD);
 
 	m_gridMeshIndexBufferUpload->Map(0, &readRange, &mappedData);
-	memcpy(mappedData, m_gridMesh.triangles.data(), bufferSize);
+	memcpy(mappedData, m_gridMesh->GetIndexData(), bufferSize);
 	m_gridMeshIndexBufferUpload->Unmap(0, nullptr);
 
 	m_commandList->CopyBufferRegion(m_gridMeshIndexBuffer.Get(), 0, m_gridMeshIndexBufferUpload.Get(), 0, bufferSize);
@@ -1081,10 +1202,11 @@ void PassthroughRendererDX12::GenerateDepthMesh(uint32_t width, uint32_t height)
 
 void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerProjection* layer, CameraFrame* frame, EPassthroughBlendMode blendMode, int leftSwapchainIndex, int rightSwapchainIndex, std::shared_ptr<DepthFrame> depthFrame, UVDistortionParameters& distortionParams, FrameRenderParameters& renderParams)
 {
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Core& coreConf = m_configManager->GetConfig_Core();
-	Config_Stereo& stereoConf = m_configManager->GetConfig_Stereo();
-	Config_Depth& depthConf = m_configManager->GetConfig_Depth();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
+	const Config_Core& coreConf = config->Core;
+	const Config_Stereo& stereoConf = config->Stereo;
+	const Config_Depth& depthConf = config->Depth;
 
 	if (mainConf.ProjectionMode == Projection_StereoReconstruction && !depthFrame->bIsValid)
 	{
@@ -1109,10 +1231,19 @@ void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerPro
 		}
 	}
 
+	if (m_bUsingStereo)
+	{
+		std::shared_lock readLock(depthFrame->readWriteMutex);
+		m_stagingDisparityMapSize = GetStagedTextureSize(depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1], sizeof(uint16_t) * 2);
+	}
+	SetupStagingRing();
+
 	ComPtr<ID3D12CommandAllocator> commandAllocator = m_commandAllocators[m_frameIndex];
 
 	commandAllocator->Reset();
 	m_commandList->Reset(commandAllocator.Get(), nullptr);
+
+	m_stagingRing.Retire(m_uploadFence->GetCompletedValue());
 	m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
 	m_commandList->SetDescriptorHeaps(1, m_CBVSRVHeap.GetAddressOf());
 
@@ -1138,24 +1269,33 @@ void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerPro
 	{
 		std::shared_lock readLock(depthFrame->readWriteMutex);
 
+		bool bRecreatedDisparityMap = false;
+
 		if (depthFrame->disparityTextureSize[0] != m_disparityMapWidth || stereoConf.StereoUseHexagonGridMesh != m_bUseHexagonGridMesh)
 		{
 			m_disparityMapWidth = depthFrame->disparityTextureSize[0];
 			m_bUseHexagonGridMesh = stereoConf.StereoUseHexagonGridMesh;
 			SetupDisparityMap(depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1]);
 			GenerateDepthMesh(depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1]);
-		}
-		else
-		{
-			TransitionResource(m_commandList.Get(), m_disparityMap[m_frameIndex].Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+			m_uploadTracker.Invalidate(UploadResource_DisparityMap);
+			bRecreatedDisparityMap = true;
 		}
 
-		int rowPitch = Align(depthFrame->disparityTextureSize[0] * sizeof(uint16_t) * 2, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-		size_t disparityTextureSize = Align(depthFrame->disparityTextureSize[1] * rowPitch, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+		size_t disparityTextureSize = GetStagedTextureSize(depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1], sizeof(uint16_t) * 2);
 
-		UploadTexture(m_commandList.Get(), m_disparityMap[m_frameIndex].Get(), m_disparityMapUploadHeap.Get(), disparityTextureSize * m_frameIndex, (uint8_t*)depthFrame->disparityMap->data(), depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1], DXGI_FORMAT_R16G16_SNORM, sizeof(uint16_t) * 2, 0);
+		// The transitions are skipped along with the upload when the slot already holds this depth frame.
+		m_uploadTracker.Upload(UploadResource_DisparityMap, m_frameIndex, depthFrame->generation, disparityTextureSize, [&]()
+		{
+			if (!bRecreatedDisparityMap)
+			{
+				TransitionResource(m_commandList.Get(), m_disparityMap[m_frameIndex].Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+			}
+
+			bool bUploaded = UploadTextureStaged(m_disparityMap[m_frameIndex].Get(), (uint8_t*)depthFrame->disparityMap->data(), depthFrame->disparityTextureSize[0], depthFrame->disparityTextureSize[1], DXGI_FORMAT_R16G16_SNORM, sizeof(uint16_t) * 2);
 
-		TransitionResource(m_commandList.Get(), m_disparityMap[m_frameIndex].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			TransitionResource(m_commandList.Get(), m_disparityMap[m_frameIndex].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			return bUploaded;
+		});
 
 		D3D12_GPU_DESCRIPTOR_HANDLE disparitySRVHandle = m_CBVSRVHeap->GetGPUDescriptorHandleForHeapStart();
 		disparitySRVHandle.ptr += (INDEX_SRV_DISPARITY_0 + m_frameIndex) * m_CBVSRVHeapDescSize;
@@ -1186,15 +1326,15 @@ void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerPro
 
 	if (mainConf.ProjectionMode == Projection_StereoReconstruction)
 	{
-		numIndices = (UINT)m_gridMesh.triangles.size() * 3;
+		numIndices = m_gridMesh->numIndices;
 
 		vertexBufferView.BufferLocation = m_gridMeshVertexBuffer->GetGPUVirtualAddress();
-		vertexBufferView.SizeInBytes = (UINT)m_gridMesh.vertices.size() * sizeof(VertexFormatBasic);
+		vertexBufferView.SizeInBytes = (UINT)m_gridMesh->vertices.size() * sizeof(VertexFormatBasic);
 		vertexBufferView.StrideInBytes = sizeof(VertexFormatBasic);
 
 		indexBufferView.BufferLocation = m_gridMeshIndexBuffer->GetGPUVirtualAddress();
-		indexBufferView.SizeInBytes = (UINT)m_gridMesh.triangles.size() * sizeof(MeshTriangle);
-		indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+		indexBufferView.SizeInBytes = m_gridMesh->GetIndexDataSize();
+		indexBufferView.Format = m_gridMesh->Uses16BitIndices() ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 	}
 	else
 	{
@@ -1219,7 +1359,7 @@ void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerPro
 	if (mainConf.DebugTexture != DebugTexture_None)
 	{
 		DebugTexture& texture = m_configManager->GetDebugTexture();
-		std::lock_guard<std::mutex> readlock(texture.RWMutex);
+		std::lock_guard<ProfiledMutex> readlock(texture.RWMutex);
 
 		if (texture.CurrentTexture == mainConf.DebugTexture)
 		{
@@ -1275,12 +1415,16 @@ void PassthroughRendererDX12::RenderPassthroughFrame(const XrCompositionLayerPro
 	}
 	else
 	{
-		// Upload camera frame
-		TransitionResource(m_commandList.Get(), m_cameraFrameRes[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+		// Upload camera frame, unless this slot already holds it.
+		m_uploadTracker.Upload(UploadResource_CameraFrame, m_frameIndex, frame->header.nFrameSequence, m_cameraFrameBufferSize, [&]()
+		{
+			TransitionResource(m_commandList.Get(), m_cameraFrameRes[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
 
-		UploadTexture(m_commandList.Get(), m_cameraFrameRes[m_frameIndex].Get(), m_frameResUploadHeap.Get(), m_cameraFrameBufferSize * m_frameIndex, frame->frameBuffer->data(), m_cameraTextureWidth, m_cameraTextureHeight, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4, 0);
+			bool bUploaded = UploadTextureStaged(m_cameraFrameRes[m_frameIndex].Get(), frame->frameBuffer->data(), m_cameraTextureWidth, m_cameraTextureHeight, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4);
 
-		TransitionResource(m_commandList.Get(), m_cameraFrameRes[m_frameIndex].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			TransitionResource(m_commandList.Get(), m_cameraFrameRes[m_frameIndex].Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			return bUploaded;
+		});
 
 		D3D12_GPU_DESCRIPTOR_HANDLE frameSRVHandle = m_CBVSRVHeap->GetGPUDescriptorHandleForHeapStart();
 		frameSRVHandle.ptr += (INDEX_SRV_CAMERAFRAME_0 + m_frameIndex) * m_CBVSRVHeapDescSize;
@@ -1364,8 +1508,9 @@ void PassthroughRendererDX12::RenderPassthroughView(const ERenderEye eye, const
 
 	m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Stereo& stereoConf = m_configManager->GetConfig_Stereo();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
+	const Config_Stereo& stereoConf = config->Stereo;
 
 	VSViewConstantBuffer* vsViewBuffer = (VSViewConstantBuffer*)m_vsViewConstantBufferCPUData[bufferIndex];
 	vsViewBuffer->cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1393,7 +1538,7 @@ void PassthroughRendererDX12::RenderPassthroughView(const ERenderEye eye, const
 	m_commandList->SetGraphicsRootDescriptorTable(1, cbvPSHandle);
 
 	// Extra draw if we need to preadjust the alpha.
-	if (blendMode != Masked && ((blendMode != AlphaBlendPremultiplied && blendMode != AlphaBlendUnpremultiplied) || m_configManager->GetConfig_Main().PassthroughOpacity < 1.0f || m_bUsingDepth))
+	if (blendMode != Masked && ((blendMode != AlphaBlendPremultiplied && blendMode != AlphaBlendUnpremultiplied) || config->Main.PassthroughOpacity < 1.0f || m_bUsingDepth))
 	{
 		m_commandList->SetPipelineState(m_psoPrepass.Get());
 		m_commandList->DrawIndexedInstanced(numIndices, 1, 0, 0, 0);
@@ -1474,12 +1619,12 @@ void PassthroughRendererDX12::RenderPassthroughView(const ERenderEye eye, const
 
 
 		vertexBufferView.BufferLocation = m_gridMeshVertexBuffer->GetGPUVirtualAddress();
-		vertexBufferView.SizeInBytes = (UINT)m_gridMesh.vertices.size() * sizeof(VertexFormatBasic);
+		vertexBufferView.SizeInBytes = (UINT)m_gridMesh->vertices.size() * sizeof(VertexFormatBasic);
 		vertexBufferView.StrideInBytes = sizeof(VertexFormatBasic);
 
 		indexBufferView.BufferLocation = m_gridMeshIndexBuffer->GetGPUVirtualAddress();
-		indexBufferView.SizeInBytes = (UINT)m_gridMesh.triangles.size() * sizeof(MeshTriangle);
-		indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+		indexBufferView.SizeInBytes = m_gridMesh->GetIndexDataSize();
+		indexBufferView.Format = m_gridMesh->Uses16BitIndices() ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 
 		m_commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
 		m_commandList->IASetIndexBuffer(&indexBufferView);
@@ -1508,7 +1653,8 @@ void PassthroughRendererDX12::RenderMaskedPrepassView(const ERenderEye eye, cons
 	m_commandList->RSSetViewports(1, &viewport);
 	m_commandList->RSSetScissorRects(1, &scissor);
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
 
 	VSViewConstantBuffer* vsViewBuffer = (VSViewConstantBuffer*)m_vsViewConstantBufferCPUData[bufferIndex];
 	vsViewBuffer->cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1564,13 +1710,13 @@ void PassthroughRendererDX12::RenderMaskedPrepassView(const ERenderEye eye, cons
 
 	if (eye == LEFT_EYE || !bSingleStereoRenderTarget)
 	{
-		float clearColor[4] = { m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage ? 1.0f : 0, 0, 0, 0 };
+		float clearColor[4] = { config->Core.CoreForceMaskedUseCameraImage ? 1.0f : 0, 0, 0, 0 };
 		m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, NULL);
 	}
 
 	D3D12_GPU_DESCRIPTOR_HANDLE cameraFrameSRVHandle = m_CBVSRVHeap->GetGPUDescriptorHandleForHeapStart();
 
-	if (m_configManager->GetConfig_Main().DebugTexture != DebugTexture_None)
+	if (config->Main.DebugTexture != DebugTexture_None)
 	{
 		cameraFrameSRVHandle.ptr += INDEX_SRV_DEBUG_TEXTURE * m_CBVSRVHeapDescSize;
 	}
@@ -1579,7 +1725,7 @@ void PassthroughRendererDX12::RenderMaskedPrepassView(const ERenderEye eye, cons
 		cameraFrameSRVHandle.ptr += (INDEX_SRV_CAMERAFRAME_0 + m_frameIndex) * m_CBVSRVHeapDescSize;
 	}
 
-	if (m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage)
+	if (config->Core.CoreForceMaskedUseCameraImage)
 	{
 		m_commandList->SetGraphicsRootDescriptorTable(3, cameraFrameSRVHandle);
 	}
@@ -1598,7 +1744,7 @@ void PassthroughRendererDX12::RenderMaskedPrepassView(const ERenderEye eye, cons
 	m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
 
 
-	if (bCompositeDepth || m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage)
+	if (bCompositeDepth || config->Core.CoreForceMaskedUseCameraImage)
 	{
 		m_commandList->SetPipelineState(m_psoPrepass.Get());
 		m_commandList->DrawIndexedInstanced(numIndices, 1, 0, 0, 0);
@@ -1641,6 +1787,8 @@ void PassthroughRendererDX12::RenderFrameFinish()
 	m_commandList->Close();
 	m_d3dCommandQueue->ExecuteCommandLists(1, (ID3D12CommandList* const*)m_commandList.GetAddressOf());
 
+	SignalUploadFence();
+
 	m_frameIndex = (m_frameIndex + 1) % NUM_SWAPCHAINS;
 }
 
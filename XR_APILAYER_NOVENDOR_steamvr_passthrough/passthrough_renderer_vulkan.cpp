@@ -19,6 +19,10 @@ using namespace steamvr_passthrough;
 using namespace steamvr_passthrough::log;
 
 
+// Offset alignment of the staged uploads, a multiple of the texel sizes used and of the 4 bytes required for buffer to image copies.
+#define VULKAN_STAGING_ALIGNMENT 16
+
+
 struct VSPassConstantBuffer
 {
 	XrMatrix4x4f disparityViewToWorldLeft;
@@ -276,8 +280,7 @@ PassthroughRendererVulkan::PassthroughRendererVulkan(const XrGraphicsBindingVulk
 	, m_uvDistortionMap(nullptr)
 	, m_uvDistortionMapView(nullptr)
 	, m_uvDistortionMapMem(nullptr)
-	, m_uvDistortionMapBuffer(nullptr)
-	, m_uvDistortionMapBufferMem(nullptr)
+	, m_stagingStallCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_STAGING_STALLS))
 {
 	m_instance = binding.instance;
 	m_physDevice = binding.physicalDevice;
@@ -374,6 +377,28 @@ bool PassthroughRendererVulkan::InitRenderer()
 
 		m_deletionQueue.push_back([=]() { vkFreeCommandBuffers(m_device, m_commandPool, NUM_SWAPCHAINS, m_commandBuffer); });
 		m_deletionQueue.push_back([=]() { vkDestroyCommandPool(m_device, m_commandPool, nullptr); });
+
+		VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+
+		for (int i = 0; i < NUM_SWAPCHAINS; i++)
+		{
+			if (vkCreateFence(m_device, &fenceInfo, nullptr, &m_frameFences[i]) != VK_SUCCESS)
+			{
+				ErrorLog("vkCreateFence failure!\n");
+				return false;
+			}
+			m_deletionQueue.push_back([=]() { vkDestroyFence(m_device, m_frameFences[i], nullptr); });
+		}
+
+		// The staging buffer is replaced when it grows, so the current one is destroyed.
+		m_deletionQueue.push_back([=]()
+		{
+			if (m_stagingBuffer)
+			{
+				vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+				vkFreeMemory(m_device, m_stagingBufferMem, nullptr);
+			}
+		});
 	}
 
 	m_fullscreenQuadShader = CreateShaderModule(g_FullscreenQuadShaderVS, ARRAYSIZE(g_FullscreenQuadShaderVS) * sizeof(g_FullscreenQuadShaderVS[0]));
@@ -1172,26 +1197,13 @@ void PassthroughRendererVulkan::SetupUVDistortionMap(std::shared_ptr<std::vector
 	{
 		vkDestroyImage(m_device, m_uvDistortionMap, nullptr);
 		vkDestroyImageView(m_device, m_uvDistortionMapView, nullptr);
-		vkDestroyBuffer(m_device, m_uvDistortionMapBuffer, nullptr);
 		vkFreeMemory(m_device, m_uvDistortionMapMem, nullptr);
 
 		m_uvDistortionMap = nullptr;
 		m_uvDistortionMapView = nullptr;
-		m_uvDistortionMapBuffer = nullptr;
 		m_uvDistortionMapMem = nullptr;
 	}
 
-	if (!CreateBuffer(m_device, m_physDevice, m_uvDistortionMapBuffer, m_uvDistortionMapBufferMem, uvDistortionMap->size() * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &m_deletionQueue))
-	{
-		ErrorLog("UV distortion map buffer creation failure!\n");
-		return;
-	}
-
-	void* mappedData;
-	vkMapMemory(m_device, m_uvDistortionMapBufferMem, 0, uvDistortionMap->size() * sizeof(float), 0, &mappedData);
-	memcpy(mappedData, uvDistortionMap->data(), uvDistortionMap->size() * sizeof(float));
-	vkUnmapMemory(m_device, m_uvDistortionMapBufferMem);
-
 
 	VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -1267,15 +1279,134 @@ void PassthroughRendererVulkan::SetupUVDistortionMap(std::shared_ptr<std::vector
 		return;
 	}
 
-	UploadImage(m_commandBuffer[m_frameIndex], m_device, m_uvDistortionMapBuffer, m_uvDistortionMap, { m_cameraTextureWidth, m_cameraTextureHeight, 1 }, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	UploadImageStaged(m_commandBuffer[m_frameIndex], m_uvDistortionMap, (const uint8_t*)uvDistortionMap->data(), m_cameraTextureWidth, m_cameraTextureHeight, 2 * sizeof(float), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
 	m_deletionQueue.push_back([=]() { vkDestroyImage(m_device, m_uvDistortionMap, nullptr); });
-	m_deletionQueue.push_back([=]() { vkDestroyBuffer(m_device, m_uvDistortionMapBuffer, nullptr); });
 	m_deletionQueue.push_back([=]() { vkDestroyImageView(m_device, m_uvDistortionMapView, nullptr); });
 	m_deletionQueue.push_back([=]() { vkFreeMemory(m_device, m_uvDistortionMapMem, nullptr); });
 }
 
 
+// Grows the staging ring to hold the uploads of a frame. This waits for the GPU and replaces the staging buffer,
+// so it must be called before the command buffer of the frame is begun.
+void PassthroughRendererVulkan::SetupStagingRing(size_t capacity)
+{
+	if (capacity <= m_stagingRing.GetCapacity())
+	{
+		return;
+	}
+
+	WaitForFrameFence(m_submittedFenceValue);
+
+	if (m_stagingBuffer)
+	{
+		vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+		vkFreeMemory(m_device, m_stagingBufferMem, nullptr);
+	}
+
+	m_stagingBuffer = VK_NULL_HANDLE;
+	m_stagingBufferMem = VK_NULL_HANDLE;
+	m_stagingBufferCPUData = nullptr;
+	m_stagingRing.Reset(0);
+
+	if (!CreateBuffer(m_device, m_physDevice, m_stagingBuffer, m_stagingBufferMem, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, nullptr))
+	{
+		ErrorLog("Failed to create Vulkan staging buffer.\n");
+		m_stagingBuffer = VK_NULL_HANDLE;
+		m_stagingBufferMem = VK_NULL_HANDLE;
+		return;
+	}
+
+	if (vkMapMemory(m_device, m_stagingBufferMem, 0, capacity, 0, (void**)&m_stagingBufferCPUData) != VK_SUCCESS)
+	{
+		ErrorLog("Failed to map Vulkan staging buffer.\n");
+		vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+		vkFreeMemory(m_device, m_stagingBufferMem, nullptr);
+		m_stagingBuffer = VK_NULL_HANDLE;
+		m_stagingBufferMem = VK_NULL_HANDLE;
+		m_stagingBufferCPUData = nullptr;
+		return;
+	}
+
+	m_stagingRing.Reset(capacity);
+}
+
+
+// Submissions may finish out of order, so the completed value is the one below the oldest submission still running.
+uint64_t PassthroughRendererVulkan::GetCompletedFenceValue()
+{
+	uint64_t completedValue = m_submittedFenceValue;
+
+	for (int i = 0; i < NUM_SWAPCHAINS; i++)
+	{
+		if (m_frameFenceValues[i] != 0 && m_frameFenceValues[i] <= completedValue && vkGetFenceStatus(m_device, m_frameFences[i]) != VK_SUCCESS)
+		{
+			completedValue = m_frameFenceValues[i] - 1;
+		}
+	}
+
+	return completedValue;
+}
+
+
+void PassthroughRendererVulkan::WaitForFrameFence(uint64_t fenceValue)
+{
+	for (int i = 0; i < NUM_SWAPCHAINS; i++)
+	{
+		if (m_frameFenceValues[i] != 0 && m_frameFenceValues[i] <= fenceValue)
+		{
+			vkWaitForFences(m_device, 1, &m_frameFences[i], VK_TRUE, UINT64_MAX);
+		}
+	}
+}
+
+
+bool PassthroughRendererVulkan::UploadImageStaged(VkCommandBuffer commandBuffer, VkImage image, const uint8_t* data, uint32_t width, uint32_t height, uint32_t pixelSize, VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+	if (!m_stagingBufferCPUData)
+	{
+		return false;
+	}
+
+	size_t rowSize = (size_t)width * pixelSize;
+	size_t offset = 0;
+
+	// If the ring is full, wait for the oldest submission still using it.
+	while (!m_stagingRing.Allocate(rowSize * height, VULKAN_STAGING_ALIGNMENT, offset))
+	{
+		uint64_t oldestFenceValue = m_stagingRing.GetOldestFenceValue();
+
+		if (oldestFenceValue == 0)
+		{
+			ErrorLog("Staging ring too small for image upload.\n");
+			return false;
+		}
+
+		m_stagingStallCounter.Add();
+		WaitForFrameFence(oldestFenceValue);
+		m_stagingRing.Retire(GetCompletedFenceValue());
+	}
+
+	CopyRows(m_stagingBufferCPUData + offset, rowSize, data, rowSize, rowSize, height);
+
+	TransitionImage(commandBuffer, image, oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = offset;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { width, height, 1 };
+
+	vkCmdCopyBufferToImage(commandBuffer, m_stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	TransitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, newLayout);
+
+	return true;
+}
+
+
 void PassthroughRendererVulkan::SetupIntermediateRenderTarget(uint32_t index, uint32_t width, uint32_t height)
 {
 
@@ -1534,7 +1665,7 @@ void PassthroughRendererVulkan::UpdateDescriptorSets(VkCommandBuffer commandBuff
 	VkDescriptorImageInfo cameraImageInfo{};
 	cameraImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-	if (m_configManager->GetConfig_Main().DebugTexture != DebugTexture_None)
+	if (m_configManager->GetConfigSnapshot()->Main.DebugTexture != DebugTexture_None)
 	{
 		cameraImageInfo.imageView = m_testPatternView;
 		cameraImageInfo.sampler = m_cameraSampler;
@@ -1648,11 +1779,11 @@ void PassthroughRendererVulkan::UpdateDescriptorSets(VkCommandBuffer commandBuff
 		descriptorWrite[7].dstArrayElement = 0;
 		descriptorWrite[7].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		descriptorWrite[7].descriptorCount = 1;
-		descriptorWrite[7].pImageInfo = m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage ? &cameraImageArrayInfo : &originalRTImageInfo;
+		descriptorWrite[7].pImageInfo = m_configManager->GetConfigSnapshot()->Core.CoreForceMaskedUseCameraImage ? &cameraImageArrayInfo : &originalRTImageInfo;
 
 		numdescriptors = 8;
 
-		if (m_configManager->GetConfig_Main().ProjectionMode != Projection_RoomView2D)
+		if (m_configManager->GetConfigSnapshot()->Main.ProjectionMode != Projection_RoomView2D)
 		{
 			uvDistortionImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			uvDistortionImageInfo.imageView = m_uvDistortionMapView;
@@ -1669,7 +1800,7 @@ void PassthroughRendererVulkan::UpdateDescriptorSets(VkCommandBuffer commandBuff
 			numdescriptors = 9;
 		}
 	}
-	else if (m_configManager->GetConfig_Main().ProjectionMode != Projection_RoomView2D)
+	else if (m_configManager->GetConfigSnapshot()->Main.ProjectionMode != Projection_RoomView2D)
 	{
 		uvDistortionImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		uvDistortionImageInfo.imageView = m_uvDistortionMapView;
@@ -1710,8 +1841,9 @@ static bool g_bVulkanStereoErrorShown = false;
 void PassthroughRendererVulkan::RenderPassthroughFrame(const XrCompositionLayerProjection* layer, CameraFrame* frame, EPassthroughBlendMode blendMode, int leftSwapchainIndex, int rightSwapchainIndex, std::shared_ptr<DepthFrame> depthFrame, UVDistortionParameters& distortionParams, FrameRenderParameters& renderParams)
 {
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
-	Config_Core& coreConf = m_configManager->GetConfig_Core();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
+	const Config_Core& coreConf = config->Core;
 
 	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 	beginInfo.flags = 0;
@@ -1727,6 +1859,15 @@ void PassthroughRendererVulkan::RenderPassthroughFrame(const XrCompositionLayerP
 		return;
 	}
 
+	// The command buffer may still be in use by the submission from NUM_SWAPCHAINS frames ago.
+	WaitForFrameFence(m_frameFenceValues[m_frameIndex]);
+
+	if (mainConf.ProjectionMode != Projection_RoomView2D)
+	{
+		SetupStagingRing((size_t)m_cameraTextureWidth * m_cameraTextureHeight * 2 * sizeof(float) + VULKAN_STAGING_ALIGNMENT);
+	}
+	m_stagingRing.Retire(GetCompletedFenceValue());
+
 	vkBeginCommandBuffer(m_commandBuffer[m_frameIndex], &beginInfo);
 
 
@@ -1805,7 +1946,19 @@ void PassthroughRendererVulkan::RenderPassthroughFrame(const XrCompositionLayerP
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &m_commandBuffer[m_frameIndex];
 
-	vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkResetFences(m_device, 1, &m_frameFences[m_frameIndex]);
+
+	if (vkQueueSubmit(m_queue, 1, &submitInfo, m_frameFences[m_frameIndex]) == VK_SUCCESS)
+	{
+		m_submittedFenceValue++;
+		m_frameFenceValues[m_frameIndex] = m_submittedFenceValue;
+		m_stagingRing.EndFrame(m_submittedFenceValue);
+	}
+	else
+	{
+		// Nothing will signal the fence, and the allocations stay with the next submission.
+		m_frameFenceValues[m_frameIndex] = 0;
+	}
 
 	m_frameIndex = (m_frameIndex + 1) % NUM_SWAPCHAINS;
 }
@@ -1847,7 +2000,8 @@ void PassthroughRendererVulkan::RenderPassthroughView(const ERenderEye eye, cons
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_cylinderMeshVertexBuffer, &vertOffset);
 		vkCmdBindIndexBuffer(commandBuffer, m_cylinderMeshIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-		Config_Main& mainConf = m_configManager->GetConfig_Main();
+		std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+		const Config_Main& mainConf = config->Main;
 
 		VSViewConstantBuffer vsViewBuffer = {};
 		vsViewBuffer.cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1873,7 +2027,7 @@ void PassthroughRendererVulkan::RenderPassthroughView(const ERenderEye eye, cons
 
 
 	// Extra draw if we need to preadjust the alpha.
-	if (blendMode != Masked && ((blendMode != AlphaBlendPremultiplied && blendMode != AlphaBlendUnpremultiplied) || m_configManager->GetConfig_Main().PassthroughOpacity < 1.0f))
+	if (blendMode != Masked && ((blendMode != AlphaBlendPremultiplied && blendMode != AlphaBlendUnpremultiplied) || m_configManager->GetConfigSnapshot()->Main.PassthroughOpacity < 1.0f))
 	{
 		VkPipeline prepassPipeline;
 
@@ -1957,7 +2111,8 @@ void PassthroughRendererVulkan::RenderMaskedPrepassView(const ERenderEye eye, co
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_cylinderMeshVertexBuffer, &vertOffset);
 	vkCmdBindIndexBuffer(commandBuffer, m_cylinderMeshIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-	Config_Main& mainConf = m_configManager->GetConfig_Main();
+	std::shared_ptr<const ConfigSnapshot> config = m_configManager->GetConfigSnapshot();
+	const Config_Main& mainConf = config->Main;
 
 	VSViewConstantBuffer vsViewBuffer = {};
 	vsViewBuffer.cameraProjectionToWorld = (eye == LEFT_EYE) ? frame->cameraProjectionToWorldLeft : frame->cameraProjectionToWorldRight;
@@ -1990,7 +2145,7 @@ void PassthroughRendererVulkan::RenderMaskedPrepassView(const ERenderEye eye, co
 
 	memcpy(m_psViewConstantBufferMappings[bufferIndex], &psViewBuffer, sizeof(PSViewConstantBuffer));
 
-	if (m_configManager->GetConfig_Core().CoreForceMaskedUseCameraImage)
+	if (config->Core.CoreForceMaskedUseCameraImage)
 	{
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineMaskedPrepass);
 		vkCmdDrawIndexed(commandBuffer, (uint32_t)m_cylinderMesh.triangles.size() * 3, 1, 0, 0, 0);
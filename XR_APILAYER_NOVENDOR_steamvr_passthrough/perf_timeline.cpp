@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "perf_timeline.h"
+#include <log.h>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+float PerfTimelineRing::GetLatestDurationMS() const
+{
+    uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+
+    if (index == 0)
+    {
+        return 0.0f;
+    }
+
+    uint64_t packed = m_samples[(index - 1) % PERF_TIMELINE_CAPACITY].load(std::memory_order_relaxed);
+    return ((packed >> PERF_TIMELINE_TIME_BITS) & PERF_TIMELINE_DURATION_MASK) / 1000.0f;
+}
+
+
+void PerfTimelineRing::Read(std::vector<PerfTimelineSample>& outSamples, uint64_t currentTimeNs, uint64_t windowNs) const
+{
+    uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+    uint64_t numSamples = std::min<uint64_t>(index, PERF_TIMELINE_CAPACITY);
+    uint64_t currentTimeUs = currentTimeNs / 1000;
+    size_t firstSample = outSamples.size();
+
+    for (uint64_t i = index - numSamples; i < index; i++)
+    {
+        uint64_t packed = m_samples[i % PERF_TIMELINE_CAPACITY].load(std::memory_order_relaxed);
+
+        if (packed == 0)
+        {
+            continue;
+        }
+
+        // The timestamps wrap around, but only the age relative to the current time is needed.
+        // Samples written after the current time was taken wrap to a large age and are skipped.
+        uint64_t ageNs = ((currentTimeUs - (packed & PERF_TIMELINE_TIME_MASK)) & PERF_TIMELINE_TIME_MASK) * 1000;
+
+        if (ageNs > windowNs)
+        {
+            continue;
+        }
+
+        PerfTimelineSample& sample = outSamples.emplace_back();
+        sample.timeNs = currentTimeNs - ageNs;
+        sample.durationMS = ((packed >> PERF_TIMELINE_TIME_BITS) & PERF_TIMELINE_DURATION_MASK) / 1000.0f;
+        sample.bFlagged = (packed >> (PERF_TIMELINE_TIME_BITS + PERF_TIMELINE_DURATION_BITS)) != 0;
+    }
+
+    // Slots being overwritten during the read can leave samples out of order.
+    std::sort(outSamples.begin() + firstSample, outSamples.end(), [](const PerfTimelineSample& a, const PerfTimelineSample& b) { return a.timeNs < b.timeNs; });
+}
+
+
+PerfTimelinePercentiles PerfTimelineGetPercentiles(const std::vector<PerfTimelineSample>& samples, uint64_t currentTimeNs, uint64_t windowNs)
+{
+    PerfTimelinePercentiles percentiles;
+    std::vector<float> durations;
+    durations.reserve(samples.size());
+
+    for (const PerfTimelineSample& sample : samples)
+    {
+        if (currentTimeNs - sample.timeNs <= windowNs)
+        {
+            durations.push_back(sample.durationMS);
+        }
+    }
+
+    if (durations.empty())
+    {
+        return percentiles;
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    auto rank = [&](float percentile)
+    {
+        size_t index = (size_t)ceilf(percentile / 100.0f * (float)durations.size());
+        return durations[std::clamp<size_t>(index, 1, durations.size()) - 1];
+    };
+
+    percentiles.numSamples = (uint32_t)durations.size();
+    percentiles.p50MS = rank(50.0f);
+    percentiles.p90MS = rank(90.0f);
+    percentiles.p99MS = rank(99.0f);
+    percentiles.maxMS = durations.back();
+
+    return percentiles;
+}
+
+
+PerfTimeline& PerfTimeline::Get()
+{
+    static PerfTimeline timeline;
+    return timeline;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+
+
+// Samples kept per series, a bit over 15 seconds of frames at 120 Hz.
+#define PERF_TIMELINE_CAPACITY 2048
+
+// Samples are packed into 64 bits: 40 bits of timestamp, 23 bits of duration and a flag, all in microseconds.
+#define PERF_TIMELINE_TIME_BITS 40
+#define PERF_TIMELINE_DURATION_BITS 23
+#define PERF_TIMELINE_TIME_MASK ((1ULL << PERF_TIMELINE_TIME_BITS) - 1)
+#define PERF_TIMELINE_DURATION_MASK ((1ULL << PERF_TIMELINE_DURATION_BITS) - 1)
+
+
+enum EPerfTimelineSeries
+{
+	PerfTimeline_FrameRetrieval = 0,
+	PerfTimeline_Reconstruction,
+	PerfTimeline_PassthroughRender,
+	PerfTimeline_CameraFramePeriod,
+	PerfTimeline_AppFramePeriod,
+	PerfTimeline_LayerEndFrameOverhead,
+	PerfTimeline_NumSeries
+};
+
+
+struct PerfTimelineSample
+{
+	uint64_t timeNs;
+	float durationMS;
+	bool bFlagged;
+};
+
+struct PerfTimelinePercentiles
+{
+	uint32_t numSamples = 0;
+	float p50MS = 0.0f;
+	float p90MS = 0.0f;
+	float p99MS = 0.0f;
+	float maxMS = 0.0f;
+};
+
+// Nearest rank duration percentiles of the samples newer than the window.
+PerfTimelinePercentiles PerfTimelineGetPercentiles(const std::vector<PerfTimelineSample>& samples, uint64_t currentTimeNs, uint64_t windowNs);
+
+
+// Ring of the latest samples of one series. Each sample is a single 64-bit word, so recording one is a relaxed store
+// and readers can never see a torn sample. There must only be one writer at a time, readers may see the
+// newest samples late or out of order, and sort them by time.
+class PerfTimelineRing
+{
+public:
+	void Record(uint64_t endTimeNs, uint64_t durationNs, bool bFlagged)
+	{
+		uint64_t timeUs = (endTimeNs / 1000) & PERF_TIMELINE_TIME_MASK;
+		uint64_t durationUs = std::min<uint64_t>(durationNs / 1000, PERF_TIMELINE_DURATION_MASK);
+		uint64_t packed = timeUs | (durationUs << PERF_TIMELINE_TIME_BITS) | ((uint64_t)bFlagged << (PERF_TIMELINE_TIME_BITS + PERF_TIMELINE_DURATION_BITS));
+
+		uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+		m_samples[index % PERF_TIMELINE_CAPACITY].store(packed, std::memory_order_relaxed);
+		m_writeIndex.store(index + 1, std::memory_order_relaxed);
+	}
+
+	// Duration of the newest sample, or 0 if there is none.
+	float GetLatestDurationMS() const;
+
+	// Appends the samples newer than the window, oldest first.
+	void Read(std::vector<PerfTimelineSample>& outSamples, uint64_t currentTimeNs, uint64_t windowNs) const;
+
+private:
+	std::array<std::atomic_uint64_t, PERF_TIMELINE_CAPACITY> m_samples = {};
+	std::atomic_uint64_t m_writeIndex{ 0 };
+};
+
+
+// Per-frame durations of the pipeline threads, and the camera and application frame periods, for the dashboard timeline.
+class PerfTimeline
+{
+public:
+	static PerfTimeline& Get();
+
+	void Record(EPerfTimelineSeries series, uint64_t endTimeNs, uint64_t durationNs, bool bFlagged = false)
+	{
+		m_series[series].Record(endTimeNs, durationNs, bFlagged);
+	}
+
+	const PerfTimelineRing& GetSeries(EPerfTimelineSeries series) const { return m_series[series]; }
+
+private:
+	PerfTimeline() {}
+
+	std::array<PerfTimelineRing, PerfTimeline_NumSeries> m_series;
+};
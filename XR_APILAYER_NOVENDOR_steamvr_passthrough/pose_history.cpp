@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "pose_history.h"
+#include <log.h>
+#include "layer.h"
+#include "trace.h"
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+static XrPosef ToXrPose(const vr::HmdMatrix34_t& input)
+{
+    const float (&m)[3][4] = input.m;
+    XrPosef pose;
+
+    pose.position = { m[0][3], m[1][3], m[2][3] };
+
+    float trace = m[0][0] + m[1][1] + m[2][2];
+
+    if (trace > 0.0f)
+    {
+        float s = 0.5f / sqrtf(trace + 1.0f);
+        pose.orientation.w = 0.25f / s;
+        pose.orientation.x = (m[2][1] - m[1][2]) * s;
+        pose.orientation.y = (m[0][2] - m[2][0]) * s;
+        pose.orientation.z = (m[1][0] - m[0][1]) * s;
+    }
+    else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+    {
+        float s = 2.0f * sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]);
+        pose.orientation.w = (m[2][1] - m[1][2]) / s;
+        pose.orientation.x = 0.25f * s;
+        pose.orientation.y = (m[0][1] + m[1][0]) / s;
+        pose.orientation.z = (m[0][2] + m[2][0]) / s;
+    }
+    else if (m[1][1] > m[2][2])
+    {
+        float s = 2.0f * sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]);
+        pose.orientation.w = (m[0][2] - m[2][0]) / s;
+        pose.orientation.x = (m[0][1] + m[1][0]) / s;
+        pose.orientation.y = 0.25f * s;
+        pose.orientation.z = (m[1][2] + m[2][1]) / s;
+    }
+    else
+    {
+        float s = 2.0f * sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]);
+        pose.orientation.w = (m[1][0] - m[0][1]) / s;
+        pose.orientation.x = (m[0][2] + m[2][0]) / s;
+        pose.orientation.y = (m[1][2] + m[2][1]) / s;
+        pose.orientation.z = 0.25f * s;
+    }
+
+    return pose;
+}
+
+
+PoseHistory::PoseHistory(std::shared_ptr<OpenVRManager> openVRManager)
+    : m_openVRManager(openVRManager)
+    , m_bRunThread(false)
+    , m_bSamplingEnabled(true)
+    , m_numWritten(0)
+{
+}
+
+PoseHistory::~PoseHistory()
+{
+    Stop();
+}
+
+void PoseHistory::Start()
+{
+    if (m_thread.joinable())
+    {
+        return;
+    }
+
+    m_bRunThread = true;
+    m_thread = std::thread(&PoseHistory::RunThread, this);
+}
+
+void PoseHistory::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        m_bRunThread = false;
+    }
+    m_threadCondition.notify_all();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void PoseHistory::SetSamplingEnabled(bool bEnabled)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        m_bSamplingEnabled = bEnabled;
+    }
+
+    if (bEnabled)
+    {
+        m_threadCondition.notify_all();
+    }
+}
+
+
+void PoseHistory::RunThread()
+{
+    Tracer::Get().SetThreadName("Pose sampler");
+
+    vr::TrackedDevicePose_t trackedDevicePoseArray[POSE_HISTORY_MAX_DEVICES];
+    PoseHistorySample sample;
+
+    while (m_bRunThread)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_threadMutex);
+            m_threadCondition.wait_for(lock, POSE_SAMPLE_INTERVAL, [&] { return !m_bRunThread; });
+
+            // Sleep while sampling is disabled, until it is enabled again or the thread is stopped.
+            m_threadCondition.wait(lock, [&] { return m_bSamplingEnabled || !m_bRunThread; });
+        }
+
+        if (!m_bRunThread)
+        {
+            break;
+        }
+
+        vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
+
+        if (!vrSystem)
+        {
+            continue;
+        }
+
+        sample.timeNs = GetMonotonicTimeNs();
+        vrSystem->GetDeviceToAbsoluteTrackingPose(vr::TrackingUniverseStanding, 0.0f, trackedDevicePoseArray, POSE_HISTORY_MAX_DEVICES);
+
+        for (uint32_t i = 0; i < POSE_HISTORY_MAX_DEVICES; i++)
+        {
+            sample.devices[i].bIsValid = trackedDevicePoseArray[i].bPoseIsValid;
+
+            if (sample.devices[i].bIsValid)
+            {
+                sample.devices[i].pose = ToXrPose(trackedDevicePoseArray[i].mDeviceToAbsoluteTracking);
+            }
+        }
+
+        WriteSample(sample);
+    }
+}
+
+
+void PoseHistory::WriteSample(const PoseHistorySample& sample)
+{
+    uint32_t index = m_numWritten.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[index % POSE_HISTORY_SIZE];
+
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.sample = sample;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_numWritten.store(index + 1, std::memory_order_release);
+}
+
+
+bool PoseHistory::ReadDevicePose(uint32_t index, uint32_t deviceId, uint64_t& timeNs, PoseHistoryDevicePose& devicePose) const
+{
+    const Slot& slot = m_slots[index % POSE_HISTORY_SIZE];
+
+    uint32_t sequenceBefore = slot.sequence.load(std::memory_order_acquire);
+    if (sequenceBefore & 1)
+    {
+        return false;
+    }
+
+    timeNs = slot.sample.timeNs;
+    devicePose = slot.sample.devices[deviceId];
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequenceBefore;
+}
+
+
+bool PoseHistory::GetDevicePose(uint32_t deviceId, uint64_t timeNs, XrPosef& pose) const
+{
+    if (deviceId >= POSE_HISTORY_MAX_DEVICES)
+    {
+        return false;
+    }
+
+    uint32_t numWritten = m_numWritten.load(std::memory_order_acquire);
+    if (numWritten == 0)
+    {
+        return false;
+    }
+
+    // Skip the slot the sampler may be overwriting next.
+    uint32_t numAvailable = std::min(numWritten, (uint32_t)POSE_HISTORY_SIZE - 1);
+
+    PoseHistoryDevicePose newer, older;
+    uint64_t newerTime = 0, olderTime = 0;
+    bool bHasNewer = false;
+
+    // Walk back from the newest sample until one is at or before the requested time.
+    for (uint32_t i = 0; i < numAvailable; i++)
+    {
+        if (!ReadDevicePose(numWritten - 1 - i, deviceId, olderTime, older))
+        {
+            break;
+        }
+
+        if (!older.bIsValid)
+        {
+            continue;
+        }
+
+        if (olderTime <= timeNs)
+        {
+            if (!bHasNewer || newerTime == olderTime)
+            {
+                pose = older.pose;
+                return true;
+            }
+
+            float fraction = (float)((double)(timeNs - olderTime) / (double)(newerTime - olderTime));
+
+            XrVector3f_Lerp(&pose.position, &older.pose.position, &newer.pose.position, fraction);
+            XrQuaternionf_Lerp(&pose.orientation, &older.pose.orientation, &newer.pose.orientation, fraction);
+            return true;
+        }
+
+        newer = older;
+        newerTime = olderTime;
+        bHasNewer = true;
+    }
+
+    // Requested time is older than the history, use the oldest valid sample.
+    if (bHasNewer)
+    {
+        pose = newer.pose;
+        return true;
+    }
+
+    return false;
+}
+
+
+bool PoseHistory::GetDevicePoseMatrix(uint32_t deviceId, uint64_t timeNs, XrMatrix4x4f& matrix) const
+{
+    XrPosef pose;
+
+    if (!GetDevicePose(deviceId, timeNs, pose))
+    {
+        return false;
+    }
+
+    XrVector3f scale = { 1, 1, 1 };
+    XrMatrix4x4f_CreateTranslationRotationScale(&matrix, &pose.position, &pose.orientation, &scale);
+    return true;
+}
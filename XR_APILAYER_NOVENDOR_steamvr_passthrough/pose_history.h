@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <xr_linear.h>
+
+#include "openvr_manager.h"
+
+
+#define POSE_HISTORY_SIZE 256
+#define POSE_HISTORY_MAX_DEVICES vr::k_unMaxTrackedDeviceCount
+#define POSE_SAMPLE_INTERVAL (std::chrono::milliseconds(2))
+
+
+struct PoseHistoryDevicePose
+{
+	XrPosef pose;
+	bool bIsValid;
+};
+
+// Poses for all tracked devices sampled at one point in time.
+struct PoseHistorySample
+{
+	uint64_t timeNs;
+	std::array<PoseHistoryDevicePose, POSE_HISTORY_MAX_DEVICES> devices;
+};
+
+
+// Ring of timestamped tracked device poses, filled by a sampler thread.
+// Lookups interpolate between the samples bracketing the requested time, so poses at camera exposure
+// or display time can be resolved without OpenVR calls on the calling thread.
+class PoseHistory
+{
+public:
+	PoseHistory(std::shared_ptr<OpenVRManager> openVRManager);
+	~PoseHistory();
+
+	void Start();
+	void Stop();
+	void SetSamplingEnabled(bool bEnabled);
+
+	// Time is on the GetMonotonicTimeNs() timeline. Times outside the history are clamped to the oldest or newest sample.
+	bool GetDevicePose(uint32_t deviceId, uint64_t timeNs, XrPosef& pose) const;
+	bool GetDevicePoseMatrix(uint32_t deviceId, uint64_t timeNs, XrMatrix4x4f& matrix) const;
+
+private:
+	// Each slot is guarded by a sequence counter that is odd while the sampler writes it.
+	struct Slot
+	{
+		std::atomic_uint32_t sequence{ 0 };
+		PoseHistorySample sample;
+	};
+
+	void RunThread();
+	void WriteSample(const PoseHistorySample& sample);
+	bool ReadDevicePose(uint32_t index, uint32_t deviceId, uint64_t& timeNs, PoseHistoryDevicePose& devicePose) const;
+
+	std::shared_ptr<OpenVRManager> m_openVRManager;
+
+	std::thread m_thread;
+	std::mutex m_threadMutex;
+	std::condition_variable m_threadCondition;
+	std::atomic_bool m_bRunThread;
+	std::atomic_bool m_bSamplingEnabled;
+
+	std::array<Slot, POSE_HISTORY_SIZE> m_slots;
+	std::atomic_uint32_t m_numWritten;
+};
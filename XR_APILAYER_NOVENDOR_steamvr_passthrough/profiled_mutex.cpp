@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "profiled_mutex.h"
+#include <log.h>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+std::atomic_bool LockProfiler::s_bEnabled = false;
+
+
+LockProfiler& LockProfiler::Get()
+{
+    static LockProfiler profiler;
+    return profiler;
+}
+
+
+LockProfile& LockProfiler::GetProfile(const char* name)
+{
+    std::lock_guard<std::mutex> lock(m_registrationMutex);
+
+    for (std::unique_ptr<LockProfile>& profile : m_storage)
+    {
+        if (profile->name == name)
+        {
+            return *profile;
+        }
+    }
+
+    LockProfile* profile = m_storage.emplace_back(std::make_unique<LockProfile>(name)).get();
+
+    uint32_t index = m_numProfiles.load(std::memory_order_relaxed);
+
+    if (index < LOCK_PROFILER_MAX_LOCKS)
+    {
+        m_profiles[index] = profile;
+        m_numProfiles.store(index + 1, std::memory_order_release);
+    }
+    else
+    {
+        ErrorLog("Lock profiler full, %s will not be listed\n", name);
+    }
+
+    return *profile;
+}
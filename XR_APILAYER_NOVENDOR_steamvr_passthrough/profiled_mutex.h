@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+#include "metrics.h"
+
+
+#define LOCK_PROFILER_MAX_LOCKS 32
+
+// Lock waits and holds are mostly in the microsecond range, so their first timer bucket holds durations
+// below 2^10 ns (~1 us). The last bounded bucket ends at 2^18 ns, where the default timer buckets start.
+#define LOCK_PROFILER_TIMER_BUCKET_SHIFT 10
+
+
+// Contention statistics, shared by all locks created with the same name.
+struct LockProfile
+{
+	LockProfile(const char* name)
+		: name(name)
+		, acquisitions(name)
+		, contentions(name)
+		, waitTimer(name, LOCK_PROFILER_TIMER_BUCKET_SHIFT)
+		, holdTimer(name, LOCK_PROFILER_TIMER_BUCKET_SHIFT)
+	{}
+
+	// Locks a mutex through the given try-lock and lock functions, and returns the time it was acquired.
+	// Only acquisitions that found the mutex taken are recorded in the wait timer.
+	template<typename TTryLock, typename TLock>
+	uint64_t Acquire(TTryLock tryLock, TLock lock)
+	{
+		acquisitions.Add();
+
+		if (tryLock())
+		{
+			return GetMonotonicTimeNs();
+		}
+
+		uint64_t startTime = GetMonotonicTimeNs();
+		lock();
+		uint64_t acquireTime = GetMonotonicTimeNs();
+
+		contentions.Add();
+		waitTimer.Record(acquireTime - startTime);
+		return acquireTime;
+	}
+
+	std::string name;
+	MetricCounter acquisitions;
+	MetricCounter contentions;
+	MetricTimer waitTimer;
+	MetricTimer holdTimer;
+};
+
+
+// Registry of the lock profiles. Profiling is off by default, in which case the profiled locks
+// only add a relaxed load of the enabled flag to each lock and unlock.
+class LockProfiler
+{
+public:
+	static LockProfiler& Get();
+
+	static bool IsEnabled() { return s_bEnabled.load(std::memory_order_relaxed); }
+	static void SetEnabled(bool bEnabled) { s_bEnabled.store(bEnabled, std::memory_order_relaxed); }
+
+	LockProfile& GetProfile(const char* name);
+
+	uint32_t GetNumProfiles() const { return m_numProfiles.load(std::memory_order_acquire); }
+	const LockProfile* GetProfileAt(uint32_t index) const { return index < GetNumProfiles() ? m_profiles[index] : nullptr; }
+
+private:
+	LockProfiler() {}
+
+	static std::atomic_bool s_bEnabled;
+
+	std::mutex m_registrationMutex;
+	std::deque<std::unique_ptr<LockProfile>> m_storage;
+	std::array<LockProfile*, LOCK_PROFILER_MAX_LOCKS> m_profiles = {};
+	std::atomic_uint32_t m_numProfiles{ 0 };
+};
+
+
+// Drop-in replacement for std::mutex that records acquisitions, wait times and hold times while profiling is enabled.
+class ProfiledMutex
+{
+public:
+	explicit ProfiledMutex(const char* name)
+		: m_profile(LockProfiler::Get().GetProfile(name))
+	{}
+
+	ProfiledMutex(const ProfiledMutex&) = delete;
+	ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+	void lock()
+	{
+		if (!LockProfiler::IsEnabled())
+		{
+			m_mutex.lock();
+			m_lockTime = 0;
+			return;
+		}
+
+		m_lockTime = m_profile.Acquire([this] { return m_mutex.try_lock(); }, [this] { m_mutex.lock(); });
+	}
+
+	bool try_lock()
+	{
+		if (!m_mutex.try_lock())
+		{
+			return false;
+		}
+
+		m_lockTime = LockProfiler::IsEnabled() ? GetMonotonicTimeNs() : 0;
+		return true;
+	}
+
+	void unlock()
+	{
+		if (m_lockTime != 0)
+		{
+			m_profile.holdTimer.RecordSince(m_lockTime);
+		}
+		m_mutex.unlock();
+	}
+
+private:
+	std::mutex m_mutex;
+	LockProfile& m_profile;
+
+	// Written by the owning thread only.
+	uint64_t m_lockTime = 0;
+};
+
+
+// Drop-in replacement for std::shared_mutex. Shared acquisitions record their wait time,
+// but only exclusive acquisitions record hold times, since there can be several shared holders.
+class ProfiledSharedMutex
+{
+public:
+	explicit ProfiledSharedMutex(const char* name)
+		: m_profile(LockProfiler::Get().GetProfile(name))
+	{}
+
+	ProfiledSharedMutex(const ProfiledSharedMutex&) = delete;
+	ProfiledSharedMutex& operator=(const ProfiledSharedMutex&) = delete;
+
+	void lock()
+	{
+		if (!LockProfiler::IsEnabled())
+		{
+			m_mutex.lock();
+			m_lockTime = 0;
+			return;
+		}
+
+		m_lockTime = m_profile.Acquire([this] { return m_mutex.try_lock(); }, [this] { m_mutex.lock(); });
+	}
+
+	bool try_lock()
+	{
+		if (!m_mutex.try_lock())
+		{
+			return false;
+		}
+
+		m_lockTime = LockProfiler::IsEnabled() ? GetMonotonicTimeNs() : 0;
+		return true;
+	}
+
+	void unlock()
+	{
+		if (m_lockTime != 0)
+		{
+			m_profile.holdTimer.RecordSince(m_lockTime);
+		}
+		m_mutex.unlock();
+	}
+
+	void lock_shared()
+	{
+		if (!LockProfiler::IsEnabled())
+		{
+			m_mutex.lock_shared();
+			return;
+		}
+
+		m_profile.Acquire([this] { return m_mutex.try_lock_shared(); }, [this] { m_mutex.lock_shared(); });
+	}
+
+	bool try_lock_shared()
+	{
+		return m_mutex.try_lock_shared();
+	}
+
+	void unlock_shared()
+	{
+		m_mutex.unlock_shared();
+	}
+
+private:
+	std::shared_mutex m_mutex;
+	LockProfile& m_profile;
+
+	// Written by the exclusive owner only.
+	uint64_t m_lockTime = 0;
+};
@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "reconstruction_thread_pool.h"
+#include <log.h>
+#include "trace.h"
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+// Index of the current thread in the pool, 0 for threads outside it.
+static thread_local int g_threadNum = 0;
+
+
+ReconstructionThreadPool::ReconstructionThreadPool()
+    : m_numThreads(1)
+    , m_affinityMask(0)
+    , m_priority(THREAD_PRIORITY_NORMAL)
+    , m_bRunWorkers(false)
+    , m_jobGeneration(0)
+    , m_jobCallback(nullptr)
+    , m_jobData(nullptr)
+    , m_jobTasks(0)
+    , m_activeWorkers(0)
+    , m_nextTask(0)
+    , m_completedTasks(0)
+{
+}
+
+ReconstructionThreadPool::~ReconstructionThreadPool()
+{
+    Stop();
+}
+
+
+void ReconstructionThreadPool::SetThreadAttributes(uint64_t affinityMask, int priority)
+{
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+
+    bool bChanged = affinityMask != m_affinityMask || priority != m_priority;
+
+    m_affinityMask = affinityMask;
+    m_priority = priority;
+    ApplyThreadAttributes();
+
+    // The workers apply the attributes when they start.
+    if (bChanged && !m_workers.empty())
+    {
+        int numWorkers = (int)m_workers.size();
+        StopWorkers();
+        StartWorkers(numWorkers);
+    }
+}
+
+void ReconstructionThreadPool::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    StopWorkers();
+    m_numThreads = 1;
+}
+
+
+int ReconstructionThreadPool::GetDefaultNumThreads()
+{
+    return std::max((int)std::thread::hardware_concurrency() / 2, 1);
+}
+
+
+int ReconstructionThreadPool::setNumThreads(int nThreads)
+{
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+
+    int previous = m_numThreads;
+
+    // Follows cv::setNumThreads(): negative values select the default, and 0 disables threading.
+    if (nThreads < 0)
+    {
+        nThreads = GetDefaultNumThreads();
+    }
+
+    m_numThreads = std::clamp(nThreads, 1, RECONSTRUCTION_MAX_THREADS);
+
+    if (m_numThreads - 1 != (int)m_workers.size())
+    {
+        StopWorkers();
+        StartWorkers(m_numThreads - 1);
+    }
+
+    return previous;
+}
+
+int ReconstructionThreadPool::getNumThreads() const
+{
+    return m_numThreads;
+}
+
+int ReconstructionThreadPool::getThreadNum() const
+{
+    return g_threadNum;
+}
+
+
+void ReconstructionThreadPool::parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data)
+{
+    // Regions started from other threads while the pool is busy run on their own thread.
+    std::unique_lock<std::mutex> poolLock(m_poolMutex, std::try_to_lock);
+
+    if (!poolLock.owns_lock() || m_workers.empty() || tasks <= 1)
+    {
+        body_callback(0, tasks, callback_data);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_jobCallback = body_callback;
+        m_jobData = callback_data;
+        m_jobTasks = tasks;
+        m_nextTask = 0;
+        m_completedTasks = 0;
+        m_jobGeneration++;
+    }
+    m_jobCondition.notify_all();
+
+    RunTasks(body_callback, callback_data, tasks);
+
+    // Workers that joined the job must also have left it before the next job can reset the task counters.
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    m_doneCondition.wait(lock, [&] { return m_completedTasks.load() >= tasks && m_activeWorkers == 0; });
+    m_jobCallback = nullptr;
+    m_jobData = nullptr;
+}
+
+
+void ReconstructionThreadPool::RunTasks(FN_parallel_for_body_cb_t callback, void* data, int tasks)
+{
+    int completed = 0;
+
+    for (int task = m_nextTask.fetch_add(1); task < tasks; task = m_nextTask.fetch_add(1))
+    {
+        callback(task, task + 1, data);
+        completed++;
+    }
+
+    m_completedTasks.fetch_add(completed);
+}
+
+
+void ReconstructionThreadPool::RunWorker(int threadNum)
+{
+    g_threadNum = threadNum;
+    Tracer::Get().SetThreadName("Reconstruction worker");
+    ApplyThreadAttributes();
+
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    uint64_t lastGeneration = m_jobGeneration;
+
+    while (true)
+    {
+        m_jobCondition.wait(lock, [&] { return !m_bRunWorkers || m_jobGeneration != lastGeneration; });
+
+        if (!m_bRunWorkers)
+        {
+            return;
+        }
+
+        lastGeneration = m_jobGeneration;
+
+        // The job may already have finished if the worker woke up late.
+        if (!m_jobCallback)
+        {
+            continue;
+        }
+
+        FN_parallel_for_body_cb_t callback = m_jobCallback;
+        void* data = m_jobData;
+        int tasks = m_jobTasks;
+        m_activeWorkers++;
+
+        lock.unlock();
+        RunTasks(callback, data, tasks);
+        lock.lock();
+
+        if (--m_activeWorkers == 0)
+        {
+            m_doneCondition.notify_all();
+        }
+    }
+}
+
+
+void ReconstructionThreadPool::StartWorkers(int numWorkers)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_bRunWorkers = true;
+    }
+
+    for (int i = 0; i < numWorkers; i++)
+    {
+        m_workers.emplace_back(&ReconstructionThreadPool::RunWorker, this, i + 1);
+    }
+}
+
+void ReconstructionThreadPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_bRunWorkers = false;
+    }
+    m_jobCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+
+void ReconstructionThreadPool::ApplyThreadAttributes()
+{
+    if (m_affinityMask != 0 && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)m_affinityMask) == 0)
+    {
+        ErrorLog("Failed to set reconstruction thread affinity mask %llx: %u\n", m_affinityMask, GetLastError());
+    }
+
+    if (!SetThreadPriority(GetCurrentThread(), m_priority))
+    {
+        ErrorLog("Failed to set reconstruction thread priority %d: %u\n", m_priority, GetLastError());
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+
+
+// Workers are limited to this many, regardless of the configured count.
+#define RECONSTRUCTION_MAX_THREADS 32
+
+
+// Worker pool that runs the OpenCV parallel regions of the stereo reconstruction.
+// Installed as the OpenCV parallel backend, so the reconstruction uses a bounded number of threads
+// with a chosen CPU affinity and priority, instead of the default pool spanning every core.
+// The thread calling parallel_for() takes part in the work, so N threads means N - 1 workers.
+class ReconstructionThreadPool : public cv::parallel::ParallelForAPI
+{
+public:
+	ReconstructionThreadPool();
+	~ReconstructionThreadPool() override;
+
+	// An affinity mask of 0 leaves the threads on all cores. The priority is a Windows THREAD_PRIORITY_* value.
+	// Also applies the attributes to the calling thread, which is expected to be the one running the parallel regions.
+	void SetThreadAttributes(uint64_t affinityMask, int priority);
+
+	// Stops the workers. Parallel regions run on the calling thread afterwards.
+	void Stop();
+
+	// Thread count used when none is configured, leaving half of the cores to the application and runtime.
+	static int GetDefaultNumThreads();
+
+	void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) override;
+	int getThreadNum() const override;
+	int getNumThreads() const override;
+	int setNumThreads(int nThreads) override;
+	const char* getName() const override { return "ReconstructionThreadPool"; }
+
+private:
+	void StartWorkers(int numWorkers);
+	void StopWorkers();
+	void RunWorker(int threadNum);
+	void RunTasks(FN_parallel_for_body_cb_t callback, void* data, int tasks);
+	void ApplyThreadAttributes();
+
+	// Guards the worker list and the settings. Held for the duration of a parallel region.
+	std::mutex m_poolMutex;
+	std::vector<std::thread> m_workers;
+	int m_numThreads;
+	uint64_t m_affinityMask;
+	int m_priority;
+
+	std::mutex m_jobMutex;
+	std::condition_variable m_jobCondition;
+	std::condition_variable m_doneCondition;
+	bool m_bRunWorkers;
+	uint64_t m_jobGeneration;
+
+	// Current job, guarded by m_jobMutex. Tasks are claimed and completed without the lock.
+	FN_parallel_for_body_cb_t m_jobCallback;
+	void* m_jobData;
+	int m_jobTasks;
+	int m_activeWorkers;
+	std::atomic_int m_nextTask;
+	std::atomic_int m_completedTasks;
+};
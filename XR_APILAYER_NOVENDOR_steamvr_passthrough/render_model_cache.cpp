@@ -0,0 +1,201 @@
+#include "pch.h"
+#include "render_model_cache.h"
+#include <log.h>
+#include "trace.h"
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+RenderModelCache::RenderModelCache(std::shared_ptr<ConfigManager> configManager, std::shared_ptr<OpenVRManager> openVRManager)
+    : m_configManager(configManager)
+    , m_openVRManager(openVRManager)
+    , m_bRunThread(false)
+    , m_bEnabled(false)
+    , m_meshTriangleBudget(0)
+{
+    m_renderModels = std::make_shared<const std::vector<RenderModel>>();
+}
+
+RenderModelCache::~RenderModelCache()
+{
+    Stop();
+}
+
+void RenderModelCache::Start()
+{
+    if (m_thread.joinable())
+    {
+        return;
+    }
+
+    m_bRunThread = true;
+    m_thread = std::thread(&RenderModelCache::RunThread, this);
+}
+
+void RenderModelCache::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        m_bRunThread = false;
+    }
+    m_threadCondition.notify_all();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void RenderModelCache::SetEnabled(bool bEnabled)
+{
+    if (m_bEnabled.exchange(bEnabled) != bEnabled && bEnabled)
+    {
+        // Scan right away instead of waiting out the interval.
+        m_threadCondition.notify_all();
+    }
+}
+
+std::shared_ptr<const std::vector<RenderModel>> RenderModelCache::GetRenderModels()
+{
+    std::lock_guard<std::mutex> lock(m_modelsMutex);
+    return m_renderModels;
+}
+
+
+void RenderModelCache::RunThread()
+{
+    Tracer::Get().SetThreadName("Render model loader");
+
+    while (m_bRunThread)
+    {
+        if (m_bEnabled)
+        {
+            UpdateDeviceModels();
+        }
+
+        std::unique_lock<std::mutex> lock(m_threadMutex);
+        m_threadCondition.wait_for(lock, RENDER_MODEL_SCAN_INTERVAL);
+    }
+}
+
+
+void RenderModelCache::UpdateDeviceModels()
+{
+    TraceSpan span("RenderModelScan");
+
+    vr::IVRSystem* vrSystem = m_openVRManager->GetVRSystem();
+
+    if (!vrSystem)
+    {
+        return;
+    }
+
+    uint32_t maxTriangles = (uint32_t)std::max(m_configManager->GetConfigSnapshot()->Main.RenderModelMaxTriangles, 0);
+
+    // Rebuild all meshes if the budget has changed.
+    if (maxTriangles != m_meshTriangleBudget)
+    {
+        m_meshes.clear();
+        m_meshTriangleBudget = maxTriangles;
+    }
+
+    std::vector<RenderModel> models;
+    std::string modelName;
+
+    for (uint32_t i = 1; i < vr::k_unMaxTrackedDeviceCount; i++)
+    {
+        if (!m_bRunThread) { return; }
+
+        if (!vrSystem->IsTrackedDeviceConnected(i))
+        {
+            continue;
+        }
+
+        modelName.resize(vr::k_unMaxPropertyStringSize);
+
+        vr::TrackedPropertyError error;
+        vrSystem->GetStringTrackedDeviceProperty(i, vr::Prop_RenderModelName_String, modelName.data(), vr::k_unMaxPropertyStringSize, &error);
+
+        if (error != vr::TrackedProp_Success)
+        {
+            continue;
+        }
+
+        modelName.resize(strnlen(modelName.data(), vr::k_unMaxPropertyStringSize));
+
+        std::shared_ptr<const Mesh<VertexFormatBasic>> mesh = GetMesh(modelName, maxTriangles);
+
+        if (mesh)
+        {
+            models.emplace_back(i, modelName, mesh);
+        }
+    }
+
+    std::shared_ptr<const std::vector<RenderModel>> currentModels = GetRenderModels();
+
+    bool bChanged = currentModels->size() != models.size();
+
+    for (size_t i = 0; !bChanged && i < models.size(); i++)
+    {
+        bChanged = (*currentModels)[i].deviceId != models[i].deviceId || (*currentModels)[i].mesh != models[i].mesh;
+    }
+
+    if (bChanged)
+    {
+        std::shared_ptr<const std::vector<RenderModel>> newModels = std::make_shared<const std::vector<RenderModel>>(std::move(models));
+
+        std::lock_guard<std::mutex> lock(m_modelsMutex);
+        m_renderModels = newModels;
+    }
+}
+
+
+std::shared_ptr<const Mesh<VertexFormatBasic>> RenderModelCache::GetMesh(const std::string& modelName, uint32_t maxTriangles)
+{
+    auto it = m_meshes.find(modelName);
+    if (it != m_meshes.end())
+    {
+        return it->second;
+    }
+
+    vr::IVRRenderModels* vrRenderModels = m_openVRManager->GetVRRenderModels();
+
+    if (!vrRenderModels)
+    {
+        return nullptr;
+    }
+
+    TraceSpan span("RenderModelLoad");
+
+    vr::RenderModel_t* vrModel = nullptr;
+    vr::EVRRenderModelError error;
+
+    while ((error = vrRenderModels->LoadRenderModel_Async(modelName.c_str(), &vrModel)) == vr::VRRenderModelError_Loading)
+    {
+        if (!m_bRunThread) { return nullptr; }
+        std::this_thread::sleep_for(RENDER_MODEL_LOAD_POLL_INTERVAL);
+    }
+
+    std::shared_ptr<Mesh<VertexFormatBasic>> mesh;
+
+    if (error == vr::VRRenderModelError_None)
+    {
+        mesh = std::make_shared<Mesh<VertexFormatBasic>>();
+        MeshCreateRenderModel(*mesh, vrModel);
+        vrRenderModels->FreeRenderModel(vrModel);
+
+        size_t numOriginalTriangles = mesh->triangles.size();
+        MeshDecimate(*mesh, maxTriangles);
+
+        Log("Loaded render model %s with %u triangles (%u before decimation)\n", modelName.c_str(), (uint32_t)mesh->triangles.size(), (uint32_t)numOriginalTriangles);
+    }
+    else
+    {
+        ErrorLog("Failed to load render model %s, error %i\n", modelName.c_str(), error);
+    }
+
+    // Failed loads are cached as empty so they are not retried on every scan.
+    m_meshes[modelName] = mesh;
+    return mesh;
+}
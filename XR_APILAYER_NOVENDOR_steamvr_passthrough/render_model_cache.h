@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "layer.h"
+#include "openvr_manager.h"
+#include "config_manager.h"
+#include "mesh.h"
+
+
+#define RENDER_MODEL_SCAN_INTERVAL (std::chrono::milliseconds(1000))
+#define RENDER_MODEL_LOAD_POLL_INTERVAL (std::chrono::milliseconds(10))
+
+
+// Loads tracked device render models on a background thread.
+// Meshes are keyed by model name, decimated to the configured triangle budget and shared as immutable objects,
+// so the camera thread only needs to copy the current model list and update the poses each frame.
+class RenderModelCache
+{
+public:
+	RenderModelCache(std::shared_ptr<ConfigManager> configManager, std::shared_ptr<OpenVRManager> openVRManager);
+	~RenderModelCache();
+
+	void Start();
+	void Stop();
+	void SetEnabled(bool bEnabled);
+
+	// Models of the currently connected devices. The list is replaced as a whole when devices or meshes change.
+	std::shared_ptr<const std::vector<RenderModel>> GetRenderModels();
+
+private:
+	void RunThread();
+	void UpdateDeviceModels();
+	std::shared_ptr<const Mesh<VertexFormatBasic>> GetMesh(const std::string& modelName, uint32_t maxTriangles);
+
+	std::shared_ptr<ConfigManager> m_configManager;
+	std::shared_ptr<OpenVRManager> m_openVRManager;
+
+	std::thread m_thread;
+	std::mutex m_threadMutex;
+	std::condition_variable m_threadCondition;
+	std::atomic_bool m_bRunThread;
+	std::atomic_bool m_bEnabled;
+
+	// Only accessed from the loader thread.
+	std::map<std::string, std::shared_ptr<const Mesh<VertexFormatBasic>>> m_meshes;
+	uint32_t m_meshTriangleBudget;
+
+	std::mutex m_modelsMutex;
+	std::shared_ptr<const std::vector<RenderModel>> m_renderModels;
+};
@@ -0,0 +1,342 @@
+#include "pch.h"
+#include "room_geometry_cache.h"
+#include <log.h>
+#include "xr_math_simd.h"
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+#define ROOM_CACHE_KEY_BITS 21
+#define ROOM_CACHE_KEY_OFFSET (1 << (ROOM_CACHE_KEY_BITS - 1))
+#define ROOM_CACHE_KEY_MASK ((1ull << ROOM_CACHE_KEY_BITS) - 1)
+
+// Largest voxel footprint in pixels when splatting the prediction.
+#define ROOM_CACHE_MAX_SPLAT_RADIUS 6
+
+
+// Same transform as DisparityToWorldCoords() in the stereo vertex shaders, without the projection distance clamp.
+static bool DisparityToView(const XrMatrix4x4f& disparityToDepth, float u, float v, float disparity, XrVector3f& viewPos)
+{
+    XrVector4f in = { u, v, disparity, 1.0f };
+    XrVector4f out;
+    XrMatrix4x4f_TransformVector4f(&out, &disparityToDepth, &in);
+
+    if (out.w <= 0.0f)
+    {
+        return false;
+    }
+
+    viewPos.x = out.x / out.w;
+    viewPos.y = (1.0f - out.y) / out.w;
+    viewPos.z = -out.z / out.w;
+    return true;
+}
+
+// Inverse of DisparityToView() for a Q matrix in the stereoRectify layout:
+// [1 0 0 -cx], [0 1 0 -cy], [0 0 0 f], [0 0 a b], stored column major.
+static bool ViewToDisparity(const XrMatrix4x4f& disparityToDepth, const XrVector3f& viewPos, float& u, float& v, float& disparity)
+{
+    const float* m = disparityToDepth.m;
+
+    if (viewPos.z >= 0.0f || m[11] == 0.0f)
+    {
+        return false;
+    }
+
+    float w = -m[14] / viewPos.z;
+
+    u = viewPos.x * w - m[12];
+    v = 1.0f - viewPos.y * w - m[13];
+    disparity = (w - m[15]) / m[11];
+    return true;
+}
+
+
+RoomGeometryCache::RoomGeometryCache()
+    : m_voxelSize(0.05f)
+    , m_frame(0)
+{
+}
+
+void RoomGeometryCache::Reset(float voxelSize)
+{
+    m_voxels = std::unordered_map<uint64_t, Voxel>();
+    m_voxelSize = std::max(voxelSize, 0.01f);
+    m_frame = 0;
+}
+
+size_t RoomGeometryCache::GetMemoryUsage() const
+{
+    // Node size plus the list pointers of a typical node based implementation.
+    size_t nodeSize = sizeof(std::pair<const uint64_t, Voxel>) + 2 * sizeof(void*);
+    return m_voxels.size() * nodeSize + m_voxels.bucket_count() * sizeof(void*);
+}
+
+uint64_t RoomGeometryCache::GetVoxelKey(const XrVector3f& position) const
+{
+    auto axisKey = [this](float value)
+    {
+        int64_t index = (int64_t)floorf(value / m_voxelSize) + ROOM_CACHE_KEY_OFFSET;
+        return (uint64_t)std::clamp(index, (int64_t)0, (int64_t)ROOM_CACHE_KEY_MASK);
+    };
+
+    return axisKey(position.x) | (axisKey(position.y) << ROOM_CACHE_KEY_BITS) | (axisKey(position.z) << (ROOM_CACHE_KEY_BITS * 2));
+}
+
+
+void RoomGeometryCache::Predict(RoomCachePrediction& prediction, const XrMatrix4x4f& disparityViewToWorld, const XrMatrix4x4f& disparityToDepth, float downscaleFactor, int width, int height, bool bNegativeDisparity)
+{
+    int numBands = (height + ROOM_CACHE_TILE_SIZE - 1) / ROOM_CACHE_TILE_SIZE;
+
+    if (prediction.width != width || prediction.height != height)
+    {
+        prediction.width = width;
+        prediction.height = height;
+        prediction.disparity.resize(width * height);
+        prediction.voxelKeys.resize(width * height);
+        prediction.bandCached.assign(numBands, 0);
+        prediction.bandCachedFrames.assign(numBands, 0);
+    }
+
+    prediction.bNegativeDisparity = bNegativeDisparity;
+    prediction.disparityViewToWorld = disparityViewToWorld;
+
+    std::fill(prediction.disparity.begin(), prediction.disparity.end(), (int16_t)0);
+
+    XrMatrix4x4f worldToDisparityView;
+    XrMatrix4x4f_InvertRigidBodySIMD(&worldToDisparityView, &disparityViewToWorld);
+
+    float focalLength = disparityToDepth.m[14];
+    float sign = bNegativeDisparity ? -1.0f : 1.0f;
+
+    for (const auto& [key, voxel] : m_voxels)
+    {
+        if (voxel.weight < ROOM_CACHE_STABLE_WEIGHT)
+        {
+            continue;
+        }
+
+        XrVector3f worldPos = { voxel.position[0], voxel.position[1], voxel.position[2] };
+        XrVector3f viewPos;
+        XrMatrix4x4f_TransformVector3f(&viewPos, &worldToDisparityView, &worldPos);
+
+        float u, v, disparity;
+        if (!ViewToDisparity(disparityToDepth, viewPos, u, v, disparity) || disparity <= 0.0f)
+        {
+            continue;
+        }
+
+        float fixedDisparity = disparity / downscaleFactor * 16.0f;
+
+        if (fixedDisparity < 16.0f || fixedDisparity > (float)INT16_MAX)
+        {
+            continue;
+        }
+
+        int16_t value = (int16_t)(fixedDisparity * sign);
+        int centerX = (int)(u / downscaleFactor);
+        int centerY = (int)(v / downscaleFactor);
+        int radius = std::min((int)ceilf(0.5f * m_voxelSize * focalLength / -viewPos.z / downscaleFactor), ROOM_CACHE_MAX_SPLAT_RADIUS);
+
+        int startX = std::max(centerX - radius, 0);
+        int endX = std::min(centerX + radius, width - 1);
+        int startY = std::max(centerY - radius, 0);
+        int endY = std::min(centerY + radius, height - 1);
+
+        for (int y = startY; y <= endY; y++)
+        {
+            for (int x = startX; x <= endX; x++)
+            {
+                int index = y * width + x;
+
+                // Keep the nearest surface.
+                if (abs(value) > abs(prediction.disparity[index]))
+                {
+                    prediction.disparity[index] = value;
+                    prediction.voxelKeys[index] = key;
+                }
+            }
+        }
+    }
+}
+
+
+int RoomGeometryCache::ClassifyBands(RoomCachePrediction& prediction, const cv::Mat& image, const cv::Mat& otherImage, int extOffset)
+{
+    int numCached = 0;
+    int channels = image.channels();
+
+    for (int band = 0; band < prediction.NumBands(); band++)
+    {
+        bool bCached = prediction.bandCachedFrames[band] < ROOM_CACHE_MAX_CACHED_FRAMES;
+
+        for (int tileX = 0; bCached && tileX < prediction.width; tileX += ROOM_CACHE_TILE_SIZE)
+        {
+            int tileEndX = std::min(tileX + ROOM_CACHE_TILE_SIZE, prediction.width);
+            int numPixels = 0;
+            int numCovered = 0;
+            int numCompared = 0;
+            float photometricError = 0.0f;
+
+            for (int y = prediction.BandStart(band); y < prediction.BandEnd(band); y++)
+            {
+                const uint8_t* row = image.ptr<uint8_t>(y);
+                const uint8_t* otherRow = otherImage.ptr<uint8_t>(y);
+
+                for (int x = tileX; x < tileEndX; x++)
+                {
+                    numPixels++;
+                    int16_t disparity = prediction.disparity[y * prediction.width + x];
+
+                    if (disparity == 0)
+                    {
+                        continue;
+                    }
+
+                    numCovered++;
+
+                    // The images are compared on a sparse checkerboard, which is enough to catch moved geometry.
+                    if (((x + y) & 1) != 0)
+                    {
+                        continue;
+                    }
+
+                    int matchX = x + extOffset - cvRound(disparity / 16.0f);
+
+                    if (matchX >= 0 && matchX < otherImage.cols)
+                    {
+                        photometricError += (float)abs((int)row[(x + extOffset) * channels] - (int)otherRow[matchX * channels]);
+                        numCompared++;
+                    }
+                }
+            }
+
+            bCached = numCovered >= numPixels * ROOM_CACHE_MIN_TILE_COVERAGE &&
+                numCompared > 0 && photometricError / numCompared <= ROOM_CACHE_MAX_PHOTOMETRIC_ERROR;
+        }
+
+        prediction.bandCached[band] = bCached ? 1 : 0;
+        prediction.bandCachedFrames[band] = bCached ? prediction.bandCachedFrames[band] + 1 : 0;
+
+        if (bCached)
+        {
+            numCached++;
+        }
+    }
+
+    return numCached;
+}
+
+
+void RoomGeometryCache::Integrate(const RoomCachePrediction& prediction, const std::vector<uint8_t>& matchedBands, const int16_t* disparity, int rowStride, const XrMatrix4x4f& disparityToDepth, float downscaleFactor, int maxDisparity, bool bUseConfidence)
+{
+    int sign = prediction.bNegativeDisparity ? -1 : 1;
+    int maxValue = maxDisparity * 16;
+
+    for (int band = 0; band < prediction.NumBands() && band < (int)matchedBands.size(); band++)
+    {
+        if (!matchedBands[band])
+        {
+            continue;
+        }
+
+        for (int y = prediction.BandStart(band); y < prediction.BandEnd(band); y += ROOM_CACHE_INTEGRATE_STEP)
+        {
+            const int16_t* row = disparity + y * rowStride;
+
+            for (int x = 0; x < prediction.width; x += ROOM_CACHE_INTEGRATE_STEP)
+            {
+                int value = row[x * 2] * sign;
+
+                if (value <= 0 || value >= maxValue || (bUseConfidence && row[x * 2 + 1] < INT16_MAX / 2))
+                {
+                    continue;
+                }
+
+                int index = y * prediction.width + x;
+                int predicted = prediction.disparity[index] * sign;
+
+                // Seeing past a predicted surface means it is no longer there.
+                if (predicted > 0 && value < predicted - 16)
+                {
+                    auto it = m_voxels.find(prediction.voxelKeys[index]);
+
+                    if (it != m_voxels.end())
+                    {
+                        it->second.weight -= 2.0f;
+
+                        if (it->second.weight <= 0.0f)
+                        {
+                            m_voxels.erase(it);
+                        }
+                    }
+                }
+
+                XrVector3f viewPos;
+                if (!DisparityToView(disparityToDepth, x * downscaleFactor, y * downscaleFactor, value / 16.0f * downscaleFactor, viewPos))
+                {
+                    continue;
+                }
+
+                XrVector3f worldPos;
+                XrMatrix4x4f_TransformVector3f(&worldPos, &prediction.disparityViewToWorld, &viewPos);
+
+                Voxel& voxel = m_voxels.try_emplace(GetVoxelKey(worldPos), Voxel{ { worldPos.x, worldPos.y, worldPos.z }, 0.0f, m_frame }).first->second;
+
+                float blend = 1.0f / (voxel.weight + 1.0f);
+                voxel.position[0] += (worldPos.x - voxel.position[0]) * blend;
+                voxel.position[1] += (worldPos.y - voxel.position[1]) * blend;
+                voxel.position[2] += (worldPos.z - voxel.position[2]) * blend;
+                voxel.weight = std::min(voxel.weight + 1.0f, ROOM_CACHE_MAX_WEIGHT);
+                voxel.lastSeenFrame = m_frame;
+            }
+        }
+    }
+}
+
+
+void RoomGeometryCache::EndFrame()
+{
+    m_frame++;
+
+    if (m_frame % ROOM_CACHE_PRUNE_INTERVAL == 0 || m_voxels.size() > ROOM_CACHE_MAX_VOXELS)
+    {
+        Prune();
+    }
+}
+
+void RoomGeometryCache::Prune()
+{
+    // Unstable voxels expire first, the rest only once the cache is over its size limit.
+    for (auto it = m_voxels.begin(); it != m_voxels.end();)
+    {
+        if (it->second.weight < ROOM_CACHE_STABLE_WEIGHT && m_frame - it->second.lastSeenFrame > ROOM_CACHE_PRUNE_AGE)
+        {
+            it = m_voxels.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    uint32_t maxAge = ROOM_CACHE_PRUNE_AGE;
+
+    while (m_voxels.size() > ROOM_CACHE_MAX_VOXELS && maxAge > 0)
+    {
+        maxAge /= 2;
+
+        for (auto it = m_voxels.begin(); it != m_voxels.end();)
+        {
+            if (m_frame - it->second.lastSeenFrame > maxAge)
+            {
+                it = m_voxels.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+}
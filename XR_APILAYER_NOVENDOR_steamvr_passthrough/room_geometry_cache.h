@@ -0,0 +1,91 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <xr_linear.h>
+
+#include <opencv2/core.hpp>
+
+
+// Rows of the disparity map are classified in bands of tiles, since the matcher needs full rows.
+#define ROOM_CACHE_TILE_SIZE 32
+#define ROOM_CACHE_INTEGRATE_STEP 4
+#define ROOM_CACHE_MAX_VOXELS 262144
+#define ROOM_CACHE_STABLE_WEIGHT 4.0f
+#define ROOM_CACHE_MAX_WEIGHT 16.0f
+#define ROOM_CACHE_MIN_TILE_COVERAGE 0.9f
+#define ROOM_CACHE_MAX_PHOTOMETRIC_ERROR 12.0f
+#define ROOM_CACHE_MAX_CACHED_FRAMES 30
+#define ROOM_CACHE_PRUNE_AGE 1800
+#define ROOM_CACHE_PRUNE_INTERVAL 64
+
+// Extra rows matched around each band, so the matcher aggregation has context across band edges.
+#define ROOM_CACHE_MATCH_PADDING 16
+
+
+// Disparity map of one eye rendered from the cache, and the band classification derived from it.
+// Disparities use the same signed 4-bit fixed point values as the matcher output.
+struct RoomCachePrediction
+{
+	int width = 0;
+	int height = 0;
+	bool bNegativeDisparity = false;
+	XrMatrix4x4f disparityViewToWorld{};
+
+	std::vector<int16_t> disparity;
+	std::vector<uint64_t> voxelKeys;
+
+	// Per band of ROOM_CACHE_TILE_SIZE rows.
+	std::vector<uint8_t> bandCached;
+	std::vector<uint32_t> bandCachedFrames;
+
+	int NumBands() const { return (int)bandCached.size(); }
+	int BandStart(int band) const { return band * ROOM_CACHE_TILE_SIZE; }
+	int BandEnd(int band) const { return std::min((band + 1) * ROOM_CACHE_TILE_SIZE, height); }
+};
+
+
+// Sparse voxel hash of world space points accumulated from earlier depth frames.
+// Each frame the stable part of the room is rendered into a predicted disparity map. Bands where the prediction
+// covers the view and is photometrically consistent between the rectified images can skip stereo matching,
+// while freshly matched bands are integrated back and carve away voxels that are no longer observed.
+// Only accessed from the reconstruction thread.
+class RoomGeometryCache
+{
+public:
+	RoomGeometryCache();
+
+	void Reset(float voxelSize);
+	float GetVoxelSize() const { return m_voxelSize; }
+	size_t GetNumVoxels() const { return m_voxels.size(); }
+	size_t GetMemoryUsage() const;
+
+	// The matrices are the ones stored in the DepthFrame. disparityToDepth is expected to have the layout of
+	// the OpenCV stereoRectify Q matrix, which is inverted directly to project the voxels.
+	void Predict(RoomCachePrediction& prediction, const XrMatrix4x4f& disparityViewToWorld, const XrMatrix4x4f& disparityToDepth, float downscaleFactor, int width, int height, bool bNegativeDisparity);
+
+	// Marks the bands that can be served from the prediction. The images are the padded matcher inputs,
+	// with the view starting at extOffset. Returns the number of cached bands.
+	int ClassifyBands(RoomCachePrediction& prediction, const cv::Mat& image, const cv::Mat& otherImage, int extOffset);
+
+	// Adds the bands flagged in matchedBands of a disparity map with interleaved confidence to the cache.
+	// Disparities of maxDisparity pixels or more are treated as invalid.
+	void Integrate(const RoomCachePrediction& prediction, const std::vector<uint8_t>& matchedBands, const int16_t* disparity, int rowStride, const XrMatrix4x4f& disparityToDepth, float downscaleFactor, int maxDisparity, bool bUseConfidence);
+
+	void EndFrame();
+
+private:
+	struct Voxel
+	{
+		float position[3];
+		float weight;
+		uint32_t lastSeenFrame;
+	};
+
+	uint64_t GetVoxelKey(const XrVector3f& position) const;
+	void Prune();
+
+	std::unordered_map<uint64_t, Voxel> m_voxels;
+	float m_voxelSize;
+	uint32_t m_frame;
+};
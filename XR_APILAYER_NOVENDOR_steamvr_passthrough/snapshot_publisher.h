@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+
+// Publishes immutable snapshots of a value from a single writer thread to any number of readers.
+// The snapshot is replaced as a whole, and the generation is incremented after it, so readers can
+// check for changes without loading the snapshot. T needs a uint64_t Generation member, and operator==.
+template<typename T>
+class SnapshotPublisher
+{
+public:
+	SnapshotPublisher()
+		: m_generation(0)
+	{}
+
+	// Publishes the value with the next generation, unless it is equal to the current snapshot.
+	// Returns true if a new snapshot was published.
+	bool Publish(T value)
+	{
+		std::shared_ptr<const T> current = m_snapshot.load(std::memory_order_acquire);
+		uint64_t generation = m_generation.load(std::memory_order_relaxed);
+
+		value.Generation = generation;
+		if (current && *current == value)
+		{
+			return false;
+		}
+
+		value.Generation = generation + 1;
+		m_snapshot.store(std::make_shared<const T>(std::move(value)), std::memory_order_release);
+		m_generation.store(generation + 1, std::memory_order_release);
+
+		WakeWaiters();
+		return true;
+	}
+
+	// Returns nullptr before the first snapshot has been published.
+	std::shared_ptr<const T> Get() const { return m_snapshot.load(std::memory_order_acquire); }
+	uint64_t GetGeneration() const { return m_generation.load(std::memory_order_acquire); }
+
+	// Blocks until a snapshot newer than the given generation is published, or bKeepWaiting is cleared.
+	// WakeWaiters() must be called after clearing the flag for the waiter to notice it.
+	void WaitForChange(uint64_t generation, const std::atomic_bool& bKeepWaiting)
+	{
+		std::unique_lock<std::mutex> lock(m_waitMutex);
+		m_waitCondition.wait(lock, [&] { return GetGeneration() != generation || !bKeepWaiting; });
+	}
+
+	// As above, but gives up after the timeout. Returns true if a newer snapshot was published.
+	bool WaitForChange(uint64_t generation, const std::atomic_bool& bKeepWaiting, std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_waitMutex);
+		m_waitCondition.wait_for(lock, timeout, [&] { return GetGeneration() != generation || !bKeepWaiting; });
+		return GetGeneration() != generation;
+	}
+
+	void WakeWaiters()
+	{
+		// Taking the mutex orders the wakeup after a waiter has checked its condition.
+		{
+			std::lock_guard<std::mutex> lock(m_waitMutex);
+		}
+		m_waitCondition.notify_all();
+	}
+
+private:
+	std::atomic<std::shared_ptr<const T>> m_snapshot;
+	std::atomic_uint64_t m_generation;
+	std::mutex m_waitMutex;
+	std::condition_variable m_waitCondition;
+};
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "staging_ring.h"
+#include <log.h>
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+void CopyRows(uint8_t* dest, size_t destRowPitch, const uint8_t* source, size_t sourceRowPitch, size_t rowSize, uint32_t numRows)
+{
+    if (destRowPitch == rowSize && sourceRowPitch == rowSize)
+    {
+        memcpy(dest, source, rowSize * numRows);
+        return;
+    }
+
+    for (uint32_t row = 0; row < numRows; row++)
+    {
+        memcpy(dest + row * destRowPitch, source + row * sourceRowPitch, rowSize);
+    }
+}
+
+
+StagingRing::StagingRing()
+    : m_capacity(0)
+    , m_head(0)
+    , m_usedSize(0)
+    , m_currentFrameSize(0)
+{
+}
+
+void StagingRing::Reset(size_t capacity)
+{
+    m_capacity = capacity;
+    m_head = 0;
+    m_usedSize = 0;
+    m_currentFrameSize = 0;
+    m_frames.clear();
+}
+
+bool StagingRing::Allocate(size_t size, size_t alignment, size_t& offset)
+{
+    if (size == 0 || size > m_capacity)
+    {
+        return false;
+    }
+
+    // Start from the beginning when the ring is empty, so the whole capacity is available.
+    if (m_usedSize == 0)
+    {
+        m_head = 0;
+    }
+
+    size_t start = (m_head + alignment - 1) / alignment * alignment;
+    size_t consumed;
+
+    if (start + size <= m_capacity)
+    {
+        consumed = start + size - m_head;
+    }
+    else
+    {
+        // The space at the end is too small, skip it and wrap around.
+        start = 0;
+        consumed = m_capacity - m_head + size;
+    }
+
+    if (m_usedSize + consumed > m_capacity)
+    {
+        return false;
+    }
+
+    offset = start;
+    m_head = start + size;
+    m_usedSize += consumed;
+    m_currentFrameSize += consumed;
+
+    return true;
+}
+
+void StagingRing::EndFrame(uint64_t fenceValue)
+{
+    if (m_currentFrameSize > 0)
+    {
+        m_frames.push_back({ fenceValue, m_currentFrameSize });
+        m_currentFrameSize = 0;
+    }
+}
+
+void StagingRing::Retire(uint64_t completedFenceValue)
+{
+    while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+    {
+        m_usedSize -= m_frames.front().size;
+        m_frames.pop_front();
+    }
+}
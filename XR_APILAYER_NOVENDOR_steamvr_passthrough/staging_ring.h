@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+
+// Copies rows between buffers with different row pitches, as a single copy when both are tightly packed.
+void CopyRows(uint8_t* dest, size_t destRowPitch, const uint8_t* source, size_t sourceRowPitch, size_t rowSize, uint32_t numRows);
+
+
+// Sub-allocates upload memory from a fixed size buffer in submission order, and reuses it once the GPU
+// has finished with the frames that used it. The renderer supplies the fence values, so the ring itself
+// doesn't depend on the graphics API or own any GPU memory.
+class StagingRing
+{
+public:
+	StagingRing();
+
+	// Discards all allocations. The caller must make sure the GPU is done with the old memory.
+	void Reset(size_t capacity);
+
+	// Allocates memory for the frame being recorded. Returns false if the ring doesn't have enough free space,
+	// in which case the caller can wait for the oldest frame with GetOldestFenceValue() and retire it.
+	bool Allocate(size_t size, size_t alignment, size_t& offset);
+
+	// Closes the allocations of the frame being recorded. The GPU is done with them once the fence reaches fenceValue.
+	void EndFrame(uint64_t fenceValue);
+
+	// Frees the allocations of the frames the GPU has finished.
+	void Retire(uint64_t completedFenceValue);
+
+	// Fence value of the oldest frame still using the ring, or 0 if there is none.
+	uint64_t GetOldestFenceValue() const { return m_frames.empty() ? 0 : m_frames.front().fenceValue; }
+
+	size_t GetCapacity() const { return m_capacity; }
+	size_t GetUsedSize() const { return m_usedSize; }
+
+private:
+	struct FrameAllocation
+	{
+		uint64_t fenceValue;
+		size_t size;
+	};
+
+	size_t m_capacity;
+	size_t m_head;
+	size_t m_usedSize;
+
+	// Bytes used by the frame being recorded, including padding and any space skipped when wrapping around.
+	size_t m_currentFrameSize;
+	std::deque<FrameAllocation> m_frames;
+};
@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "trace.h"
+#include <log.h>
+#include "layer.h"
+
+using namespace steamvr_passthrough;
+using namespace steamvr_passthrough::log;
+
+
+std::atomic_bool Tracer::s_bEnabled = false;
+
+
+static uint32_t GetTraceThreadId()
+{
+#ifdef _WIN32
+    return (uint32_t)GetCurrentThreadId();
+#else
+    return (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+
+// Per-thread name and the event buffer of the current capture, if the thread has written events in it.
+// The registry owns the buffer, so it can be released when the capture stops while the thread lives on.
+struct TraceThreadRecord
+{
+    std::string threadName;
+    std::weak_ptr<TraceThreadBuffer> buffer;
+
+    ~TraceThreadRecord()
+    {
+        std::shared_ptr<TraceThreadBuffer> threadBuffer = buffer.lock();
+        if (threadBuffer)
+        {
+            threadBuffer->bThreadExited.store(true, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local TraceThreadRecord g_threadRecord;
+
+
+Tracer& Tracer::Get()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+
+bool Tracer::Start()
+{
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+
+    if (m_bRunFlushThread)
+    {
+        return true;
+    }
+
+    const char* appData = getenv("LOCALAPPDATA");
+    std::filesystem::path traceDir = appData ? std::filesystem::path(appData) : std::filesystem::temp_directory_path();
+
+    m_traceFilePath = (traceDir / (LayerName + "_trace.json")).string();
+    m_traceFile.open(m_traceFilePath, std::ios_base::out | std::ios_base::trunc);
+
+    if (!m_traceFile.is_open())
+    {
+        ErrorLog("Failed to open trace file %s\n", m_traceFilePath.c_str());
+        return false;
+    }
+
+    m_traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    m_bFirstEvent = true;
+    m_startTime = GetMonotonicTimeNs();
+
+    {
+        std::lock_guard<std::mutex> bufferLock(m_buffersMutex);
+        m_exitedThreadDroppedEvents = 0;
+    }
+
+    m_bRunFlushThread = true;
+    m_flushThread = std::thread(&Tracer::RunFlushThread, this);
+
+    s_bEnabled = true;
+
+    Log("Started tracing to %s\n", m_traceFilePath.c_str());
+    return true;
+}
+
+
+void Tracer::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+
+    s_bEnabled = false;
+
+    if (!m_bRunFlushThread)
+    {
+        return;
+    }
+
+    m_bRunFlushThread = false;
+    if (m_flushThread.joinable())
+    {
+        m_flushThread.join();
+    }
+
+    FlushBuffers();
+
+    m_traceFile << "\n]}\n";
+    m_traceFile.close();
+
+    // Threads allocate a new buffer if they write events in a later capture.
+    {
+        std::lock_guard<std::mutex> bufferLock(m_buffersMutex);
+        m_buffers.clear();
+    }
+
+    Log("Stopped tracing\n");
+}
+
+
+std::shared_ptr<TraceThreadBuffer> Tracer::GetThreadBuffer()
+{
+    std::shared_ptr<TraceThreadBuffer> threadBuffer = g_threadRecord.buffer.lock();
+    if (threadBuffer)
+    {
+        return threadBuffer;
+    }
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+    // Stop() clears the registry after disabling tracing, so no buffer is left behind once it has.
+    if (!IsEnabled())
+    {
+        return nullptr;
+    }
+
+    threadBuffer = std::make_shared<TraceThreadBuffer>();
+    threadBuffer->threadId = GetTraceThreadId();
+    threadBuffer->threadName = g_threadRecord.threadName;
+
+    m_buffers.push_back(threadBuffer);
+    g_threadRecord.buffer = threadBuffer;
+
+    return threadBuffer;
+}
+
+
+void Tracer::SetThreadName(const char* name)
+{
+    g_threadRecord.threadName = name;
+
+    std::shared_ptr<TraceThreadBuffer> buffer = g_threadRecord.buffer.lock();
+    if (buffer)
+    {
+        std::lock_guard<std::mutex> lock(buffer->nameMutex);
+        buffer->threadName = name;
+        buffer->bNameWritten = false;
+    }
+}
+
+
+void Tracer::WriteEvent(const char* name, uint64_t startNs, uint64_t durationNs, uint64_t frame)
+{
+    std::shared_ptr<TraceThreadBuffer> buffer = GetThreadBuffer();
+    if (!buffer)
+    {
+        return;
+    }
+
+    uint32_t write = buffer->writeIndex.load(std::memory_order_relaxed);
+    uint32_t read = buffer->readIndex.load(std::memory_order_acquire);
+
+    if (write - read >= TRACE_THREAD_BUFFER_SIZE)
+    {
+        buffer->droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent& event = buffer->events[write % TRACE_THREAD_BUFFER_SIZE];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.frame = frame;
+
+    buffer->writeIndex.store(write + 1, std::memory_order_release);
+}
+
+
+uint64_t Tracer::GetDroppedEvents()
+{
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+    uint64_t dropped = m_exitedThreadDroppedEvents;
+    for (std::shared_ptr<TraceThreadBuffer>& buffer : m_buffers)
+    {
+        dropped += buffer->droppedEvents.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+
+void Tracer::RunFlushThread()
+{
+    while (m_bRunFlushThread)
+    {
+        std::this_thread::sleep_for(TRACE_FLUSH_INTERVAL);
+        FlushBuffers();
+    }
+}
+
+
+void Tracer::FlushBuffers()
+{
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffers = m_buffers;
+    }
+
+#ifdef _WIN32
+    uint32_t processId = (uint32_t)GetCurrentProcessId();
+#else
+    uint32_t processId = 1;
+#endif
+
+    std::vector<std::shared_ptr<TraceThreadBuffer>> exitedBuffers;
+
+    for (std::shared_ptr<TraceThreadBuffer>& buffer : buffers)
+    {
+        // Read before the write index, so all events of an exited thread are seen.
+        if (buffer->bThreadExited.load(std::memory_order_acquire))
+        {
+            exitedBuffers.push_back(buffer);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(buffer->nameMutex);
+
+            if (!buffer->bNameWritten && !buffer->threadName.empty())
+            {
+                m_traceFile << (m_bFirstEvent ? "" : ",\n") << std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                    processId, buffer->threadId, buffer->threadName);
+                m_bFirstEvent = false;
+                buffer->bNameWritten = true;
+            }
+        }
+
+        uint32_t read = buffer->readIndex.load(std::memory_order_relaxed);
+        uint32_t write = buffer->writeIndex.load(std::memory_order_acquire);
+
+        for (; read != write; read++)
+        {
+            const TraceEvent& event = buffer->events[read % TRACE_THREAD_BUFFER_SIZE];
+
+            // Events from before the capture started may still be in the buffer.
+            if (event.startNs < m_startTime)
+            {
+                continue;
+            }
+
+            m_traceFile << (m_bFirstEvent ? "" : ",\n") << std::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                event.name, processId, buffer->threadId, (event.startNs - m_startTime) / 1000.0, event.durationNs / 1000.0);
+
+            if (event.frame != TRACE_NO_FRAME)
+            {
+                m_traceFile << std::format(",\"args\":{{\"frame\":{}}}", event.frame);
+            }
+            m_traceFile << "}";
+            m_bFirstEvent = false;
+        }
+
+        buffer->readIndex.store(write, std::memory_order_release);
+    }
+
+    // The buffers of exited threads are empty now.
+    if (!exitedBuffers.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+        for (std::shared_ptr<TraceThreadBuffer>& buffer : exitedBuffers)
+        {
+            auto it = std::find(m_buffers.begin(), m_buffers.end(), buffer);
+            if (it != m_buffers.end())
+            {
+                m_exitedThreadDroppedEvents += buffer->droppedEvents.load(std::memory_order_relaxed);
+                m_buffers.erase(it);
+            }
+        }
+    }
+
+    m_traceFile.flush();
+}
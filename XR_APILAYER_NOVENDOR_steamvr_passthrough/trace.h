@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+
+// Events per thread buffered between flushes. Events are dropped if a thread fills its buffer before the flush thread drains it.
+#define TRACE_THREAD_BUFFER_SIZE 4096
+#define TRACE_FLUSH_INTERVAL (std::chrono::milliseconds(100))
+
+#define TRACE_NO_FRAME UINT64_MAX
+
+
+// Completed span. The name must be a string with static storage duration.
+struct TraceEvent
+{
+	const char* name;
+	uint64_t startNs;
+	uint64_t durationNs;
+	uint64_t frame;
+};
+
+// Single producer, single consumer ring written by the owning thread and drained by the flush thread.
+// Only allocated for threads that write events during a capture, and released when the capture stops or the thread exits.
+struct TraceThreadBuffer
+{
+	std::array<TraceEvent, TRACE_THREAD_BUFFER_SIZE> events;
+	std::atomic_uint32_t writeIndex{ 0 };
+	std::atomic_uint32_t readIndex{ 0 };
+	std::atomic_uint64_t droppedEvents{ 0 };
+	uint32_t threadId = 0;
+
+	std::mutex nameMutex;
+	std::string threadName;
+	bool bNameWritten = false;
+
+	// Set when the owning thread exits. The flush thread drains the buffer and then removes it.
+	std::atomic_bool bThreadExited{ false };
+};
+
+
+// Writes layer activity as Chrome trace event JSON, viewable in Perfetto or chrome://tracing.
+class Tracer
+{
+public:
+	static Tracer& Get();
+
+	static bool IsEnabled() { return s_bEnabled.load(std::memory_order_relaxed); }
+
+	bool Start();
+	void Stop();
+
+	void SetThreadName(const char* name);
+	void WriteEvent(const char* name, uint64_t startNs, uint64_t durationNs, uint64_t frame);
+
+	const std::string& GetTraceFilePath() const { return m_traceFilePath; }
+	uint64_t GetDroppedEvents();
+
+private:
+	Tracer() {}
+
+	std::shared_ptr<TraceThreadBuffer> GetThreadBuffer();
+	void RunFlushThread();
+	void FlushBuffers();
+
+	static std::atomic_bool s_bEnabled;
+
+	std::mutex m_controlMutex;
+	std::mutex m_buffersMutex;
+	std::vector<std::shared_ptr<TraceThreadBuffer>> m_buffers;
+	uint64_t m_exitedThreadDroppedEvents = 0;
+
+	std::thread m_flushThread;
+	std::atomic_bool m_bRunFlushThread{ false };
+	std::ofstream m_traceFile;
+	std::string m_traceFilePath;
+	bool m_bFirstEvent = true;
+	uint64_t m_startTime = 0;
+};
+
+
+// Records a span from construction to destruction while tracing is enabled.
+class TraceSpan
+{
+public:
+	TraceSpan(const char* name, uint64_t frame = TRACE_NO_FRAME)
+		: m_name(name)
+		, m_frame(frame)
+		, m_startTime(Tracer::IsEnabled() ? GetMonotonicTimeNs() : 0)
+	{}
+
+	~TraceSpan()
+	{
+		End();
+	}
+
+	void SetFrame(uint64_t frame) { m_frame = frame; }
+
+	void End()
+	{
+		if (m_startTime != 0 && Tracer::IsEnabled())
+		{
+			uint64_t now = GetMonotonicTimeNs();
+			Tracer::Get().WriteEvent(m_name, m_startTime, now - m_startTime, m_frame);
+		}
+		m_startTime = 0;
+	}
+
+private:
+	const char* m_name;
+	uint64_t m_frame;
+	uint64_t m_startTime;
+};
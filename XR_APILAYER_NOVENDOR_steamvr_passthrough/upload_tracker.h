@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+
+
+// Key for a slot that holds no known data.
+#define UPLOAD_KEY_NONE UINT64_MAX
+
+
+enum EUploadResource
+{
+	UploadResource_CameraFrame = 0,
+	UploadResource_DisparityMap,
+	UploadResource_Count
+};
+
+
+// Tracks which CPU data each per-frame GPU resource slot holds, so that data already resident is not uploaded again.
+// Applications usually render faster than the cameras deliver frames, so most frames can reuse an earlier upload.
+// The renderer passes the upload itself as a function, which keeps the tracker independent of the graphics API.
+class UploadTracker
+{
+public:
+	UploadTracker()
+		: m_uploadedBytes(0)
+		, m_skippedUploads(0)
+		, m_uploadedBytesCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_UPLOADED_BYTES))
+		, m_skippedUploadsCounter(MetricsRegistry::Get().GetCounter(METRIC_COUNTER_SKIPPED_UPLOADS))
+	{}
+
+	// Calls uploadFunc() unless the slot already holds the data identified by the key. Returns true if the upload was done.
+	// The key must change whenever the data does, UPLOAD_KEY_NONE always uploads.
+	// uploadFunc() returns false if the upload failed, which leaves the slot contents unknown so that the next call retries.
+	template<typename TUploadFunc>
+	bool Upload(EUploadResource resource, uint32_t slot, uint64_t key, size_t numBytes, TUploadFunc uploadFunc)
+	{
+		std::vector<uint64_t>& slotKeys = m_slotKeys[resource];
+
+		if (slot >= slotKeys.size())
+		{
+			slotKeys.resize(slot + 1, UPLOAD_KEY_NONE);
+		}
+
+		if (key != UPLOAD_KEY_NONE && slotKeys[slot] == key)
+		{
+			m_skippedUploads++;
+			m_skippedUploadsCounter.Add();
+			return false;
+		}
+
+		if (!uploadFunc())
+		{
+			slotKeys[slot] = UPLOAD_KEY_NONE;
+			return false;
+		}
+
+		slotKeys[slot] = key;
+		m_uploadedBytes += numBytes;
+		m_uploadedBytesCounter.Add(numBytes);
+		return true;
+	}
+
+	// Forgets the contents of a slot after its resource has been recreated.
+	void Invalidate(EUploadResource resource, uint32_t slot)
+	{
+		if (slot < m_slotKeys[resource].size())
+		{
+			m_slotKeys[resource][slot] = UPLOAD_KEY_NONE;
+		}
+	}
+
+	// Forgets the contents of all slots of a resource.
+	void Invalidate(EUploadResource resource)
+	{
+		m_slotKeys[resource].clear();
+	}
+
+	uint64_t GetSlotKey(EUploadResource resource, uint32_t slot) const
+	{
+		return slot < m_slotKeys[resource].size() ? m_slotKeys[resource][slot] : UPLOAD_KEY_NONE;
+	}
+
+	uint64_t GetUploadedBytes() const { return m_uploadedBytes; }
+	uint64_t GetSkippedUploads() const { return m_skippedUploads; }
+
+private:
+	std::array<std::vector<uint64_t>, UploadResource_Count> m_slotKeys;
+
+	uint64_t m_uploadedBytes;
+	uint64_t m_skippedUploads;
+
+	MetricCounter& m_uploadedBytesCounter;
+	MetricCounter& m_skippedUploadsCounter;
+};
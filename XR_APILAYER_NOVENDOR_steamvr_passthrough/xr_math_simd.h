@@ -0,0 +1,187 @@
+#pragma once
+
+#include <xr_linear.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define XR_MATH_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define XR_MATH_USE_SSE 0
+#endif
+
+
+// SSE versions of the xr_linear.h matrix operations used in the per-frame projection setup.
+// Matrices are column major as in xr_linear.h, and may alias the output.
+
+#if XR_MATH_USE_SSE
+
+#define XR_MATH_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define XR_MATH_SWIZZLE(vec, x, y, z, w) _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(vec), XR_MATH_SHUFFLE_MASK(x, y, z, w)))
+#define XR_MATH_SHUFFLE(vec1, vec2, x, y, z, w) _mm_shuffle_ps(vec1, vec2, XR_MATH_SHUFFLE_MASK(x, y, z, w))
+
+
+inline void XrMatrix4x4f_LoadSIMD(__m128 cols[4], const XrMatrix4x4f* src)
+{
+	cols[0] = _mm_loadu_ps(&src->m[0]);
+	cols[1] = _mm_loadu_ps(&src->m[4]);
+	cols[2] = _mm_loadu_ps(&src->m[8]);
+	cols[3] = _mm_loadu_ps(&src->m[12]);
+}
+
+inline void XrMatrix4x4f_StoreSIMD(XrMatrix4x4f* dst, const __m128 cols[4])
+{
+	_mm_storeu_ps(&dst->m[0], cols[0]);
+	_mm_storeu_ps(&dst->m[4], cols[1]);
+	_mm_storeu_ps(&dst->m[8], cols[2]);
+	_mm_storeu_ps(&dst->m[12], cols[3]);
+}
+
+inline __m128 XrMatrix4x4f_TransformColumnSIMD(const __m128 cols[4], const float* column)
+{
+	__m128 result = _mm_mul_ps(cols[0], _mm_set1_ps(column[0]));
+	result = _mm_add_ps(result, _mm_mul_ps(cols[1], _mm_set1_ps(column[1])));
+	result = _mm_add_ps(result, _mm_mul_ps(cols[2], _mm_set1_ps(column[2])));
+	result = _mm_add_ps(result, _mm_mul_ps(cols[3], _mm_set1_ps(column[3])));
+	return result;
+}
+
+// 2x2 block helpers for the inverse, blocks are stored as (m00, m01, m10, m11).
+inline __m128 XrMatrix2x2_MulSIMD(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, XR_MATH_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(XR_MATH_SWIZZLE(a, 1, 0, 3, 2), XR_MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+inline __m128 XrMatrix2x2_AdjMulSIMD(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(XR_MATH_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(XR_MATH_SWIZZLE(a, 1, 1, 2, 2), XR_MATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+inline __m128 XrMatrix2x2_MulAdjSIMD(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, XR_MATH_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(XR_MATH_SWIZZLE(a, 1, 0, 3, 2), XR_MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+#endif
+
+
+// result = a * b
+inline void XrMatrix4x4f_MultiplySIMD(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b)
+{
+#if XR_MATH_USE_SSE
+	__m128 colsA[4];
+	XrMatrix4x4f_LoadSIMD(colsA, a);
+
+	__m128 colsOut[4];
+	colsOut[0] = XrMatrix4x4f_TransformColumnSIMD(colsA, &b->m[0]);
+	colsOut[1] = XrMatrix4x4f_TransformColumnSIMD(colsA, &b->m[4]);
+	colsOut[2] = XrMatrix4x4f_TransformColumnSIMD(colsA, &b->m[8]);
+	colsOut[3] = XrMatrix4x4f_TransformColumnSIMD(colsA, &b->m[12]);
+
+	XrMatrix4x4f_StoreSIMD(result, colsOut);
+#else
+	XrMatrix4x4f temp;
+	XrMatrix4x4f_Multiply(&temp, a, b);
+	*result = temp;
+#endif
+}
+
+// result = a * b * c
+inline void XrMatrix4x4f_Multiply3SIMD(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b, const XrMatrix4x4f* c)
+{
+	XrMatrix4x4f temp;
+	XrMatrix4x4f_MultiplySIMD(&temp, b, c);
+	XrMatrix4x4f_MultiplySIMD(result, a, &temp);
+}
+
+
+// Inverse of a rotation and translation only matrix.
+inline void XrMatrix4x4f_InvertRigidBodySIMD(XrMatrix4x4f* result, const XrMatrix4x4f* src)
+{
+#if XR_MATH_USE_SSE
+	__m128 cols[4];
+	XrMatrix4x4f_LoadSIMD(cols, src);
+
+	// Transpose the rotation part, the fourth input column is replaced by zeros so the new rotation columns get w = 0.
+	__m128 rot0 = cols[0];
+	__m128 rot1 = cols[1];
+	__m128 rot2 = cols[2];
+	__m128 rot3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(rot0, rot1, rot2, rot3);
+
+	__m128 translation = _mm_mul_ps(rot0, XR_MATH_SWIZZLE(cols[3], 0, 0, 0, 0));
+	translation = _mm_add_ps(translation, _mm_mul_ps(rot1, XR_MATH_SWIZZLE(cols[3], 1, 1, 1, 1)));
+	translation = _mm_add_ps(translation, _mm_mul_ps(rot2, XR_MATH_SWIZZLE(cols[3], 2, 2, 2, 2)));
+	translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+
+	__m128 colsOut[4] = { rot0, rot1, rot2, translation };
+	XrMatrix4x4f_StoreSIMD(result, colsOut);
+#else
+	XrMatrix4x4f temp;
+	XrMatrix4x4f_InvertRigidBody(&temp, src);
+	*result = temp;
+#endif
+}
+
+
+// General 4x4 inverse using 2x2 block matrices.
+inline void XrMatrix4x4f_InvertSIMD(XrMatrix4x4f* result, const XrMatrix4x4f* src)
+{
+#if XR_MATH_USE_SSE
+	// The block method works on the transposed layout as well, since inverse(transpose(M)) = transpose(inverse(M)).
+	__m128 cols[4];
+	XrMatrix4x4f_LoadSIMD(cols, src);
+
+	__m128 A = _mm_movelh_ps(cols[0], cols[1]);
+	__m128 B = _mm_movehl_ps(cols[1], cols[0]);
+	__m128 C = _mm_movelh_ps(cols[2], cols[3]);
+	__m128 D = _mm_movehl_ps(cols[3], cols[2]);
+
+	// Determinants of the blocks as (|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(XR_MATH_SHUFFLE(cols[0], cols[2], 0, 2, 0, 2), XR_MATH_SHUFFLE(cols[1], cols[3], 1, 3, 1, 3)),
+		_mm_mul_ps(XR_MATH_SHUFFLE(cols[0], cols[2], 1, 3, 1, 3), XR_MATH_SHUFFLE(cols[1], cols[3], 0, 2, 0, 2)));
+
+	__m128 detA = XR_MATH_SWIZZLE(detSub, 0, 0, 0, 0);
+	__m128 detB = XR_MATH_SWIZZLE(detSub, 1, 1, 1, 1);
+	__m128 detC = XR_MATH_SWIZZLE(detSub, 2, 2, 2, 2);
+	__m128 detD = XR_MATH_SWIZZLE(detSub, 3, 3, 3, 3);
+
+	__m128 D_C = XrMatrix2x2_AdjMulSIMD(D, C);
+	__m128 A_B = XrMatrix2x2_AdjMulSIMD(A, B);
+
+	__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), XrMatrix2x2_MulSIMD(B, D_C));
+	__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), XrMatrix2x2_MulSIMD(C, A_B));
+	__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), XrMatrix2x2_MulAdjSIMD(D, A_B));
+	__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), XrMatrix2x2_MulAdjSIMD(A, D_C));
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 tr = _mm_mul_ps(A_B, XR_MATH_SWIZZLE(D_C, 0, 2, 1, 3));
+	tr = _mm_add_ps(tr, XR_MATH_SWIZZLE(tr, 2, 3, 0, 1));
+	tr = _mm_add_ps(tr, XR_MATH_SWIZZLE(tr, 1, 0, 3, 2));
+
+	__m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+	detM = _mm_sub_ps(detM, tr);
+
+	__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+	X_ = _mm_mul_ps(X_, rDetM);
+	Y_ = _mm_mul_ps(Y_, rDetM);
+	Z_ = _mm_mul_ps(Z_, rDetM);
+	W_ = _mm_mul_ps(W_, rDetM);
+
+	__m128 colsOut[4];
+	colsOut[0] = XR_MATH_SHUFFLE(X_, Y_, 3, 1, 3, 1);
+	colsOut[1] = XR_MATH_SHUFFLE(X_, Y_, 2, 0, 2, 0);
+	colsOut[2] = XR_MATH_SHUFFLE(Z_, W_, 3, 1, 3, 1);
+	colsOut[3] = XR_MATH_SHUFFLE(Z_, W_, 2, 0, 2, 0);
+
+	XrMatrix4x4f_StoreSIMD(result, colsOut);
+#else
+	XrMatrix4x4f temp;
+	XrMatrix4x4f_Invert(&temp, src);
+	*result = temp;
+#endif
+}
+
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "atomic_file.h"
+
+
+static std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void WriteFileDirect(const std::filesystem::path& path, const std::string& data)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << data;
+}
+
+class AtomicFileTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const testing::TestInfo* info = testing::UnitTest::GetInstance()->current_test_info();
+        m_directory = std::filesystem::path(testing::TempDir()) / (std::string("atomic_file_") + info->name());
+        std::filesystem::remove_all(m_directory);
+        std::filesystem::create_directories(m_directory);
+        m_path = m_directory / "config.ini";
+    }
+
+    void TearDown() override
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_directory, error);
+    }
+
+    std::filesystem::path TempPath() const
+    {
+        std::filesystem::path tempPath(m_path);
+        tempPath += ".tmp";
+        return tempPath;
+    }
+
+    std::filesystem::path m_directory;
+    std::filesystem::path m_path;
+};
+
+
+TEST_F(AtomicFileTest, CreatesNewFile)
+{
+    EXPECT_TRUE(WriteFileAtomic(m_path, "[Main]\nEnablePassthrough = true\n"));
+    EXPECT_EQ(ReadFile(m_path), "[Main]\nEnablePassthrough = true\n");
+    EXPECT_FALSE(std::filesystem::exists(TempPath()));
+}
+
+TEST_F(AtomicFileTest, ReplacesOldFileWithoutWritingIntoIt)
+{
+    WriteFileDirect(m_path, "old contents that are longer than the new ones\n");
+
+    // The old file is replaced by renaming the new one over it, so a second link to the old file keeps the old contents.
+    std::filesystem::path oldLink = m_directory / "old.ini";
+    std::filesystem::create_hard_link(m_path, oldLink);
+
+    EXPECT_TRUE(WriteFileAtomic(m_path, "new\n"));
+    EXPECT_EQ(ReadFile(m_path), "new\n");
+    EXPECT_EQ(ReadFile(oldLink), "old contents that are longer than the new ones\n");
+    EXPECT_FALSE(std::filesystem::exists(TempPath()));
+}
+
+TEST_F(AtomicFileTest, FailedWriteKeepsOldFile)
+{
+    WriteFileDirect(m_path, "old\n");
+
+    // The temporary file can't be created when a directory is in its place.
+    std::filesystem::create_directories(TempPath() / "blocker");
+
+    EXPECT_FALSE(WriteFileAtomic(m_path, "new\n"));
+    EXPECT_EQ(ReadFile(m_path), "old\n");
+}
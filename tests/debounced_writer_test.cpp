@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include "pch.h"
+#include "debounced_writer.h"
+
+
+static const std::chrono::milliseconds TestDebounce = 100ms;
+
+// Records the written values and when they were written.
+class WriteRecorder
+{
+public:
+    void Write(const int& value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_values.push_back(value);
+            m_times.push_back(std::chrono::steady_clock::now());
+        }
+        m_condition.notify_all();
+    }
+
+    bool WaitForWrites(size_t numWrites)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_condition.wait_for(lock, 10s, [&] { return m_values.size() >= numWrites; });
+    }
+
+    std::vector<int> GetValues()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_values;
+    }
+
+    std::chrono::steady_clock::time_point GetTime(size_t index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_times[index];
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<int> m_values;
+    std::vector<std::chrono::steady_clock::time_point> m_times;
+};
+
+class DebouncedWriterTest : public testing::Test
+{
+protected:
+    void StartThread()
+    {
+        m_thread = std::thread([this] { m_writer.Run(); });
+    }
+
+    void TearDown() override
+    {
+        m_writer.Stop();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    WriteRecorder m_recorder;
+    DebouncedWriter<int> m_writer{ TestDebounce, [this](const int& value) { m_recorder.Write(value); } };
+    std::thread m_thread;
+};
+
+
+TEST_F(DebouncedWriterTest, RequestsAreCoalesced)
+{
+    for (int value = 1; value <= 5; value++)
+    {
+        m_writer.Request(value, false);
+    }
+    std::chrono::steady_clock::time_point requestTime = std::chrono::steady_clock::now();
+
+    StartThread();
+    ASSERT_TRUE(m_recorder.WaitForWrites(1));
+    EXPECT_GE(m_recorder.GetTime(0) - requestTime, TestDebounce);
+
+    std::this_thread::sleep_for(TestDebounce * 2);
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 5 }));
+}
+
+TEST_F(DebouncedWriterTest, RequestsPushTheWriteBack)
+{
+    StartThread();
+
+    std::chrono::steady_clock::time_point requestTime;
+    for (int value = 1; value <= 4; value++)
+    {
+        requestTime = std::chrono::steady_clock::now();
+        m_writer.Request(value, false);
+        std::this_thread::sleep_for(TestDebounce / 4);
+    }
+
+    ASSERT_TRUE(m_recorder.WaitForWrites(1));
+    EXPECT_GE(m_recorder.GetTime(0) - requestTime, TestDebounce);
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 4 }));
+}
+
+TEST_F(DebouncedWriterTest, ImmediateRequestsAreNotDelayed)
+{
+    // A debounced request after an immediate one replaces the data, but doesn't delay the write.
+    m_writer.Request(1, false);
+    m_writer.Request(2, true);
+    m_writer.Request(3, false);
+    std::chrono::steady_clock::time_point requestTime = std::chrono::steady_clock::now();
+
+    StartThread();
+    ASSERT_TRUE(m_recorder.WaitForWrites(1));
+    EXPECT_LT(m_recorder.GetTime(0) - requestTime, TestDebounce);
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 3 }));
+
+    m_writer.Request(4, true);
+    ASSERT_TRUE(m_recorder.WaitForWrites(2));
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 3, 4 }));
+}
+
+TEST_F(DebouncedWriterTest, StopWritesPendingData)
+{
+    DebouncedWriter<int> writer(10s, [this](const int& value) { m_recorder.Write(value); });
+
+    writer.Request(1, false);
+    writer.Stop();
+
+    // Returns right away, without waiting out the debounce interval.
+    std::chrono::steady_clock::time_point stopTime = std::chrono::steady_clock::now();
+    writer.Run();
+    EXPECT_LT(std::chrono::steady_clock::now() - stopTime, 5s);
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 1 }));
+
+    // Nothing is written when there is nothing pending.
+    writer.Run();
+    EXPECT_EQ(m_recorder.GetValues(), std::vector<int>({ 1 }));
+}
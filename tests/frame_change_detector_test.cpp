@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "frame_change_detector.h"
+
+
+static const int TestFrameSize = 128;
+static const int TestBandHeight = 32;
+static const float TestLumaThreshold = 4.0f;
+
+// Camera pose translated along X and rotated around Y, column major.
+static XrMatrix4x4f CreatePose(float translationX, float rotationDeg)
+{
+    float angle = rotationDeg * (float)CV_PI / 180.0f;
+
+    XrMatrix4x4f pose{};
+    pose.m[0] = cosf(angle);
+    pose.m[2] = -sinf(angle);
+    pose.m[5] = 1.0f;
+    pose.m[8] = sinf(angle);
+    pose.m[10] = cosf(angle);
+    pose.m[12] = translationX;
+    pose.m[15] = 1.0f;
+    return pose;
+}
+
+static cv::Mat CreateFrame(int rows = TestFrameSize, int cols = TestFrameSize)
+{
+    cv::Mat frame(rows, cols, CV_8UC1);
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            frame.at<uint8_t>(y, x) = (uint8_t)(64 + (x * 7 + y * 3) % 128);
+        }
+    }
+    return frame;
+}
+
+// Brightens a block of the frame, within one band and one tile of the downscaled luma.
+static cv::Mat ChangeBlock(const cv::Mat& frame, int band)
+{
+    cv::Mat changed;
+    frame.copyTo(changed);
+
+    for (int y = band * TestBandHeight + 6; y < band * TestBandHeight + 18; y++)
+    {
+        for (int x = 0; x < 32; x++)
+        {
+            changed.at<uint8_t>(y, x) += 40;
+        }
+    }
+    return changed;
+}
+
+
+TEST(FrameChangeDetector, FirstFrameAndCameraMotionNeedFullMatch)
+{
+    FrameChangeDetector detector;
+    cv::Mat frame = CreateFrame();
+    std::vector<uint8_t> changedBands;
+
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(0.0f, 0.0f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 1, 1, 1, 1 }));
+
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(0.0f, 0.0f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 0, 0, 0, 0 }));
+
+    // Tracking noise below the thresholds is ignored.
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(CHANGE_DETECTOR_MAX_TRANSLATION * 0.5f, 0.0f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(0.0f, CHANGE_DETECTOR_MAX_ROTATION_DEG * 0.5f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(CHANGE_DETECTOR_MAX_TRANSLATION * 1.5f, 0.0f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 1, 1, 1, 1 }));
+
+    // The pose of the last full match is the new reference.
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(CHANGE_DETECTOR_MAX_TRANSLATION * 1.5f, 0.0f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), CreatePose(CHANGE_DETECTOR_MAX_TRANSLATION * 1.5f, CHANGE_DETECTOR_MAX_ROTATION_DEG * 1.5f), TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+}
+
+TEST(FrameChangeDetector, OnlyChangedBandsAreMatched)
+{
+    FrameChangeDetector detector;
+    cv::Mat frame = CreateFrame();
+    XrMatrix4x4f pose = CreatePose(0.0f, 0.0f);
+    std::vector<uint8_t> changedBands;
+
+    ASSERT_EQ(detector.Update(frame, frame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+
+    cv::Mat changedLeft = ChangeBlock(frame, 2);
+    EXPECT_EQ(detector.Update(changedLeft, frame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Partial);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 0, 0, 1, 0 }));
+
+    // The matched band became the reference.
+    EXPECT_EQ(detector.Update(changedLeft, frame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+
+    // Changes in the right frame count as well.
+    cv::Mat changedRight = ChangeBlock(frame, 0);
+    EXPECT_EQ(detector.Update(changedLeft, changedRight, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Partial);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 1, 0, 0, 0 }));
+
+    // The block brightens its tile by 15 levels on average, which is below this threshold.
+    EXPECT_EQ(detector.Update(changedLeft, frame, pose, 20.0f, TestBandHeight, changedBands), FrameChange_None);
+}
+
+TEST(FrameChangeDetector, StaleBandsAreMatchedAgain)
+{
+    FrameChangeDetector detector;
+    cv::Mat frame = CreateFrame();
+    XrMatrix4x4f pose = CreatePose(0.0f, 0.0f);
+    std::vector<uint8_t> changedBands;
+
+    ASSERT_EQ(detector.Update(frame, cv::Mat(), pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+
+    for (uint32_t frameIndex = 1; frameIndex < CHANGE_DETECTOR_MAX_STALE_FRAMES; frameIndex++)
+    {
+        ASSERT_EQ(detector.Update(frame, cv::Mat(), pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+        ASSERT_EQ(detector.GetMaxBandAge(), frameIndex);
+    }
+
+    EXPECT_EQ(detector.Update(frame, cv::Mat(), pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Partial);
+    EXPECT_EQ(changedBands, std::vector<uint8_t>({ 1, 1, 1, 1 }));
+    EXPECT_EQ(detector.GetMaxBandAge(), 0u);
+}
+
+TEST(FrameChangeDetector, LayoutChangesNeedFullMatch)
+{
+    FrameChangeDetector detector;
+    cv::Mat frame = CreateFrame();
+    XrMatrix4x4f pose = CreatePose(0.0f, 0.0f);
+    std::vector<uint8_t> changedBands;
+
+    ASSERT_EQ(detector.Update(frame, cv::Mat(), pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+
+    // The right frame appears.
+    EXPECT_EQ(detector.Update(frame, frame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+
+    // Different resolution.
+    cv::Mat smallFrame = CreateFrame(TestFrameSize - TestBandHeight, TestFrameSize);
+    EXPECT_EQ(detector.Update(smallFrame, smallFrame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+    EXPECT_EQ(changedBands.size(), 3u);
+    EXPECT_EQ(detector.Update(smallFrame, smallFrame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_None);
+
+    detector.Reset();
+    EXPECT_EQ(detector.Update(smallFrame, smallFrame, pose, TestLumaThreshold, TestBandHeight, changedBands), FrameChange_Full);
+}
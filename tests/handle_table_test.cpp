@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_map>
+#include "allocation_counter.h"
+#include "handle_table.h"
+
+
+// Handles in the same shape as the OpenXR ones on 64-bit targets.
+struct TestHandle_T;
+typedef TestHandle_T* TestHandle;
+
+static TestHandle MakeHandle(uint64_t value)
+{
+    return reinterpret_cast<TestHandle>(value);
+}
+
+
+TEST(HandleTable, NoAllocationWithinInlineCapacity)
+{
+    HandleTable<TestHandle, uint32_t, 32> table;
+
+    uint64_t allocationsBefore = GetThreadAllocationCount();
+
+    for (uint64_t i = 1; i <= 16; i++)
+    {
+        table.Insert(MakeHandle(i * 0x1000), (uint32_t)i);
+    }
+
+    for (int repeat = 0; repeat < 100; repeat++)
+    {
+        for (uint64_t i = 1; i <= 16; i++)
+        {
+            uint32_t* value = table.Find(MakeHandle(i * 0x1000));
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, (uint32_t)i);
+        }
+        EXPECT_EQ(table.Find(MakeHandle(0xdead0000)), nullptr);
+    }
+
+    table.Erase(MakeHandle(0x1000));
+    table.Insert(MakeHandle(0x1000), 1);
+    table.ForEach([](TestHandle, uint32_t) {});
+    table.Clear();
+
+    EXPECT_EQ(GetThreadAllocationCount(), allocationsBefore);
+}
+
+TEST(HandleTable, NoAllocationAfterGrowingOnce)
+{
+    HandleTable<TestHandle, uint32_t, 8> table;
+
+    for (uint64_t i = 1; i <= 64; i++)
+    {
+        table.Insert(MakeHandle(i), (uint32_t)i);
+    }
+    table.Clear();
+
+    // A table that has grown to hold the live handles keeps its memory through clears and erases.
+    uint64_t allocationsBefore = GetThreadAllocationCount();
+
+    for (int frame = 0; frame < 100; frame++)
+    {
+        for (uint64_t i = 1; i <= 64; i++)
+        {
+            table.Insert(MakeHandle(i), (uint32_t)i);
+        }
+        for (uint64_t i = 1; i <= 64; i++)
+        {
+            ASSERT_NE(table.Find(MakeHandle(i)), nullptr);
+        }
+        for (uint64_t i = 1; i <= 32; i++)
+        {
+            table.Erase(MakeHandle(i));
+        }
+        table.Clear();
+    }
+
+    EXPECT_EQ(GetThreadAllocationCount(), allocationsBefore);
+}
+
+TEST(HandleTable, GrowsPastInlineCapacity)
+{
+    HandleTable<TestHandle, uint32_t, 8> table;
+
+    uint64_t allocationsBefore = GetThreadAllocationCount();
+
+    for (uint64_t i = 1; i <= 5; i++)
+    {
+        table.Insert(MakeHandle(i), (uint32_t)i);
+    }
+    EXPECT_GT(GetThreadAllocationCount(), allocationsBefore);
+
+    EXPECT_EQ(table.Size(), 5u);
+    for (uint64_t i = 1; i <= 5; i++)
+    {
+        ASSERT_NE(table.Find(MakeHandle(i)), nullptr);
+        EXPECT_EQ(*table.Find(MakeHandle(i)), (uint32_t)i);
+    }
+}
+
+TEST(HandleTable, NullHandleIsIgnored)
+{
+    HandleTable<TestHandle, uint32_t> table;
+
+    table.Insert(nullptr, 1);
+    EXPECT_TRUE(table.IsEmpty());
+    EXPECT_EQ(table.Find(nullptr), nullptr);
+    EXPECT_FALSE(table.Erase(nullptr));
+}
+
+TEST(HandleTable, InsertReplacesValue)
+{
+    HandleTable<uint64_t, uint32_t> table;
+
+    table.Insert(7, 1);
+    table.Insert(7, 2);
+
+    EXPECT_EQ(table.Size(), 1u);
+    EXPECT_EQ(*table.Find(7), 2u);
+}
+
+TEST(HandleTable, MatchesUnorderedMap)
+{
+    HandleTable<uint64_t, uint32_t, 16> table;
+    std::unordered_map<uint64_t, uint32_t> reference;
+    std::mt19937_64 rng(1);
+
+    // Aligned handle values collide on the low bits, which exercises the probing and the erase shifting.
+    for (int i = 0; i < 20000; i++)
+    {
+        uint64_t handle = ((rng() % 96) + 1) * 0x100;
+        uint32_t value = (uint32_t)rng();
+
+        switch (rng() % 3)
+        {
+        case 0:
+        case 1:
+            table.Insert(handle, value);
+            reference[handle] = value;
+            break;
+        case 2:
+            EXPECT_EQ(table.Erase(handle), reference.erase(handle) > 0);
+            break;
+        }
+
+        ASSERT_EQ(table.Size(), reference.size());
+    }
+
+    for (uint64_t handle = 0x100; handle <= 96 * 0x100; handle += 0x100)
+    {
+        auto it = reference.find(handle);
+        uint32_t* value = table.Find(handle);
+
+        if (it == reference.end())
+        {
+            EXPECT_EQ(value, nullptr);
+        }
+        else
+        {
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(*value, it->second);
+        }
+    }
+
+    size_t numVisited = 0;
+    table.ForEach([&](uint64_t handle, uint32_t value)
+    {
+        EXPECT_EQ(reference.at(handle), value);
+        numVisited++;
+    });
+    EXPECT_EQ(numVisited, reference.size());
+}
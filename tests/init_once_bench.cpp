@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include "pch.h"
+#include "init_once.h"
+
+
+// Accessor contention with one and three threads, like the camera, render and menu threads
+// reading the OpenVR interfaces every frame. Compared against taking the lock on every call.
+
+struct BenchInterfaces
+{
+    void* system = nullptr;
+    void* compositor = nullptr;
+};
+
+static int g_dummyInterface = 0;
+
+static bool InitBenchInterfaces(BenchInterfaces& interfaces)
+{
+    interfaces.system = &g_dummyInterface;
+    interfaces.compositor = &g_dummyInterface;
+    return true;
+}
+
+static InitOnce<BenchInterfaces> g_initOnceInterfaces("BenchInitOnce", 1000000000ull);
+
+static void BM_InitOnceGet(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        const BenchInterfaces* interfaces = g_initOnceInterfaces.Get(InitBenchInterfaces);
+        benchmark::DoNotOptimize(interfaces ? interfaces->system : nullptr);
+    }
+}
+BENCHMARK(BM_InitOnceGet)->Threads(1)->Threads(3);
+
+static ProfiledMutex g_lockedMutex("BenchLocked");
+static BenchInterfaces g_lockedInterfaces;
+static bool g_bLockedInitialized = false;
+
+static void BM_LockedGet(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::lock_guard<ProfiledMutex> lock(g_lockedMutex);
+        if (!g_bLockedInitialized)
+        {
+            g_bLockedInitialized = InitBenchInterfaces(g_lockedInterfaces);
+        }
+        benchmark::DoNotOptimize(g_lockedInterfaces.system);
+    }
+}
+BENCHMARK(BM_LockedGet)->Threads(1)->Threads(3);
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "init_once.h"
+
+
+struct TestValue
+{
+    int value = 0;
+};
+
+static const uint64_t TestRetryInterval = 50000000ull;
+
+
+TEST(InitOnce, FailedInitIsRetriedAfterInterval)
+{
+    InitOnce<TestValue> initOnce("TestInitOnceRetry", TestRetryInterval);
+    int numAttempts = 0;
+    bool bSucceed = false;
+
+    auto init = [&](TestValue& value)
+    {
+        numAttempts++;
+        value.value = 42;
+        return bSucceed;
+    };
+
+    EXPECT_EQ(initOnce.Init(init), nullptr);
+    EXPECT_EQ(numAttempts, 1);
+
+    // Not retried within the interval.
+    bSucceed = true;
+    EXPECT_EQ(initOnce.Get(init), nullptr);
+    EXPECT_EQ(numAttempts, 1);
+
+    std::this_thread::sleep_for(std::chrono::nanoseconds(TestRetryInterval));
+    const TestValue* value = initOnce.Get(init);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->value, 42);
+    EXPECT_EQ(numAttempts, 2);
+
+    // Published values are returned without calling init again.
+    EXPECT_EQ(initOnce.Get(init), value);
+    EXPECT_EQ(initOnce.Init(init), value);
+    EXPECT_EQ(numAttempts, 2);
+}
+
+TEST(InitOnce, ShutdownOnlyAfterInit)
+{
+    int numShutdowns = 0;
+    auto shutdown = [&](TestValue&) { numShutdowns++; };
+
+    InitOnce<TestValue> failed("TestInitOnceShutdown", TestRetryInterval);
+    failed.Init([](TestValue&) { return false; });
+    failed.Shutdown(shutdown);
+    EXPECT_EQ(numShutdowns, 0);
+
+    InitOnce<TestValue> succeeded("TestInitOnceShutdown", TestRetryInterval);
+    succeeded.Init([](TestValue&) { return true; });
+    succeeded.Shutdown(shutdown);
+    EXPECT_EQ(numShutdowns, 1);
+}
+
+TEST(InitOnce, ConcurrentCallersInitOnce)
+{
+    InitOnce<TestValue> initOnce("TestInitOnceConcurrent", 0);
+    std::atomic_int numAttempts = 0;
+
+    auto init = [&](TestValue& value)
+    {
+        numAttempts++;
+        std::this_thread::sleep_for(1ms);
+        value.value = 7;
+        return true;
+    };
+
+    std::atomic_int numErrors = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; i++)
+    {
+        threads.emplace_back([&]
+        {
+            for (int call = 0; call < 10000; call++)
+            {
+                const TestValue* value = initOnce.Get(init);
+                if (!value || value->value != 7)
+                {
+                    numErrors++;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(numAttempts, 1);
+    EXPECT_EQ(numErrors, 0);
+}
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include "pch.h"
+#include "mesh.h"
+
+
+// Grid mesh build times, with the simulated post-transform cache stats reported as counters.
+
+static void SetCacheCounters(benchmark::State& state, const Mesh<VertexFormatBasic>& mesh)
+{
+    MeshCacheStats stats = MeshCalculateCacheStats(mesh, MESH_VERTEX_CACHE_SIZE);
+    state.counters["ACMR"] = stats.acmr;
+    state.counters["ATVR"] = stats.atvr;
+}
+
+static void BM_MeshCreateGrid(benchmark::State& state)
+{
+    Mesh<VertexFormatBasic> mesh;
+    for (auto _ : state)
+    {
+        MeshCreateGrid(mesh, (int)state.range(0), (int)state.range(1));
+        benchmark::DoNotOptimize(mesh.triangles.data());
+    }
+    SetCacheCounters(state, mesh);
+}
+BENCHMARK(BM_MeshCreateGrid)->Args({ 160, 120 })->Args({ 320, 240 })->Args({ 640, 480 })->Unit(benchmark::kMicrosecond);
+
+static void BM_MeshCreateHexGrid(benchmark::State& state)
+{
+    Mesh<VertexFormatBasic> mesh;
+    for (auto _ : state)
+    {
+        MeshCreateHexGrid(mesh, (int)state.range(0), (int)state.range(1));
+        benchmark::DoNotOptimize(mesh.triangles.data());
+    }
+    SetCacheCounters(state, mesh);
+}
+BENCHMARK(BM_MeshCreateHexGrid)->Args({ 160, 120 })->Args({ 320, 240 })->Args({ 640, 480 })->Unit(benchmark::kMicrosecond);
+
+// Lookup of an already built grid, the cost paid by every renderer after the first one.
+static void BM_MeshGetGridCached(benchmark::State& state)
+{
+    MeshGetGrid(320, 240, false);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(MeshGetGrid(320, 240, false));
+    }
+}
+BENCHMARK(BM_MeshGetGridCached);
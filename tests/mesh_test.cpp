@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <functional>
+#include <map>
+#include "pch.h"
+#include "mesh.h"
+
+
+// Row by row triangle order the grids were built in before, for comparing the cache efficiency.
+static void CreateRowOrderGrid(Mesh<VertexFormatBasic>& mesh, int width, int height)
+{
+    MeshCreateGrid(mesh, width, height);
+    mesh.triangles.clear();
+
+    for (int y = 0; y < height - 1; y++)
+    {
+        for (int x = 0; x < width - 1; x++)
+        {
+            uint32_t index = y * width + x;
+            mesh.triangles.emplace_back(index, index + 1, index + width + 1);
+            mesh.triangles.emplace_back(index, index + width + 1, index + width);
+        }
+    }
+}
+
+static bool TriangleEquals(const MeshTriangle& a, const MeshTriangle& b)
+{
+    return a.a == b.a && a.b == b.b && a.c == b.c;
+}
+
+// Two channel disparity and confidence map of one eye, in 16-bit fixed point with 4 fractional bits.
+static std::vector<int16_t> CreateDisparityMap(int width, int height, const std::function<float(int, int)>& disparityFunc)
+{
+    std::vector<int16_t> disparity(width * height * 2, 0);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            disparity[(y * width + x) * 2] = (int16_t)lroundf(disparityFunc(x, y) * 16.0f);
+        }
+    }
+    return disparity;
+}
+
+// Checks that the triangles cover the grid area exactly once, with consistent winding and no T-junctions.
+static void ExpectCoversGrid(const Mesh<VertexFormatBasic>& mesh, int width, int height)
+{
+    double area = 0.0;
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+
+    for (const MeshTriangle& triangle : mesh.triangles)
+    {
+        const float* a = mesh.vertices[triangle.a].position;
+        const float* b = mesh.vertices[triangle.b].position;
+        const float* c = mesh.vertices[triangle.c].position;
+
+        double signedArea = 0.5 * ((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]));
+        ASSERT_GT(signedArea, 0.0);
+        area += signedArea;
+
+        edges[{ triangle.a, triangle.b }]++;
+        edges[{ triangle.b, triangle.c }]++;
+        edges[{ triangle.c, triangle.a }]++;
+    }
+
+    EXPECT_NEAR(area, (double)(width - 1) * (height - 1) / ((double)width * height), 1e-4);
+
+    // Inner edges are shared with a neighbor in the opposite direction, only edges on the outside of the grid are not.
+    auto isOnGridEdge = [&](uint32_t index)
+    {
+        int x = (int)lroundf(mesh.vertices[index].position[0] * width);
+        int y = (int)lroundf(mesh.vertices[index].position[1] * height);
+        return x == 0 || y == 0 || x == width - 1 || y == height - 1;
+    };
+
+    for (const auto& [edge, count] : edges)
+    {
+        ASSERT_EQ(count, 1);
+        if (!edges.contains({ edge.second, edge.first }))
+        {
+            ASSERT_TRUE(isOnGridEdge(edge.first) && isOnGridEdge(edge.second));
+        }
+    }
+}
+
+
+TEST(Mesh, GridCoversEveryCellOnce)
+{
+    for (bool bHexagon : { false, true })
+    {
+        Mesh<VertexFormatBasic> mesh;
+        bHexagon ? MeshCreateHexGrid(mesh, 37, 23) : MeshCreateGrid(mesh, 37, 23);
+
+        ASSERT_EQ(mesh.vertices.size(), 37u * 23u);
+        ASSERT_EQ(mesh.triangles.size(), 36u * 22u * 2u);
+
+        // Every cell is split into two triangles, the cell is at the lowest column and row of the triangle vertices.
+        std::vector<int> cellTriangles(36 * 22, 0);
+        for (const MeshTriangle& triangle : mesh.triangles)
+        {
+            uint32_t x = std::min({ triangle.a % 37, triangle.b % 37, triangle.c % 37 });
+            uint32_t y = std::min({ triangle.a / 37, triangle.b / 37, triangle.c / 37 });
+
+            ASSERT_LT(x, 36u);
+            ASSERT_LT(y, 22u);
+            ASSERT_LT(triangle.a, mesh.vertices.size());
+            ASSERT_LT(triangle.b, mesh.vertices.size());
+            ASSERT_LT(triangle.c, mesh.vertices.size());
+
+            cellTriangles[y * 36 + x]++;
+        }
+
+        for (int count : cellTriangles)
+        {
+            EXPECT_EQ(count, 2);
+        }
+    }
+}
+
+TEST(Mesh, GridOrderImprovesCacheStats)
+{
+    Mesh<VertexFormatBasic> rowOrder, stripOrder;
+    CreateRowOrderGrid(rowOrder, 160, 120);
+    MeshCreateGrid(stripOrder, 160, 120);
+
+    MeshCacheStats rowStats = MeshCalculateCacheStats(rowOrder, MESH_VERTEX_CACHE_SIZE);
+    MeshCacheStats stripStats = MeshCalculateCacheStats(stripOrder, MESH_VERTEX_CACHE_SIZE);
+
+    EXPECT_GT(rowStats.acmr, 0.95f);
+    EXPECT_LT(stripStats.acmr, 0.6f);
+    EXPECT_LT(stripStats.atvr, 1.15f);
+}
+
+TEST(Mesh, CacheStatsOfIsolatedTriangles)
+{
+    Mesh<VertexFormatBasic> mesh;
+    mesh.vertices.resize(6);
+    mesh.triangles.emplace_back(0, 1, 2);
+    mesh.triangles.emplace_back(3, 4, 5);
+
+    MeshCacheStats stats = MeshCalculateCacheStats(mesh, MESH_VERTEX_CACHE_SIZE);
+    EXPECT_FLOAT_EQ(stats.acmr, 3.0f);
+    EXPECT_FLOAT_EQ(stats.atvr, 1.0f);
+}
+
+TEST(Mesh, GetGridUses16BitIndicesWhenPossible)
+{
+    std::shared_ptr<const GridMesh> small = MeshGetGrid(160, 120, false);
+    ASSERT_TRUE(small);
+    EXPECT_TRUE(small->Uses16BitIndices());
+    EXPECT_EQ(small->GetIndexDataSize(), small->numIndices * sizeof(uint16_t));
+
+    std::shared_ptr<const GridMesh> large = MeshGetGrid(320, 240, false);
+    ASSERT_TRUE(large);
+    EXPECT_FALSE(large->Uses16BitIndices());
+    EXPECT_EQ(large->GetIndexDataSize(), large->numIndices * sizeof(uint32_t));
+
+    // The packed indices keep the builder triangle order.
+    Mesh<VertexFormatBasic> mesh;
+    MeshCreateGrid(mesh, 160, 120);
+    ASSERT_EQ(small->numIndices, mesh.triangles.size() * 3);
+    for (size_t i = 0; i < mesh.triangles.size(); i++)
+    {
+        MeshTriangle packed(small->indices16[i * 3], small->indices16[i * 3 + 1], small->indices16[i * 3 + 2]);
+        ASSERT_TRUE(TriangleEquals(packed, mesh.triangles[i]));
+    }
+}
+
+TEST(Mesh, GetGridIsMemoized)
+{
+    std::shared_ptr<const GridMesh> square = MeshGetGrid(64, 48, false);
+    std::shared_ptr<const GridMesh> hexagon = MeshGetGrid(64, 48, true);
+
+    EXPECT_NE(square, hexagon);
+    EXPECT_EQ(square, MeshGetGrid(64, 48, false));
+    EXPECT_EQ(hexagon, MeshGetGrid(64, 48, true));
+    EXPECT_NE(square, MeshGetGrid(48, 64, false));
+}
+
+TEST(Mesh, AdaptiveGridSimplifiesPlanes)
+{
+    const int width = 80;
+    const int height = 60;
+    std::vector<int16_t> disparity = CreateDisparityMap(width, height, [](int x, int y) { return 20.0f + 0.1f * x + 0.05f * y; });
+
+    Mesh<VertexFormatBasic> mesh;
+    MeshSimplificationStats stats;
+    MeshCreateAdaptiveGrid(mesh, disparity.data(), width * 2, width, height, false, 0.5f, stats);
+
+    ExpectCoversGrid(mesh, width, height);
+    EXPECT_EQ(stats.numVertices, mesh.vertices.size());
+    EXPECT_EQ(stats.numTriangles, mesh.triangles.size());
+    EXPECT_LE(stats.maxError, 0.5f);
+
+    // Only the border ramp needs full detail.
+    EXPECT_LT(mesh.vertices.size(), width * height / 2u);
+}
+
+TEST(Mesh, AdaptiveGridSplitsAtDepthEdges)
+{
+    const int width = 80;
+    const int height = 60;
+    std::vector<int16_t> plane = CreateDisparityMap(width, height, [](int, int) { return 20.0f; });
+
+    // A step in disparity, and a patch of invalid disparities.
+    std::vector<int16_t> edges = CreateDisparityMap(width, height, [](int x, int y)
+    {
+        if (x >= 50 && y >= 10 && y < 30)
+        {
+            return 0.0f;
+        }
+        return x < 37 ? 20.0f : 40.0f;
+    });
+
+    Mesh<VertexFormatBasic> planeMesh, edgesMesh;
+    MeshSimplificationStats planeStats, edgesStats;
+    MeshCreateAdaptiveGrid(planeMesh, plane.data(), width * 2, width, height, false, 1.0f, planeStats);
+    MeshCreateAdaptiveGrid(edgesMesh, edges.data(), width * 2, width, height, false, 1.0f, edgesStats);
+
+    ExpectCoversGrid(edgesMesh, width, height);
+    EXPECT_LE(edgesStats.maxError, 1.0f);
+    EXPECT_GT(edgesMesh.vertices.size(), planeMesh.vertices.size());
+
+    // The right eye has negative disparities and builds the same mesh.
+    std::vector<int16_t> negatedEdges(edges.size());
+    std::transform(edges.begin(), edges.end(), negatedEdges.begin(), [](int16_t value) { return (int16_t)-value; });
+
+    Mesh<VertexFormatBasic> negatedMesh;
+    MeshSimplificationStats negatedStats;
+    MeshCreateAdaptiveGrid(negatedMesh, negatedEdges.data(), width * 2, width, height, true, 1.0f, negatedStats);
+
+    ASSERT_EQ(negatedMesh.triangles.size(), edgesMesh.triangles.size());
+    for (size_t i = 0; i < edgesMesh.triangles.size(); i++)
+    {
+        ASSERT_TRUE(TriangleEquals(negatedMesh.triangles[i], edgesMesh.triangles[i]));
+    }
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "metrics.h"
+#include "profiled_mutex.h"
+
+
+// Returns the bucket each of the durations was counted in.
+static std::vector<uint32_t> RecordAndFindBuckets(MetricTimer& timer, const std::vector<uint64_t>& durationsNs)
+{
+    std::vector<uint32_t> buckets;
+    for (uint64_t duration : durationsNs)
+    {
+        MetricTimerStats before, after;
+        timer.Read(before);
+        timer.Record(duration);
+        timer.Read(after);
+
+        for (uint32_t bucket = 0; bucket < METRICS_NUM_TIMER_BUCKETS; bucket++)
+        {
+            if (after.buckets[bucket] != before.buckets[bucket])
+            {
+                buckets.push_back(bucket);
+            }
+        }
+    }
+    return buckets;
+}
+
+
+TEST(MetricTimer, DefaultBucketsStartAtQuarterMillisecond)
+{
+    MetricTimer timer("TestDefaultBuckets");
+
+    EXPECT_EQ(timer.GetBucketUpperBoundNs(0), 1ull << 18);
+    EXPECT_EQ(timer.GetBucketUpperBoundNs(1), 1ull << 19);
+    EXPECT_EQ(timer.GetBucketUpperBoundNs(METRICS_NUM_TIMER_BUCKETS - 1), UINT64_MAX);
+
+    // Everything from a few microseconds up to a quarter millisecond lands in the first bucket.
+    EXPECT_EQ(RecordAndFindBuckets(timer, { 0, 2000, (1ull << 18) - 1, 1ull << 18, 1ull << 19, 1ull << 40 }),
+        std::vector<uint32_t>({ 0, 0, 0, 1, 2, METRICS_NUM_TIMER_BUCKETS - 1 }));
+
+    MetricTimerStats stats;
+    timer.Read(stats);
+    EXPECT_EQ(stats.count, 6u);
+    EXPECT_EQ(stats.maxNs, 1ull << 40);
+}
+
+TEST(MetricTimer, BucketShiftMovesTheBounds)
+{
+    MetricTimer timer("TestShiftedBuckets", 10);
+
+    EXPECT_EQ(timer.GetBucketUpperBoundNs(0), 1ull << 10);
+    EXPECT_EQ(timer.GetBucketUpperBoundNs(METRICS_NUM_TIMER_BUCKETS - 2), 1ull << (10 + METRICS_NUM_TIMER_BUCKETS - 2));
+
+    EXPECT_EQ(RecordAndFindBuckets(timer, { 500, 1023, 1024, 2047, 2048, 5000, 100000, 1ull << 30 }),
+        std::vector<uint32_t>({ 0, 0, 1, 1, 2, 3, 7, METRICS_NUM_TIMER_BUCKETS - 1 }));
+}
+
+TEST(LockProfile, TimersResolveMicroseconds)
+{
+    LockProfile profile("TestLockProfileBuckets");
+
+    // Waits of under a microsecond, a few microseconds and tens of microseconds are told apart.
+    EXPECT_EQ(RecordAndFindBuckets(profile.waitTimer, { 800, 3000, 40000 }), std::vector<uint32_t>({ 0, 2, 6 }));
+    EXPECT_EQ(RecordAndFindBuckets(profile.holdTimer, { 800, 3000, 40000 }), std::vector<uint32_t>({ 0, 2, 6 }));
+
+    // The last bounded bucket ends where the first bucket of the default timers does.
+    EXPECT_EQ(profile.waitTimer.GetBucketUpperBoundNs(METRICS_NUM_TIMER_BUCKETS - 2), 1ull << METRICS_TIMER_BUCKET_SHIFT);
+}
+
+TEST(LockProfile, ContendedAcquisitionsRecordTheWait)
+{
+    LockProfile profile("TestLockProfileAcquire");
+    std::mutex mutex;
+
+    profile.Acquire([&] { return mutex.try_lock(); }, [&] { mutex.lock(); });
+    mutex.unlock();
+    EXPECT_EQ(profile.acquisitions.Read(), 1u);
+    EXPECT_EQ(profile.contentions.Read(), 0u);
+
+    // A try-lock that fails makes the acquisition count as contended.
+    profile.Acquire([] { return false; }, [&] { mutex.lock(); });
+    mutex.unlock();
+    EXPECT_EQ(profile.acquisitions.Read(), 2u);
+    EXPECT_EQ(profile.contentions.Read(), 1u);
+
+    MetricTimerStats stats;
+    profile.waitTimer.Read(stats);
+    EXPECT_EQ(stats.count, 1u);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "perf_timeline.h"
+
+
+TEST(PerfTimeline, ReadReturnsSamplesInWindowOldestFirst)
+{
+    auto ring = std::make_unique<PerfTimelineRing>();
+    uint64_t now = 10000000000ULL;
+
+    ring->Record(now - 3000000, 1000000, false);
+    ring->Record(now - 2000000, 2000000, true);
+    ring->Record(now - 1000000, 3000000, false);
+
+    std::vector<PerfTimelineSample> samples;
+    ring->Read(samples, now, 2500000);
+
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[0].timeNs, now - 2000000);
+    EXPECT_FLOAT_EQ(samples[0].durationMS, 2.0f);
+    EXPECT_TRUE(samples[0].bFlagged);
+    EXPECT_EQ(samples[1].timeNs, now - 1000000);
+    EXPECT_FLOAT_EQ(samples[1].durationMS, 3.0f);
+    EXPECT_FALSE(samples[1].bFlagged);
+
+    EXPECT_FLOAT_EQ(ring->GetLatestDurationMS(), 3.0f);
+}
+
+TEST(PerfTimeline, RingKeepsTheNewestSamples)
+{
+    auto ring = std::make_unique<PerfTimelineRing>();
+    uint64_t now = 10000000000ULL;
+    uint32_t numRecorded = PERF_TIMELINE_CAPACITY + 100;
+
+    for (uint32_t i = 0; i < numRecorded; i++)
+    {
+        ring->Record(now - (numRecorded - i) * 1000000ULL, i * 1000ULL, false);
+    }
+
+    std::vector<PerfTimelineSample> samples;
+    ring->Read(samples, now, UINT64_MAX / 2);
+
+    ASSERT_EQ(samples.size(), (size_t)PERF_TIMELINE_CAPACITY);
+    EXPECT_FLOAT_EQ(samples.front().durationMS, 100 / 1000.0f);
+    EXPECT_FLOAT_EQ(samples.back().durationMS, (numRecorded - 1) / 1000.0f);
+}
+
+TEST(PerfTimeline, PercentilesUseNearestRank)
+{
+    uint64_t now = 10000000000ULL;
+    std::vector<PerfTimelineSample> samples;
+
+    for (int i = 1; i <= 100; i++)
+    {
+        samples.push_back({ now - (101 - i) * 1000000ULL, (float)i, false });
+    }
+
+    // Outside the window.
+    samples.insert(samples.begin(), { now - 500000000ULL, 1000.0f, false });
+
+    PerfTimelinePercentiles percentiles = PerfTimelineGetPercentiles(samples, now, 200000000ULL);
+
+    EXPECT_EQ(percentiles.numSamples, 100u);
+    EXPECT_FLOAT_EQ(percentiles.p50MS, 50.0f);
+    EXPECT_FLOAT_EQ(percentiles.p90MS, 90.0f);
+    EXPECT_FLOAT_EQ(percentiles.p99MS, 99.0f);
+    EXPECT_FLOAT_EQ(percentiles.maxMS, 100.0f);
+}
+
+TEST(PerfTimeline, PercentilesOfNoSamples)
+{
+    std::vector<PerfTimelineSample> samples;
+    PerfTimelinePercentiles percentiles = PerfTimelineGetPercentiles(samples, 1000, 1000);
+
+    EXPECT_EQ(percentiles.numSamples, 0u);
+    EXPECT_FLOAT_EQ(percentiles.maxMS, 0.0f);
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "room_geometry_cache.h"
+
+
+static const int TestWidth = 64;
+static const int TestHeight = 64;
+static const float TestVoxelSize = 0.1f;
+static const int TestMaxDisparity = 256;
+
+// Q matrix in the stereoRectify layout, with the principal point at the origin.
+// A disparity of 64 pixels is 3.125 m away, where the integration step of 4 pixels is more than a voxel apart.
+static XrMatrix4x4f CreateDisparityToDepth()
+{
+    XrMatrix4x4f disparityToDepth{};
+    disparityToDepth.m[0] = 1.0f;
+    disparityToDepth.m[5] = 1.0f;
+    disparityToDepth.m[11] = 0.5f;
+    disparityToDepth.m[14] = 100.0f;
+    return disparityToDepth;
+}
+
+// Disparity map of one eye with interleaved confidence, in 16-bit fixed point with 4 fractional bits.
+static std::vector<int16_t> CreateDisparityMap(float disparity, int16_t confidence = INT16_MAX)
+{
+    std::vector<int16_t> map(TestWidth * TestHeight * 2);
+    for (size_t i = 0; i < map.size(); i += 2)
+    {
+        map[i] = (int16_t)(disparity * 16.0f);
+        map[i + 1] = confidence;
+    }
+    return map;
+}
+
+class RoomGeometryCacheTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        XrMatrix4x4f_CreateIdentity(&m_viewToWorld);
+        m_cache.Reset(TestVoxelSize);
+    }
+
+    void Predict(RoomCachePrediction& prediction, bool bNegativeDisparity = false)
+    {
+        m_cache.Predict(prediction, m_viewToWorld, m_disparityToDepth, 1.0f, TestWidth, TestHeight, bNegativeDisparity);
+    }
+
+    void Integrate(const RoomCachePrediction& prediction, const std::vector<int16_t>& map, const std::vector<uint8_t>& matchedBands = { 1, 1 }, bool bUseConfidence = false)
+    {
+        m_cache.Integrate(prediction, matchedBands, map.data(), TestWidth * 2, m_disparityToDepth, 1.0f, TestMaxDisparity, bUseConfidence);
+        m_cache.EndFrame();
+    }
+
+    // Number of pixels in the rows of the prediction predicted with the given disparity.
+    // The last splats reach two pixels past the last integrated row and column, at 60.
+    static int CountPredicted(const RoomCachePrediction& prediction, int16_t value, int startRow = 0, int endRow = 63)
+    {
+        int count = 0;
+        for (int y = startRow; y < endRow; y++)
+        {
+            for (int x = 0; x < 63; x++)
+            {
+                count += prediction.disparity[y * prediction.width + x] == value ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    RoomGeometryCache m_cache;
+    XrMatrix4x4f m_viewToWorld;
+    XrMatrix4x4f m_disparityToDepth = CreateDisparityToDepth();
+};
+
+
+TEST_F(RoomGeometryCacheTest, StableVoxelsArePredicted)
+{
+    RoomCachePrediction prediction;
+    Predict(prediction);
+    ASSERT_EQ(prediction.NumBands(), 2);
+    EXPECT_EQ(CountPredicted(prediction, 0), 63 * 63);
+
+    std::vector<int16_t> map = CreateDisparityMap(64.0f);
+
+    // Voxels need to be seen in several frames before they are predicted.
+    for (int frame = 0; frame < ROOM_CACHE_STABLE_WEIGHT - 1; frame++)
+    {
+        Integrate(prediction, map);
+    }
+
+    RoomCachePrediction unstablePrediction;
+    Predict(unstablePrediction);
+    EXPECT_EQ(CountPredicted(unstablePrediction, 0), 63 * 63);
+
+    Integrate(prediction, map);
+    Predict(prediction);
+    EXPECT_EQ(CountPredicted(prediction, 64 * 16), 63 * 63);
+
+    // Every sampled point got its own voxel, and seeing it again doesn't add any.
+    EXPECT_EQ(m_cache.GetNumVoxels(), 16u * 16u);
+    EXPECT_GT(m_cache.GetMemoryUsage(), 0u);
+}
+
+TEST_F(RoomGeometryCacheTest, RightEyeUsesNegativeDisparities)
+{
+    RoomCachePrediction prediction;
+    Predict(prediction, true);
+
+    std::vector<int16_t> map = CreateDisparityMap(-64.0f);
+    for (int frame = 0; frame < ROOM_CACHE_STABLE_WEIGHT; frame++)
+    {
+        Integrate(prediction, map);
+    }
+
+    Predict(prediction, true);
+    EXPECT_EQ(CountPredicted(prediction, -64 * 16), 63 * 63);
+    EXPECT_EQ(m_cache.GetNumVoxels(), 16u * 16u);
+}
+
+TEST_F(RoomGeometryCacheTest, InvalidDisparitiesAreSkipped)
+{
+    RoomCachePrediction prediction;
+    Predict(prediction);
+
+    Integrate(prediction, CreateDisparityMap(0.0f));
+    Integrate(prediction, CreateDisparityMap((float)TestMaxDisparity));
+    Integrate(prediction, CreateDisparityMap(64.0f, 0), { 1, 1 }, true);
+    EXPECT_EQ(m_cache.GetNumVoxels(), 0u);
+
+    // Bands that weren't matched aren't integrated.
+    Integrate(prediction, CreateDisparityMap(64.0f), { 0, 0 });
+    EXPECT_EQ(m_cache.GetNumVoxels(), 0u);
+
+    std::vector<int16_t> map = CreateDisparityMap(0.0f);
+    map[(8 * TestWidth + 8) * 2] = 64 * 16;
+    Integrate(prediction, map);
+    Integrate(prediction, map);
+    EXPECT_EQ(m_cache.GetNumVoxels(), 1u);
+}
+
+TEST_F(RoomGeometryCacheTest, SeeingPastVoxelsCarvesThem)
+{
+    RoomCachePrediction prediction;
+    Predict(prediction);
+
+    std::vector<int16_t> nearMap = CreateDisparityMap(64.0f);
+    for (int frame = 0; frame < ROOM_CACHE_STABLE_WEIGHT; frame++)
+    {
+        Integrate(prediction, nearMap);
+    }
+    Predict(prediction);
+
+    // The surface has moved away in the top band only.
+    Integrate(prediction, CreateDisparityMap(32.0f), { 1, 0 });
+
+    // The splats of the first row of the bottom band reach two rows up.
+    RoomCachePrediction carvedPrediction;
+    Predict(carvedPrediction);
+    EXPECT_EQ(CountPredicted(carvedPrediction, 64 * 16, 0, ROOM_CACHE_TILE_SIZE - 2), 0);
+    EXPECT_EQ(CountPredicted(carvedPrediction, 64 * 16, ROOM_CACHE_TILE_SIZE - 2), (63 - ROOM_CACHE_TILE_SIZE + 2) * 63);
+
+    // The farther surface was added in its place.
+    EXPECT_EQ(m_cache.GetNumVoxels(), 16u * 16u + 16u * 8u);
+}
+
+TEST_F(RoomGeometryCacheTest, PruneDropsOldUnstableVoxels)
+{
+    RoomCachePrediction prediction;
+    Predict(prediction);
+
+    std::vector<int16_t> nearMap = CreateDisparityMap(64.0f);
+    for (int frame = 0; frame < ROOM_CACHE_STABLE_WEIGHT; frame++)
+    {
+        Integrate(prediction, nearMap);
+    }
+    Integrate(prediction, CreateDisparityMap(32.0f));
+    EXPECT_EQ(m_cache.GetNumVoxels(), 2u * 16u * 16u);
+
+    for (int frame = 0; frame < ROOM_CACHE_PRUNE_AGE + ROOM_CACHE_PRUNE_INTERVAL; frame++)
+    {
+        m_cache.EndFrame();
+    }
+
+    // Stable voxels are only pruned when the cache is over its size limit.
+    EXPECT_EQ(m_cache.GetNumVoxels(), 16u * 16u);
+
+    Predict(prediction);
+    EXPECT_EQ(CountPredicted(prediction, 64 * 16), 63 * 63);
+}
+
+TEST_F(RoomGeometryCacheTest, ClassifyBandsChecksCoverageAndPhotometry)
+{
+    const int disparity = 10;
+    const int extOffset = 16;
+
+    RoomCachePrediction prediction;
+    prediction.width = TestWidth;
+    prediction.height = TestHeight;
+    prediction.disparity.assign(TestWidth * TestHeight, disparity * 16);
+    prediction.bandCached.assign(2, 0);
+    prediction.bandCachedFrames.assign(2, 0);
+
+    // The matching pixel of the other image is the disparity to the left.
+    cv::Mat image(TestHeight, TestWidth + extOffset, CV_8UC1);
+    cv::Mat otherImage(TestHeight, TestWidth + extOffset, CV_8UC1);
+    cv::Mat movedImage(TestHeight, TestWidth + extOffset, CV_8UC1);
+
+    for (int y = 0; y < image.rows; y++)
+    {
+        for (int x = 0; x < image.cols; x++)
+        {
+            image.at<uint8_t>(y, x) = (uint8_t)((x * 37 + y * 11) % 251);
+            otherImage.at<uint8_t>(y, x) = (uint8_t)(((x + disparity) * 37 + y * 11) % 251);
+            movedImage.at<uint8_t>(y, x) = (uint8_t)(((x + disparity + 3) * 37 + y * 11) % 251);
+        }
+    }
+
+    EXPECT_EQ(m_cache.ClassifyBands(prediction, image, otherImage, extOffset), 2);
+    EXPECT_EQ(prediction.bandCached, std::vector<uint8_t>({ 1, 1 }));
+
+    EXPECT_EQ(m_cache.ClassifyBands(prediction, image, movedImage, extOffset), 0);
+    EXPECT_EQ(prediction.bandCachedFrames, std::vector<uint32_t>({ 0, 0 }));
+
+    // Holes in the prediction of the second band.
+    for (int y = ROOM_CACHE_TILE_SIZE; y < ROOM_CACHE_TILE_SIZE + 8; y++)
+    {
+        std::fill_n(prediction.disparity.begin() + y * TestWidth, TestWidth, (int16_t)0);
+    }
+
+    EXPECT_EQ(m_cache.ClassifyBands(prediction, image, otherImage, extOffset), 1);
+    EXPECT_EQ(prediction.bandCached, std::vector<uint8_t>({ 1, 0 }));
+
+    // Cached bands are matched again after a while, even if nothing has changed.
+    for (int frame = 1; frame < ROOM_CACHE_MAX_CACHED_FRAMES; frame++)
+    {
+        ASSERT_EQ(m_cache.ClassifyBands(prediction, image, otherImage, extOffset), 1);
+    }
+    EXPECT_EQ(m_cache.ClassifyBands(prediction, image, otherImage, extOffset), 0);
+    EXPECT_EQ(m_cache.ClassifyBands(prediction, image, otherImage, extOffset), 1);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "snapshot_publisher.h"
+
+
+struct TestSnapshot
+{
+    uint64_t Generation = 0;
+    int First = 0;
+    int Second = 0;
+
+    bool operator==(const TestSnapshot&) const = default;
+};
+
+static TestSnapshot CreateSnapshot(int first, int second)
+{
+    TestSnapshot snapshot;
+    snapshot.First = first;
+    snapshot.Second = second;
+    return snapshot;
+}
+
+
+TEST(SnapshotPublisher, OnlyChangesArePublished)
+{
+    SnapshotPublisher<TestSnapshot> publisher;
+    EXPECT_EQ(publisher.Get(), nullptr);
+    EXPECT_EQ(publisher.GetGeneration(), 0u);
+
+    EXPECT_TRUE(publisher.Publish(CreateSnapshot(1, 2)));
+    ASSERT_NE(publisher.Get(), nullptr);
+    EXPECT_EQ(publisher.Get()->Generation, 1u);
+    EXPECT_EQ(publisher.GetGeneration(), 1u);
+
+    // The generation of the published value is ignored when comparing.
+    TestSnapshot unchanged = CreateSnapshot(1, 2);
+    unchanged.Generation = 7;
+    EXPECT_FALSE(publisher.Publish(unchanged));
+    EXPECT_EQ(publisher.GetGeneration(), 1u);
+
+    EXPECT_TRUE(publisher.Publish(CreateSnapshot(1, 3)));
+    EXPECT_EQ(publisher.Get()->Generation, 2u);
+    EXPECT_EQ(publisher.Get()->Second, 3);
+}
+
+TEST(SnapshotPublisher, HeldSnapshotsAreNotModified)
+{
+    SnapshotPublisher<TestSnapshot> publisher;
+    publisher.Publish(CreateSnapshot(1, 2));
+
+    std::shared_ptr<const TestSnapshot> held = publisher.Get();
+    publisher.Publish(CreateSnapshot(3, 4));
+
+    EXPECT_EQ(held->Generation, 1u);
+    EXPECT_EQ(held->First, 1);
+    EXPECT_EQ(held->Second, 2);
+    EXPECT_NE(publisher.Get(), held);
+}
+
+TEST(SnapshotPublisher, WaitReturnsOnPublishOrWake)
+{
+    SnapshotPublisher<TestSnapshot> publisher;
+    std::atomic_bool bKeepWaiting = true;
+
+    EXPECT_FALSE(publisher.WaitForChange(0, bKeepWaiting, 10ms));
+
+    std::thread writer([&]
+    {
+        std::this_thread::sleep_for(10ms);
+        publisher.Publish(CreateSnapshot(1, 1));
+    });
+    publisher.WaitForChange(0, bKeepWaiting);
+    EXPECT_EQ(publisher.GetGeneration(), 1u);
+    writer.join();
+
+    // Already published generations don't block.
+    EXPECT_TRUE(publisher.WaitForChange(0, bKeepWaiting, 10s));
+
+    std::thread stopper([&]
+    {
+        std::this_thread::sleep_for(10ms);
+        bKeepWaiting = false;
+        publisher.WakeWaiters();
+    });
+    publisher.WaitForChange(1, bKeepWaiting);
+    EXPECT_EQ(publisher.GetGeneration(), 1u);
+    stopper.join();
+}
+
+TEST(SnapshotPublisher, ReadersSeeConsistentSnapshots)
+{
+    SnapshotPublisher<TestSnapshot> publisher;
+    publisher.Publish(CreateSnapshot(1, 1));
+
+    const int numPublishes = 20000;
+    std::atomic_bool bRunning = true;
+    std::atomic_uint32_t numErrors = 0;
+
+    // Both values are written with the generation, so a torn or modified snapshot shows up as a mismatch.
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back([&]
+        {
+            uint64_t lastGeneration = 0;
+            while (bRunning)
+            {
+                uint64_t generation = publisher.GetGeneration();
+                std::shared_ptr<const TestSnapshot> snapshot = publisher.Get();
+
+                if (snapshot->First != (int)snapshot->Generation ||
+                    snapshot->Second != (int)snapshot->Generation ||
+                    snapshot->Generation < generation ||
+                    snapshot->Generation < lastGeneration)
+                {
+                    numErrors++;
+                }
+                lastGeneration = snapshot->Generation;
+            }
+        });
+    }
+
+    for (int i = 2; i <= numPublishes; i++)
+    {
+        publisher.Publish(CreateSnapshot(i, i));
+    }
+
+    bRunning = false;
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(numErrors, 0u);
+    EXPECT_EQ(publisher.GetGeneration(), (uint64_t)numPublishes);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "pch.h"
+#include "staging_ring.h"
+
+
+// Stands in for the GPU fence. Submissions finish in order, when Complete() is called.
+struct FakeFence
+{
+    uint64_t submittedValue = 0;
+    uint64_t completedValue = 0;
+
+    uint64_t Signal() { return ++submittedValue; }
+    void Complete(uint64_t value) { completedValue = std::max(completedValue, std::min(value, submittedValue)); }
+};
+
+// Allocates like the renderers do, waiting on the fake fence for the oldest frame while the ring is full.
+static bool AllocateOrWait(StagingRing& ring, FakeFence& fence, size_t size, size_t alignment, size_t& offset, uint32_t& numStalls)
+{
+    while (!ring.Allocate(size, alignment, offset))
+    {
+        uint64_t oldestFenceValue = ring.GetOldestFenceValue();
+        if (oldestFenceValue == 0)
+        {
+            return false;
+        }
+
+        numStalls++;
+        fence.Complete(oldestFenceValue);
+        ring.Retire(fence.completedValue);
+    }
+    return true;
+}
+
+
+TEST(StagingRing, AllocationsAreAlignedAndDoNotOverlap)
+{
+    StagingRing ring;
+    ring.Reset(1024);
+
+    size_t first, second;
+    ASSERT_TRUE(ring.Allocate(100, 64, first));
+    ASSERT_TRUE(ring.Allocate(100, 64, second));
+
+    EXPECT_EQ(first, 0u);
+    EXPECT_EQ(second % 64, 0u);
+    EXPECT_GE(second, first + 100);
+    EXPECT_EQ(ring.GetUsedSize(), second + 100);
+}
+
+TEST(StagingRing, MemoryIsReusedOnlyAfterFenceCompletes)
+{
+    StagingRing ring;
+    FakeFence fence;
+    ring.Reset(1000);
+
+    size_t offset;
+    ASSERT_TRUE(ring.Allocate(600, 1, offset));
+    ring.EndFrame(fence.Signal());
+
+    // The GPU hasn't finished the first frame, so there's no room for another one.
+    EXPECT_FALSE(ring.Allocate(600, 1, offset));
+    EXPECT_EQ(ring.GetOldestFenceValue(), 1u);
+
+    ring.Retire(fence.completedValue);
+    EXPECT_FALSE(ring.Allocate(600, 1, offset));
+
+    fence.Complete(1);
+    ring.Retire(fence.completedValue);
+    EXPECT_EQ(ring.GetUsedSize(), 0u);
+    EXPECT_EQ(ring.GetOldestFenceValue(), 0u);
+
+    ASSERT_TRUE(ring.Allocate(600, 1, offset));
+    EXPECT_EQ(offset, 0u);
+}
+
+TEST(StagingRing, WrapsAroundPastTheEnd)
+{
+    StagingRing ring;
+    FakeFence fence;
+    ring.Reset(1000);
+
+    size_t offset;
+    ASSERT_TRUE(ring.Allocate(400, 1, offset));
+    ring.EndFrame(fence.Signal());
+    ASSERT_TRUE(ring.Allocate(400, 1, offset));
+    EXPECT_EQ(offset, 400u);
+    ring.EndFrame(fence.Signal());
+
+    fence.Complete(1);
+    ring.Retire(fence.completedValue);
+
+    // 200 bytes are left at the end, so the next allocation wraps to the start and the skipped end counts as used.
+    ASSERT_TRUE(ring.Allocate(300, 1, offset));
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(ring.GetUsedSize(), 400u + 200u + 300u);
+    ring.EndFrame(fence.Signal());
+
+    // Retiring the frame that wrapped around also frees the skipped space.
+    fence.Complete(3);
+    ring.Retire(fence.completedValue);
+    EXPECT_EQ(ring.GetUsedSize(), 0u);
+}
+
+TEST(StagingRing, FailsWhenCurrentFrameFillsTheRing)
+{
+    StagingRing ring;
+    ring.Reset(1000);
+
+    size_t offset;
+    EXPECT_FALSE(ring.Allocate(1001, 1, offset));
+    EXPECT_FALSE(ring.Allocate(0, 1, offset));
+
+    ASSERT_TRUE(ring.Allocate(800, 1, offset));
+    EXPECT_FALSE(ring.Allocate(300, 1, offset));
+
+    // Nothing has been submitted, so there is no frame to wait for.
+    EXPECT_EQ(ring.GetOldestFenceValue(), 0u);
+}
+
+TEST(StagingRing, SimulatedTimelineNeverOverwritesMemoryInFlight)
+{
+    const uint32_t numFrames = 500;
+    const uint32_t gpuLatencyFrames = 2;
+    const size_t capacity = 64 * 1024;
+
+    StagingRing ring;
+    FakeFence fence;
+    ring.Reset(capacity);
+
+    // Bytes of the ring owned by each submitted frame that the GPU may still be reading.
+    struct InFlight
+    {
+        uint64_t fenceValue;
+        size_t offset;
+        size_t size;
+    };
+    std::deque<InFlight> inFlight;
+
+    uint32_t numStalls = 0;
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<size_t> sizeDist(1000, 12000);
+
+    for (uint32_t frame = 0; frame < numFrames; frame++)
+    {
+        // The GPU runs a fixed number of frames behind the CPU.
+        if (fence.submittedValue > gpuLatencyFrames)
+        {
+            fence.Complete(fence.submittedValue - gpuLatencyFrames);
+        }
+        ring.Retire(fence.completedValue);
+
+        while (!inFlight.empty() && inFlight.front().fenceValue <= fence.completedValue)
+        {
+            inFlight.pop_front();
+        }
+
+        std::vector<InFlight> frameAllocations;
+        for (int upload = 0; upload < 2; upload++)
+        {
+            size_t size = sizeDist(random);
+            size_t offset = 0;
+            ASSERT_TRUE(AllocateOrWait(ring, fence, size, 256, offset, numStalls));
+            ASSERT_EQ(offset % 256, 0u);
+            ASSERT_LE(offset + size, capacity);
+
+            while (!inFlight.empty() && inFlight.front().fenceValue <= fence.completedValue)
+            {
+                inFlight.pop_front();
+            }
+
+            for (const InFlight& other : inFlight)
+            {
+                ASSERT_TRUE(offset + size <= other.offset || other.offset + other.size <= offset) << "frame " << frame;
+            }
+            for (const InFlight& other : frameAllocations)
+            {
+                ASSERT_TRUE(offset + size <= other.offset || other.offset + other.size <= offset) << "frame " << frame;
+            }
+
+            frameAllocations.push_back({ 0, offset, size });
+        }
+
+        uint64_t fenceValue = fence.Signal();
+        ring.EndFrame(fenceValue);
+
+        for (InFlight& allocation : frameAllocations)
+        {
+            allocation.fenceValue = fenceValue;
+            inFlight.push_back(allocation);
+        }
+
+        ASSERT_LE(ring.GetUsedSize(), capacity);
+    }
+
+    // Three frames of the largest uploads don't fit, so the ring has to wait for the GPU at times.
+    EXPECT_GT(numStalls, 0u);
+}
+
+TEST(CopyRows, CopiesBetweenPitches)
+{
+    const uint32_t numRows = 3;
+    const size_t rowSize = 5;
+    uint8_t source[numRows * 8];
+    for (size_t i = 0; i < sizeof(source); i++)
+    {
+        source[i] = (uint8_t)i;
+    }
+
+    uint8_t dest[numRows * 16];
+    memset(dest, 0xFF, sizeof(dest));
+    CopyRows(dest, 16, source, 8, rowSize, numRows);
+
+    for (uint32_t row = 0; row < numRows; row++)
+    {
+        for (size_t i = 0; i < 16; i++)
+        {
+            EXPECT_EQ(dest[row * 16 + i], i < rowSize ? source[row * 8 + i] : 0xFF);
+        }
+    }
+
+    uint8_t packed[numRows * rowSize];
+    CopyRows(packed, rowSize, source, rowSize, rowSize, numRows);
+    EXPECT_EQ(memcmp(packed, source, sizeof(packed)), 0);
+}
@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <new>
+#include "allocation_counter.h"
+
+// Replacement allocation functions, all backed by malloc and free. They are kept out of the test
+// sources so the compiler never sees a free() inlined into code that got its pointer from operator new.
+
+static thread_local uint64_t g_numAllocations = 0;
+
+uint64_t GetThreadAllocationCount()
+{
+    return g_numAllocations;
+}
+
+void* operator new(size_t size)
+{
+    g_numAllocations++;
+    if (void* ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
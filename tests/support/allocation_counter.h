@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+// Number of global operator new calls made by the calling thread. Only available in the tests
+// that link support/allocation_counter.cpp, which replaces the global allocation functions.
+uint64_t GetThreadAllocationCount();
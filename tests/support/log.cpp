@@ -0,0 +1,37 @@
+#include "pch.h"
+#include <log.h>
+#include <cstdio>
+
+// Log functions for tests, written straight to stderr.
+
+namespace LAYER_NAMESPACE::log {
+
+    void Log(const char* fmt, ...)
+    {
+        va_list va;
+        va_start(va, fmt);
+        vfprintf(stderr, fmt, va);
+        va_end(va);
+    }
+
+    void DebugLog(const char*, ...)
+    {
+    }
+
+    void ErrorLog(const char* fmt, ...)
+    {
+        va_list va;
+        va_start(va, fmt);
+        vfprintf(stderr, fmt, va);
+        va_end(va);
+    }
+
+    void FlushLog()
+    {
+    }
+
+    void ReadLogBuffer(void (*)(std::deque<std::string>& logBuffer))
+    {
+    }
+
+} // namespace LAYER_NAMESPACE::log
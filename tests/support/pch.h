@@ -0,0 +1,31 @@
+#pragma once
+
+// Stand-in for the layer precompiled header with only the standard library parts, for building code under test.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+#if __has_include(<openxr/openxr.h>)
+#include <openxr/openxr.h>
+#include <xr_linear.h>
+#endif
+
+#if __has_include(<openvr.h>)
+#include <openvr.h>
+#endif
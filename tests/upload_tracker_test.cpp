@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "pch.h"
+#include "upload_tracker.h"
+
+
+// Stands in for the graphics API, counting what the renderer would have copied to the GPU.
+struct NullUploadBackend
+{
+    uint64_t uploadedBytes = 0;
+    uint32_t numUploads = 0;
+    bool bFailUploads = false;
+
+    bool Upload(size_t numBytes)
+    {
+        numUploads++;
+        if (bFailUploads)
+        {
+            return false;
+        }
+        uploadedBytes += numBytes;
+        return true;
+    }
+};
+
+
+TEST(UploadTracker, SkipsDataAlreadyInSlot)
+{
+    UploadTracker tracker;
+    NullUploadBackend backend;
+    const size_t frameSize = 1280 * 960 * 4;
+
+    // Two renders per camera frame, cycling through three slots.
+    for (uint64_t frame = 0; frame < 6; frame++)
+    {
+        for (uint32_t render = 0; render < 2; render++)
+        {
+            uint32_t slot = (uint32_t)((frame * 2 + render) % 3);
+            tracker.Upload(UploadResource_CameraFrame, slot, frame, frameSize, [&]() { return backend.Upload(frameSize); });
+        }
+    }
+
+    EXPECT_EQ(backend.uploadedBytes, tracker.GetUploadedBytes());
+    EXPECT_EQ(backend.numUploads, 12u);
+
+    // Rendering the last frame again into every slot only uploads into the slots not holding it.
+    uint32_t uploadsBefore = backend.numUploads;
+    for (uint32_t slot = 0; slot < 3; slot++)
+    {
+        tracker.Upload(UploadResource_CameraFrame, slot, 5, frameSize, [&]() { return backend.Upload(frameSize); });
+    }
+    EXPECT_EQ(backend.numUploads - uploadsBefore, 1u);
+    EXPECT_EQ(tracker.GetSkippedUploads(), 2u);
+    EXPECT_EQ(backend.uploadedBytes, tracker.GetUploadedBytes());
+}
+
+TEST(UploadTracker, FailedUploadIsRetried)
+{
+    UploadTracker tracker;
+    NullUploadBackend backend;
+
+    tracker.Upload(UploadResource_DisparityMap, 0, 1, 100, [&]() { return backend.Upload(100); });
+    EXPECT_EQ(tracker.GetSlotKey(UploadResource_DisparityMap, 0), 1u);
+
+    backend.bFailUploads = true;
+    EXPECT_FALSE(tracker.Upload(UploadResource_DisparityMap, 0, 2, 100, [&]() { return backend.Upload(100); }));
+    EXPECT_EQ(tracker.GetSlotKey(UploadResource_DisparityMap, 0), UPLOAD_KEY_NONE);
+    EXPECT_EQ(tracker.GetUploadedBytes(), 100u);
+
+    backend.bFailUploads = false;
+    EXPECT_TRUE(tracker.Upload(UploadResource_DisparityMap, 0, 2, 100, [&]() { return backend.Upload(100); }));
+    EXPECT_EQ(tracker.GetSlotKey(UploadResource_DisparityMap, 0), 2u);
+
+    EXPECT_EQ(backend.numUploads, 3u);
+    EXPECT_EQ(backend.uploadedBytes, 200u);
+    EXPECT_EQ(tracker.GetUploadedBytes(), backend.uploadedBytes);
+}
+
+TEST(UploadTracker, InvalidateForcesUpload)
+{
+    UploadTracker tracker;
+    NullUploadBackend backend;
+
+    tracker.Upload(UploadResource_CameraFrame, 0, 7, 64, [&]() { return backend.Upload(64); });
+    tracker.Upload(UploadResource_CameraFrame, 1, 7, 64, [&]() { return backend.Upload(64); });
+
+    tracker.Invalidate(UploadResource_CameraFrame, 0);
+    EXPECT_TRUE(tracker.Upload(UploadResource_CameraFrame, 0, 7, 64, [&]() { return backend.Upload(64); }));
+    EXPECT_FALSE(tracker.Upload(UploadResource_CameraFrame, 1, 7, 64, [&]() { return backend.Upload(64); }));
+
+    tracker.Invalidate(UploadResource_CameraFrame);
+    EXPECT_TRUE(tracker.Upload(UploadResource_CameraFrame, 1, 7, 64, [&]() { return backend.Upload(64); }));
+
+    EXPECT_TRUE(tracker.Upload(UploadResource_CameraFrame, 1, UPLOAD_KEY_NONE, 64, [&]() { return backend.Upload(64); }));
+    EXPECT_TRUE(tracker.Upload(UploadResource_CameraFrame, 1, UPLOAD_KEY_NONE, 64, [&]() { return backend.Upload(64); }));
+
+    EXPECT_EQ(backend.numUploads, 6u);
+    EXPECT_EQ(backend.uploadedBytes, 6u * 64);
+    EXPECT_EQ(tracker.GetUploadedBytes(), backend.uploadedBytes);
+}
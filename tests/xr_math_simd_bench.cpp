@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <xr_math_simd.h>
+
+
+// Per-call cost of the SIMD matrix helpers against the scalar xr_linear.h functions.
+
+static XrMatrix4x4f RandomMatrix(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    XrMatrix4x4f matrix;
+    for (float& value : matrix.m)
+    {
+        value = dist(rng);
+    }
+    return matrix;
+}
+
+
+static void BM_Multiply_Scalar(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(1), b = RandomMatrix(2), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_Multiply(&result, &a, &b);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Multiply_Scalar);
+
+static void BM_Multiply_SIMD(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(1), b = RandomMatrix(2), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_MultiplySIMD(&result, &a, &b);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Multiply_SIMD);
+
+static void BM_InvertRigidBody_Scalar(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(3), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_InvertRigidBody(&result, &a);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_InvertRigidBody_Scalar);
+
+static void BM_InvertRigidBody_SIMD(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(3), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_InvertRigidBodySIMD(&result, &a);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_InvertRigidBody_SIMD);
+
+static void BM_Invert_Scalar(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(4), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_Invert(&result, &a);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Invert_Scalar);
+
+static void BM_Invert_SIMD(benchmark::State& state)
+{
+    XrMatrix4x4f a = RandomMatrix(4), result;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&a);
+        XrMatrix4x4f_InvertSIMD(&result, &a);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Invert_SIMD);
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <xr_math_simd.h>
+
+
+// Checks the SIMD matrix helpers against the scalar xr_linear.h functions they replace.
+
+static XrMatrix4x4f RandomMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    XrMatrix4x4f matrix;
+    for (float& value : matrix.m)
+    {
+        value = dist(rng);
+    }
+    return matrix;
+}
+
+static XrMatrix4x4f RandomRigidBody(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    XrQuaternionf rotation = { dist(rng), dist(rng), dist(rng), dist(rng) };
+    float length = sqrtf(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w);
+    rotation = { rotation.x / length, rotation.y / length, rotation.z / length, rotation.w / length };
+
+    XrVector3f translation = { dist(rng) * 5.0f, dist(rng) * 5.0f, dist(rng) * 5.0f };
+    XrVector3f scale = { 1.0f, 1.0f, 1.0f };
+
+    XrMatrix4x4f matrix;
+    XrMatrix4x4f_CreateTranslationRotationScale(&matrix, &translation, &rotation, &scale);
+    return matrix;
+}
+
+// Perspective projection like the ones built for the HMD and camera views.
+static XrMatrix4x4f RandomProjection(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> tanDist(0.5f, 1.5f);
+    std::uniform_real_distribution<float> offsetDist(-0.2f, 0.2f);
+
+    float tanWidth = tanDist(rng);
+    float tanHeight = tanDist(rng);
+    float nearZ = 0.05f;
+    float farZ = 100.0f;
+
+    XrMatrix4x4f matrix = {};
+    matrix.m[0] = 2.0f / tanWidth;
+    matrix.m[5] = 2.0f / tanHeight;
+    matrix.m[8] = offsetDist(rng);
+    matrix.m[9] = offsetDist(rng);
+    matrix.m[10] = -farZ / (farZ - nearZ);
+    matrix.m[11] = -1.0f;
+    matrix.m[14] = -(farZ * nearZ) / (farZ - nearZ);
+    return matrix;
+}
+
+static void ExpectMatrixNear(const XrMatrix4x4f& expected, const XrMatrix4x4f& actual, float relativeTolerance)
+{
+    float scale = 0.0f;
+    for (float value : expected.m)
+    {
+        scale = std::max(scale, fabsf(value));
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        EXPECT_NEAR(expected.m[i], actual.m[i], relativeTolerance * std::max(scale, 1.0f)) << "element " << i;
+    }
+}
+
+
+TEST(XrMathSIMD, MultiplyMatchesScalar)
+{
+    std::mt19937 rng(1);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        XrMatrix4x4f a = RandomMatrix(rng);
+        XrMatrix4x4f b = RandomMatrix(rng);
+
+        XrMatrix4x4f expected, actual;
+        XrMatrix4x4f_Multiply(&expected, &a, &b);
+        XrMatrix4x4f_MultiplySIMD(&actual, &a, &b);
+
+        ExpectMatrixNear(expected, actual, 1e-6f);
+    }
+}
+
+TEST(XrMathSIMD, MultiplyAllowsAliasing)
+{
+    std::mt19937 rng(2);
+    XrMatrix4x4f a = RandomMatrix(rng);
+    XrMatrix4x4f b = RandomMatrix(rng);
+
+    XrMatrix4x4f expected;
+    XrMatrix4x4f_Multiply(&expected, &a, &b);
+
+    XrMatrix4x4f aliasA = a;
+    XrMatrix4x4f_MultiplySIMD(&aliasA, &aliasA, &b);
+    ExpectMatrixNear(expected, aliasA, 1e-6f);
+
+    XrMatrix4x4f aliasB = b;
+    XrMatrix4x4f_MultiplySIMD(&aliasB, &a, &aliasB);
+    ExpectMatrixNear(expected, aliasB, 1e-6f);
+}
+
+TEST(XrMathSIMD, Multiply3MatchesScalar)
+{
+    std::mt19937 rng(3);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        XrMatrix4x4f a = RandomRigidBody(rng);
+        XrMatrix4x4f b = RandomProjection(rng);
+        XrMatrix4x4f c = RandomRigidBody(rng);
+
+        XrMatrix4x4f temp, expected, actual;
+        XrMatrix4x4f_Multiply(&temp, &b, &c);
+        XrMatrix4x4f_Multiply(&expected, &a, &temp);
+        XrMatrix4x4f_Multiply3SIMD(&actual, &a, &b, &c);
+
+        ExpectMatrixNear(expected, actual, 1e-6f);
+    }
+}
+
+TEST(XrMathSIMD, InvertRigidBodyMatchesScalar)
+{
+    std::mt19937 rng(4);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        XrMatrix4x4f matrix = RandomRigidBody(rng);
+
+        XrMatrix4x4f expected, actual;
+        XrMatrix4x4f_InvertRigidBody(&expected, &matrix);
+        XrMatrix4x4f_InvertRigidBodySIMD(&actual, &matrix);
+
+        ExpectMatrixNear(expected, actual, 1e-6f);
+
+        XrMatrix4x4f_InvertRigidBodySIMD(&matrix, &matrix);
+        ExpectMatrixNear(expected, matrix, 1e-6f);
+    }
+}
+
+TEST(XrMathSIMD, InvertMatchesScalar)
+{
+    std::mt19937 rng(5);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        XrMatrix4x4f rigid = RandomRigidBody(rng);
+        XrMatrix4x4f projection = RandomProjection(rng);
+
+        XrMatrix4x4f matrix;
+        XrMatrix4x4f_Multiply(&matrix, &projection, &rigid);
+
+        XrMatrix4x4f expected, actual;
+        XrMatrix4x4f_Invert(&expected, &matrix);
+        XrMatrix4x4f_InvertSIMD(&actual, &matrix);
+
+        ExpectMatrixNear(expected, actual, 1e-4f);
+
+        XrMatrix4x4f_InvertSIMD(&matrix, &matrix);
+        ExpectMatrixNear(expected, matrix, 1e-4f);
+    }
+}
+
+TEST(XrMathSIMD, InvertGivesIdentity)
+{
+    std::mt19937 rng(6);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        XrMatrix4x4f matrix = RandomMatrix(rng);
+
+        XrMatrix4x4f inverse, product;
+        XrMatrix4x4f_InvertSIMD(&inverse, &matrix);
+        XrMatrix4x4f_Multiply(&product, &matrix, &inverse);
+
+        // Skip badly conditioned random matrices.
+        float maxElement = 0.0f;
+        for (float value : inverse.m)
+        {
+            maxElement = std::max(maxElement, fabsf(value));
+        }
+        if (maxElement > 100.0f)
+        {
+            continue;
+        }
+
+        for (int j = 0; j < 16; j++)
+        {
+            EXPECT_NEAR(product.m[j], (j % 5 == 0) ? 1.0f : 0.0f, 1e-3f) << "element " << j;
+        }
+    }
+}